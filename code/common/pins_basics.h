@@ -21,6 +21,8 @@
 struct Pin;
 struct PinInterruptConf;
 struct PinsBusDevice;
+struct PinScaling;
+struct PinFilter;
 
 /** Enumeration of pin types.
  */
@@ -51,7 +53,7 @@ pinType;
  */
 typedef enum
 {
-    PIN_RV,        /* Reserved for value or state bits */
+    PIN_RV,        /* Not used, value and state bits are in PinRV array */
     PIN_PULL_UP,
     PIN_PULL_DOWN,
     PIN_TOUCH,
@@ -91,13 +93,33 @@ typedef enum
     PIN_MAX,       /* Maximum value for signal, 0 if not set */
     PIN_SMIN,      /* Minimum integer value for scaled signal */
     PIN_SMAX,      /* Maximum integer value for scaled signal, 0 if not set */
-    PIN_DIGS       /* If pin value is scaled to float, number of decimal digits. Value is divided by 10^n */
+    PIN_DIGS,      /* If pin value is scaled to float, number of decimal digits. Value is divided by 10^n */
+    PIN_AVG,       /* Moving average filter, number of samples to average */
+    PIN_IIR,       /* IIR low pass filter, new sample is weighted by 1/2^n */
+    PIN_DEADBAND,  /* Absolute deadband, changes smaller than this are ignored */
+    PIN_DEADBAND_REL, /* Relative deadband, per mille of current value */
+    PIN_DEBOUNCE,  /* Debounce time for digital input, ms */
+    PIN_SIM,       /* Simulation backend: Input source, PIN_SIM_SQUARE... */
+    PIN_SIM_PERIOD, /* Simulation backend: Waveform period or noise sample time, ms */
+    PIN_SIM_MIN,   /* Simulation backend: Waveform minimum */
+    PIN_SIM_MAX,   /* Simulation backend: Waveform maximum */
+    PIN_SIM_SEED,  /* Simulation backend: Noise seed */
+    PIN_SIM_COLUMN, /* Simulation backend: Replay trace column, 1 is first after time */
+
+    PIN_NRO_PRMS   /* Number of parameter IDs, keep last. Order must match prm_ids in pins_to_c.py */
 }
 pinPrm;
 
-/** Number of PinPrm elements (4 bytes) in beginning prm array reserved for PinRV structure (8 bytes)
+
+/** Simulated input sources, values for PIN_SIM parameter ("sim" attribute in JSON).
  */
-#define PINS_N_RESERVED 2
+#define PIN_SIM_RANDOM 0
+#define PIN_SIM_CONST 1
+#define PIN_SIM_SQUARE 2
+#define PIN_SIM_SINE 3
+#define PIN_SIM_RAMP 4
+#define PIN_SIM_NOISE 5
+#define PIN_SIM_REPLAY 6
 
 
 /** Pin flags (flags member of Pin structure). PIN_SCALING_SET flag indicates that scaling
@@ -106,17 +128,147 @@ pinPrm;
 #define PIN_SCALING_SET 1
 
 
+#if PINS_SCAN_SCHEDULER
+/** Scan schedule for pin group with "scan-ms" attribute in JSON. pins_read_all() skips
+    the group until period_ms has elapsed since last scan.
+ */
+typedef struct PinGroupScan
+{
+    os_int period_ms;
+    os_timer last_scan;
+}
+PinGroupScan;
+
+#define PINS_GROUP_SCAN_STRUCT(name, ms) static PinGroupScan name = {ms};
+#define PINS_GROUP_SCAN_PTR(name) ,&name
+#define PINS_GROUP_SCAN_NULL ,OS_NULL
+#else
+#define PINS_GROUP_SCAN_STRUCT(name, ms)
+#define PINS_GROUP_SCAN_PTR(name)
+#define PINS_GROUP_SCAN_NULL
+#endif
+
 typedef struct
 {
     os_short n_pins;
     const struct Pin *pin;
+
+#if PINS_SCAN_SCHEDULER
+    /** Scan schedule, OS_NULL to scan group on every pins_read_all() call.
+     */
+    PinGroupScan *scan;
+#endif
 }
 PinGroupHdr;
 
+#if PINS_SCAN_PLAN
+/** Scan plan generated by pins_to_c.py. Input pins are sorted by how they are read, so
+    pins_read_all() can loop trough each class without checking pin type, bus device or
+    interrupt configuration of each pin.
+ */
+typedef struct PinsScanPlan
+{
+    /** Digital inputs with non negative address, which can be read from GPIO bank.
+     */
+    const struct Pin * const *gpio_in;
+    os_short n_gpio_in;
+
+    /** Other inputs read directly from hardware, analog inputs typically.
+     */
+    const struct Pin * const *direct_in;
+    os_short n_direct_in;
+
+    /** Inputs read from SPI or I2C bus device.
+     */
+    const struct Pin * const *bus_in;
+    os_short n_bus_in;
+
+    /** Inputs with interrupt configuration, interrupts are simulated on change.
+     */
+    const struct Pin * const *int_in;
+    os_short n_int_in;
+
+    /** Timers, interrupts are simulated.
+     */
+    const struct Pin * const *timer;
+    os_short n_timer;
+}
+PinsScanPlan;
+
+#define PINS_SCAN_PLAN_PTR(name) ,&name
+#define PINS_SCAN_PLAN_NULL ,OS_NULL
+#else
+#define PINS_SCAN_PLAN_PTR(name)
+#define PINS_SCAN_PLAN_NULL
+#endif
+
+#if PINS_NAME_INDEX
+/** Minimal perfect hash over pin names generated by pins_to_c.py, used by
+    pins_find_by_name(). Name is hashed into one of n buckets, and g[bucket] selects the
+    slot: Negative value -1-slot is the slot itself, positive value is seed to hash the
+    name again, modulo n.
+ */
+typedef struct PinsNameIndex
+{
+    /** Displacement for each bucket.
+     */
+    const os_short *g;
+
+    /** Pin and it's name for each slot. Name is "group.pin" for pins, or name of application
+        pin group, in which case pin is the first pin in linked list.
+     */
+    const struct Pin * const *pin;
+    const os_char * const *name;
+
+    /** Number of buckets and slots.
+     */
+    os_short n;
+}
+PinsNameIndex;
+
+#define PINS_NAME_INDEX_PTR(name) ,&name
+#define PINS_NAME_INDEX_NULL ,OS_NULL
+#else
+#define PINS_NAME_INDEX_PTR(name)
+#define PINS_NAME_INDEX_NULL
+#endif
+
 typedef struct
 {
     const PinGroupHdr * const *group;
     os_short n_groups;
+
+    /** Runtime values of all pins as one contiguous array, for example to take snapshot
+        of the whole IO device state with one os_memcpy().
+     */
+    struct PinRV *rv;
+    os_short n_rv;
+
+#if PINS_STATISTICS
+    /** Statistics table, one entry for each runtime value (same index).
+     */
+    struct PinStats *stats;
+#endif
+
+#if PINS_SCAN_PLAN
+    /** Scan plan, OS_NULL for hand written configuration. Groups with "scan-ms" are not
+        in the plan, pins_read_all() reads these in the generic loop.
+     */
+    const PinsScanPlan *scan_plan;
+#endif
+
+#if PINS_NAME_INDEX
+    /** Index to find pins by name, OS_NULL for hand written configuration.
+     */
+    const PinsNameIndex *name_index;
+#endif
+
+#if PINS_HISTORY
+    /** Value history table, one ring buffer pointer for each runtime value (same index),
+        OS_NULL for pins without history.
+     */
+    struct PinHistory * const *history;
+#endif
 }
 IoPinsHdr;
 
@@ -137,14 +289,19 @@ typedef struct PinPrmValue {
 PinPrmValue;
 
 
+/** PinRV flags: Pin is in change journal waiting to be forwarded to IOCOM.
+ */
+#define PIN_RV_QUEUED 1
+
 /* Since Pin structure is "const" and can be only in flash memory, the PinRV structure is
    used to store dynamic data for IO pin. The PinRV is always 8 bytes and needs to be
-   aligned to 4 byte boundary.
+   aligned to 4 byte boundary. pins_to_c.py generates one contiguous PinRV array for all
+   pins of the IO device, so scanning pins walks the runtime values linearly.
  */
 typedef struct PinRV {
     os_int value;
     os_char state_bits;
-    os_char reserved1;
+    os_char flags;
 #if OSAL_MINIMALISTIC == 0
     os_char reserved2;
     os_char reserved3;
@@ -155,7 +312,10 @@ PinRV;
 struct iocSignal;
 
 
-/** Structure to set up static information about one IO pin or other IO item.
+#if PINS_COMPACT == 0
+/** Structure to set up static information about one IO pin or other IO item. Use PIN_PRM(),
+    PIN_NEXT(), PIN_SIGNAL()... macros to access pointer members, so that the code works also
+    with compact configuration.
  */
 typedef struct Pin
 {
@@ -171,8 +331,13 @@ typedef struct Pin
      */
     pin_addr addr;
 
-    /** Pointer to parameter array, two first os_shorts are reserved for storing value
-        as os_int.
+    /** Pointer to runtime value and state bits of the pin, element of PinRV array
+        generated for the IO device. Use PIN_RV(pin) macro to access. OS_NULL for pins
+        which are only accessed trough pin_ll_*() functions.
+     */
+    PinRV *rv;
+
+    /** Pointer to parameter array, OS_NULL if pin has no parameters.
      */
     PinPrmValue *prm;
 
@@ -207,9 +372,182 @@ typedef struct Pin
     struct PinInterruptConf *int_conf;
 
 #endif
+
+#if PINS_PRM_SLOT_MAP
+    /** Parameter slot map generated by pins_to_c.py, indexed by pinPrm. Value n > 0 means
+        that parameter is stored in prm[n-1], zero that it is not set. OS_NULL to search
+        the parameter array linearly (hand written configuration).
+     */
+    const os_uchar *prm_slot;
+#endif
+
+#if PINS_SCALING_CACHE
+    /** Precomputed gain and offset for pin with PIN_SCALING_SET flag. OS_NULL if not
+        scaled or if scaling is calculated when needed.
+     */
+    struct PinScaling *scaling;
+#endif
+
+#if PINS_INPUT_FILTERS
+    /** Input conditioning state from generated filter pool, if pin has "avg", "iir",
+        "deadband", "deadband-rel" or "debounce-ms" attribute. OS_NULL if not filtered.
+     */
+    struct PinFilter *filter;
+#endif
+}
+Pin;
+
+#else
+
+/** Index into table generated by "pins_to_c.py -c" (compact mode).
+ */
+typedef os_ushort pin_cix;
+
+/** Compact version of the Pin structure. Members have same names and meaning as in normal
+    Pin structure, but refer to other items by index to tables in pins_compact. Members
+    which may be unset store index + 1, zero meaning "none". Always access these members
+    trough PIN_RV(), PIN_PRM(), PIN_NEXT()... macros. With PINS_CONFIG_BLOB all optional
+    members are present, this is the layout of pins in binary image.
+ */
+typedef struct Pin
+{
+    os_char type;
+    os_char bank;
+    pin_addr addr;
+
+    /** Index in pins_compact.rv.
+     */
+    pin_cix rv;
+
+    /** Index of first parameter in pins_compact.prm, prm_n parameters.
+     */
+    pin_cix prm;
+    os_char prm_n;
+    os_char flags;
+
+    /** 1 + index of next pin in group in pins_compact.pin, 0 if none.
+     */
+    pin_cix next;
+
+    /** Index in pins_compact.signal, entry 0 is OS_NULL.
+     */
+    pin_cix signal;
+
+#if PINS_SPI || PINS_I2C || PINS_CONFIG_BLOB
+    /** Index in pins_compact.bus_device, entry 0 is OS_NULL.
+     */
+    os_uchar bus_device;
+#endif
+
+#if PINS_PRM_SLOT_MAP || PINS_CONFIG_BLOB
+    /** 1 + number of parameter slot map in pins_compact.prm_slot, 0 if none.
+     */
+    os_uchar prm_slot;
+#endif
+
+#if PINS_SIMULATED_INTERRUPTS || PINS_CONFIG_BLOB
+    /** 1 + index in pins_compact.int_conf, 0 if none.
+     */
+    pin_cix int_conf;
+#endif
+
+#if PINS_SCALING_CACHE || PINS_CONFIG_BLOB
+    /** 1 + index in pins_compact.scaling, 0 if none.
+     */
+    pin_cix scaling;
+#endif
+
+#if PINS_INPUT_FILTERS || PINS_CONFIG_BLOB
+    /** 1 + index in pins_compact.filter, 0 if none.
+     */
+    pin_cix filter;
+#endif
 }
 Pin;
 
+/** Tables generated by "pins_to_c.py -c", which Pin structures index.
+ */
+typedef struct PinsCompactTables
+{
+    /** All pins of the IO device as one array, in JSON order.
+     */
+    const Pin *pin;
+
+    /** Runtime values, same as IoPinsHdr.rv.
+     */
+    PinRV *rv;
+
+    /** Parameters of all pins. Constant, values changed by pin_set_prm() are stored in
+        small override table in RAM.
+     */
+    const PinPrmValue *prm;
+
+    /** IOCOM signals, first entry OS_NULL.
+     */
+    const struct iocSignal * const *signal;
+
+#if PINS_SPI || PINS_I2C
+    /** SPI and I2C device structures, first entry OS_NULL.
+     */
+    struct PinsBusDevice * const *bus_device;
+#endif
+
+#if PINS_PRM_SLOT_MAP
+    /** Parameter slot maps, PIN_NRO_PRMS bytes each.
+     */
+    const os_uchar *prm_slot;
+#endif
+
+#if PINS_SIMULATED_INTERRUPTS
+    struct PinInterruptConf *int_conf;
+#endif
+
+#if PINS_SCALING_CACHE
+    struct PinScaling *scaling;
+#endif
+
+#if PINS_INPUT_FILTERS
+    struct PinFilter *filter;
+#endif
+}
+PinsCompactTables;
+
+/** Generated compact mode tables, or ones bound from binary image by pins_bind_config_blob().
+ */
+#if PINS_CONFIG_BLOB
+extern PinsCompactTables pins_compact;
+#else
+extern OS_CONST_H PinsCompactTables pins_compact;
+#endif
+
+#endif
+
+/* Access Pin members which are pointers in normal mode and indices in compact mode.
+   PIN_RV gets pointer to runtime value and state bits of a pin.
+ */
+#if PINS_COMPACT
+#define PIN_RV(p) (pins_compact.rv + (p)->rv)
+#define PIN_PRM(p) (pins_compact.prm + (p)->prm)
+#define PIN_NEXT(p) ((p)->next ? pins_compact.pin + ((p)->next - 1) : OS_NULL)
+#define PIN_SIGNAL(p) (pins_compact.signal[(p)->signal])
+#define PIN_BUS_DEVICE(p) (pins_compact.bus_device[(p)->bus_device])
+#define PIN_PRM_SLOT(p) ((p)->prm_slot ? \
+    pins_compact.prm_slot + PIN_NRO_PRMS * ((p)->prm_slot - 1) : OS_NULL)
+#define PIN_INT_CONF(p) ((p)->int_conf ? pins_compact.int_conf + ((p)->int_conf - 1) : OS_NULL)
+#define PIN_SCALING(p) ((p)->scaling ? pins_compact.scaling + ((p)->scaling - 1) : OS_NULL)
+#define PIN_FILTER(p) ((p)->filter ? pins_compact.filter + ((p)->filter - 1) : OS_NULL)
+#else
+#define PIN_RV(p) ((p)->rv)
+#define PIN_PRM(p) ((p)->prm)
+#define PIN_NEXT(p) ((p)->next)
+#define PIN_SIGNAL(p) ((p)->signal)
+#define PIN_BUS_DEVICE(p) ((p)->bus_device)
+#define PIN_PRM_SLOT(p) ((p)->prm_slot)
+#define PIN_INT_CONF(p) ((p)->int_conf)
+#define PIN_SCALING(p) ((p)->scaling)
+#define PIN_FILTER(p) ((p)->filter)
+#endif
+
 /* Initialize IO hardware library.
  */
 osalStatus pins_ll_initialize_lib(
@@ -245,6 +583,32 @@ os_int pin_ll_get(
     const Pin *pin,
     os_char *state_bits);
 
+#if PINS_BANK_IO
+/* GPIO bank number and bit within bank for pin address.
+ */
+#define PINS_GPIO_BANK(addr) ((addr) >> 5)
+#define PINS_GPIO_BANK_BIT(addr) ((addr) & 31)
+
+/* Maximum number of GPIO banks, pins beyond these are read one by one.
+ */
+#ifndef PINS_MAX_GPIO_BANKS
+#define PINS_MAX_GPIO_BANKS 2
+#endif
+
+/* Get states of all digital inputs in GPIO bank.
+ */
+os_uint pin_ll_get_bank(
+    os_short bank,
+    os_char *state_bits);
+
+/* Set states of digital outputs in GPIO bank. Only pins with bit set in mask are modified.
+ */
+void pin_ll_set_bank(
+    os_short bank,
+    os_uint mask,
+    os_uint bits);
+#endif
+
 /* SPI and I2C initialization.
  */
 #if PINS_SPI || PINS_I2C
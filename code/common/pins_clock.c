@@ -0,0 +1,47 @@
+/**
+
+  @file    common/pins_clock.c
+  @brief   Microsecond clock for profiler, trace recorder and trace replay.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pins.h"
+#ifdef OSAL_LINUX
+#include <time.h>
+#endif
+
+
+/**
+****************************************************************************************************
+
+  @brief Get current time in microseconds.
+  @anchor pins_now_us
+
+  On Linux monotonic clock_gettime() is used. Other platforms use os_get_timer(), which
+  counts milliseconds, so resolution there is one millisecond. Can be called from interrupt
+  handler, edge capture uses it for timestamps.
+
+  @return  Monotonic time in microseconds.
+
+****************************************************************************************************
+*/
+os_int64 OS_ISR_FUNC_ATTR pins_now_us(void)
+{
+#ifdef OSAL_LINUX
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (os_int64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+#else
+    os_timer t;
+    os_get_timer(&t);
+    return 1000 * (os_int64)t;
+#endif
+}
@@ -0,0 +1,25 @@
+/**
+
+  @file    common/pins_clock.h
+  @brief   Microsecond clock for profiler, trace recorder and trace replay.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#pragma once
+#ifndef PINS_CLOCK_H_
+#define PINS_CLOCK_H_
+#include "pins.h"
+
+/* Get monotonic time in microseconds.
+ */
+os_int64 OS_ISR_FUNC_ATTR pins_now_us(void);
+
+#endif
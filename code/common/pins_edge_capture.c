@@ -0,0 +1,135 @@
+/**
+
+  @file    common/pins_edge_capture.c
+  @brief   Timestamped GPIO edge capture.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pins.h"
+#if PINS_EDGE_CAPTURE
+
+
+/**
+****************************************************************************************************
+
+  @brief Record an edge into capture ring.
+  @anchor pin_capture_edge
+
+  The pin_capture_edge() function is called by backend's interrupt handler for every edge
+  on a pin attached with pinInterruptParams.capture set. The timestamp is taken first, so it
+  is as close to the edge as possible. If the ring is full, the edge is dropped and
+  overflow_count incremented.
+
+  @param   ring Pointer to capture ring.
+  @param   pin Pin which triggered the interrupt.
+  @param   x Pin state after the edge.
+  @return  None.
+
+****************************************************************************************************
+*/
+void OS_ISR_FUNC_ATTR pin_capture_edge(
+    PinEdgeRing *ring,
+    const struct Pin *pin,
+    os_int x)
+{
+    PinEdgeEvent *e;
+    os_int64 now;
+    os_int head, next;
+
+    PINS_EDGE_TIMESTAMP(&now);
+
+    head = ring->head;
+    next = head + 1;
+    if (next >= ring->buf_sz) next = 0;
+
+    if (next == ring->tail) {
+        ring->overflow_count++;
+        return;
+    }
+
+    e = ring->buf + head;
+    e->pin = pin;
+    e->timestamp = now;
+    e->x = x ? 1 : 0;
+    PINS_MEMORY_BARRIER();
+    ring->head = next;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get number of edges in capture ring.
+  @anchor pins_get_edge_count
+
+  The pins_get_edge_count() function returns how many captured edges can be read.
+
+  @param   ring Pointer to capture ring.
+  @return  Number of edges in ring buffer.
+
+****************************************************************************************************
+*/
+os_int pins_get_edge_count(
+    PinEdgeRing *ring)
+{
+    os_int n;
+
+    n = ring->head - ring->tail;
+    if (n < 0) n += ring->buf_sz;
+    return n;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Move captured edges from ring to application buffer.
+  @anchor pins_get_edges
+
+  The pins_get_edges() function copies up to max_events oldest edges from capture ring and
+  removes them from the ring, at most two memory copies per call. This must be called from
+  one thread only.
+
+  @param   ring Pointer to capture ring.
+  @param   events Buffer where to store the edges.
+  @param   max_events Maximum number of edges to get.
+  @return  Number of edges stored in events buffer.
+
+****************************************************************************************************
+*/
+os_int pins_get_edges(
+    PinEdgeRing *ring,
+    PinEdgeEvent *events,
+    os_int max_events)
+{
+    os_int head, tail, n, count;
+
+    head = ring->head;
+    PINS_MEMORY_BARRIER();
+    tail = ring->tail;
+
+    count = 0;
+    while (tail != head && count < max_events)
+    {
+        n = (head > tail ? head : ring->buf_sz) - tail;
+        if (n > max_events - count) n = max_events - count;
+        os_memcpy(events + count, ring->buf + tail, n * sizeof(PinEdgeEvent));
+        count += n;
+        tail += n;
+        if (tail >= ring->buf_sz) tail = 0;
+    }
+
+    PINS_MEMORY_BARRIER();
+    ring->tail = tail;
+    return count;
+}
+
+#endif
@@ -0,0 +1,98 @@
+/**
+
+  @file    common/pins_edge_capture.h
+  @brief   Timestamped GPIO edge capture.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  When pinInterruptParams.capture is set, the library's own interrupt handler records each
+  edge (pin, level and timestamp) into a single producer single consumer ring buffer. The
+  interrupt handler is the only producer and the application the only consumer, so no locks
+  are needed. The application drains the ring with pins_get_edges().
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#pragma once
+#ifndef PINS_EDGE_CAPTURE_H_
+#define PINS_EDGE_CAPTURE_H_
+#include "pins.h"
+
+#if PINS_EDGE_CAPTURE
+
+/** Get timestamp for captured edge, microseconds. Backend's pins_hw_defs.h can define
+    this to read a faster or more precise hardware timer into os_int64.
+ */
+#ifndef PINS_EDGE_TIMESTAMP
+#define PINS_EDGE_TIMESTAMP(t) (*(t) = pins_now_us())
+#endif
+
+/** One captured edge.
+ */
+typedef struct PinEdgeEvent
+{
+    /** Pin which triggered the interrupt.
+     */
+    const struct Pin *pin;
+
+    /** Time of the edge in microseconds, see PINS_EDGE_TIMESTAMP.
+     */
+    os_int64 timestamp;
+
+    /** Pin state after the edge, 0 for falling and 1 for rising edge.
+     */
+    os_int x;
+}
+PinEdgeEvent;
+
+/** Edge capture ring buffer. Application allocates the structure and the buffer, typically
+    as static variables. Same ring can be shared by pins which interrupt at same priority.
+ */
+typedef struct PinEdgeRing
+{
+    /** Ring buffer and it's size in events. One slot is always kept free, so the buffer
+        holds buf_sz - 1 events.
+     */
+    PinEdgeEvent *buf;
+    os_int buf_sz;
+
+    /** Write position, modified only by the interrupt handler.
+     */
+    volatile os_int head;
+
+    /** Read position, modified only by the consumer.
+     */
+    volatile os_int tail;
+
+    /** Number of edges dropped because ring buffer was full.
+     */
+    volatile os_int overflow_count;
+}
+PinEdgeRing;
+
+/* Record an edge into capture ring, called from interrupt handler.
+ */
+void OS_ISR_FUNC_ATTR pin_capture_edge(
+    PinEdgeRing *ring,
+    const struct Pin *pin,
+    os_int x);
+
+/* Get number of edges in capture ring.
+ */
+os_int pins_get_edge_count(
+    PinEdgeRing *ring);
+
+/* Move captured edges from ring to application buffer.
+ */
+os_int pins_get_edges(
+    PinEdgeRing *ring,
+    PinEdgeEvent *events,
+    os_int max_events);
+
+#endif
+#endif
@@ -0,0 +1,172 @@
+/**
+
+  @file    common/pins_filter.c
+  @brief   Input conditioning: Debounce, deadband and averaging filters.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pins.h"
+#if PINS_INPUT_FILTERS
+
+
+/**
+****************************************************************************************************
+
+  @brief Set up filter for a pin.
+  @anchor pin_setup_filter
+
+  The pin_setup_filter() function reads "avg", "iir", "deadband", "deadband-rel" and
+  "debounce-ms" parameters of the pin into filter structure and resets the filter state.
+  Called by pins_setup() for every filtered pin, and by pin_set_prm() when filter parameter
+  is modified.
+
+  @param   pin Pointer to pin configuration structure.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pin_setup_filter(
+    const Pin *pin)
+{
+    PinFilter *f;
+    os_int avg_n, iir_shift;
+
+    f = PIN_FILTER(pin);
+    if (f == OS_NULL) return;
+    os_memclear(f, sizeof(PinFilter));
+
+    avg_n = pin_get_prm(pin, PIN_AVG);
+    if (avg_n > PINS_FILTER_MAX_AVG) {
+        osal_debug_error_int("Pin \"avg\" is limited to PINS_FILTER_MAX_AVG, pin addr=", pin->addr);
+        avg_n = PINS_FILTER_MAX_AVG;
+    }
+    if (avg_n < 2) avg_n = 0;
+    f->avg_n = (os_uchar)avg_n;
+
+    iir_shift = pin_get_prm(pin, PIN_IIR);
+    if (iir_shift > 15) iir_shift = 15;
+    if (iir_shift < 0) iir_shift = 0;
+    f->iir_shift = (os_uchar)iir_shift;
+
+    f->deadband = pin_get_prm(pin, PIN_DEADBAND);
+    f->deadband_rel = (os_short)pin_get_prm(pin, PIN_DEADBAND_REL);
+    f->debounce_ms = (os_short)pin_get_prm(pin, PIN_DEBOUNCE);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Filter value read from hardware.
+  @anchor pin_filter
+
+  The pin_filter() function is called by pins_read_all() and pin_get_ext() with value read
+  from hardware, before comparing it to the current pin value. Moving average and IIR filters
+  are applied first, then deadband. For digital inputs with debounce time, a changed value is
+  accepted only after it has been stable for the debounce time. Until the pin is connected,
+  debounce and deadband pass the value through, so the first sample is not delayed.
+
+  Only integer arithmetic is used.
+
+  @param   pin Pointer to pin configuration structure. pin must have filter.
+  @param   x Value read from hardware.
+  @return  Filtered value. If the change is within deadband or not yet debounced, current
+           pin value.
+
+****************************************************************************************************
+*/
+os_int pin_filter(
+    const Pin *pin,
+    os_int x)
+{
+    PinFilter *f;
+    os_int current, band, d;
+    os_timer now;
+
+    f = PIN_FILTER(pin);
+    current = PIN_RV(pin)->value;
+
+    /* Debounce digital input. The first sample is accepted as is when pin gets connected.
+     */
+    if (f->debounce_ms)
+    {
+        if (x == current || PIN_RV(pin)->state_bits != OSAL_STATE_CONNECTED) {
+            f->debounce_pending = OS_FALSE;
+            return x;
+        }
+
+        os_get_timer(&now);
+        if (!f->debounce_pending || f->debounce_x != x)
+        {
+            f->debounce_pending = OS_TRUE;
+            f->debounce_x = x;
+            f->debounce_timer = now;
+            return current;
+        }
+        if (!os_has_elapsed_since(&f->debounce_timer, &now, f->debounce_ms)) {
+            return current;
+        }
+        f->debounce_pending = OS_FALSE;
+        return x;
+    }
+
+    /* Moving average over avg_n last samples.
+     */
+    if (f->avg_n)
+    {
+        if (f->avg_count < f->avg_n) {
+            f->avg_count++;
+        }
+        else {
+            f->avg_sum -= f->avg_buf[f->avg_pos];
+        }
+        f->avg_buf[f->avg_pos] = x;
+        f->avg_sum += x;
+        if (++(f->avg_pos) >= f->avg_n) f->avg_pos = 0;
+        x = (f->avg_sum + f->avg_count / 2) / f->avg_count;
+    }
+
+    /* First order IIR low pass filter.
+     */
+    if (f->iir_shift)
+    {
+        if (!f->iir_started) {
+            f->iir_acc = x << f->iir_shift;
+            f->iir_started = OS_TRUE;
+        }
+        else {
+            f->iir_acc += x - (f->iir_acc >> f->iir_shift);
+        }
+        x = (f->iir_acc + (1 << (f->iir_shift - 1))) >> f->iir_shift;
+    }
+
+    /* Ignore changes within absolute or relative deadband. State bits of the pin are
+       checked so that value is always accepted when pin gets connected.
+     */
+    if ((f->deadband || f->deadband_rel) &&
+        PIN_RV(pin)->state_bits == OSAL_STATE_CONNECTED)
+    {
+        band = f->deadband;
+        if (f->deadband_rel) {
+            d = (os_int)(((os_int64)(current < 0 ? -current : current) * f->deadband_rel) / 1000);
+            if (d > band) band = d;
+        }
+        d = x - current;
+        if (d < 0) d = -d;
+        if (d < band) {
+            return current;
+        }
+    }
+
+    return x;
+}
+
+#endif
@@ -0,0 +1,90 @@
+/**
+
+  @file    common/pins_filter.h
+  @brief   Input conditioning: Debounce, deadband and averaging filters.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Filters are set by "avg", "iir", "deadband", "deadband-rel" and "debounce-ms" pin attributes
+  in JSON. pins_to_c.py generates a fixed size pool of PinFilter structures, one for each
+  filtered pin, so no heap is used. The filter is applied to value read from hardware before
+  change detection, thus noise which is filtered out is never forwarded to IOCOM.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#pragma once
+#ifndef PINS_FILTER_H_
+#define PINS_FILTER_H_
+#include "pins.h"
+
+#if PINS_INPUT_FILTERS
+
+/** Maximum moving average window, "avg" is limited to this.
+ */
+#ifndef PINS_FILTER_MAX_AVG
+#define PINS_FILTER_MAX_AVG 8
+#endif
+
+/** Filter configuration and state for one pin.
+ */
+typedef struct PinFilter
+{
+    /** Configuration from pin parameters, set by pin_setup_filter().
+     */
+    os_int deadband;
+    os_short deadband_rel;
+    os_short debounce_ms;
+    os_uchar avg_n;
+    os_uchar iir_shift;
+
+    /** Moving average state.
+     */
+    os_uchar avg_pos;
+    os_uchar avg_count;
+    os_int avg_sum;
+    os_int avg_buf[PINS_FILTER_MAX_AVG];
+
+    /** IIR state, filtered value shifted left by iir_shift.
+     */
+    os_int iir_acc;
+    os_boolean iir_started;
+
+    /** Debounce state.
+     */
+    os_boolean debounce_pending;
+    os_int debounce_x;
+    os_timer debounce_timer;
+}
+PinFilter;
+
+#define PINS_FILTER_POOL(name, n) static PinFilter name[n];
+#define PINS_FILTER_PTR(name) ,&name
+#define PINS_FILTER_NULL ,OS_NULL
+#define PINS_FILTER_IX(n) ,n
+
+/* Read filter parameters of the pin and reset filter state.
+ */
+void pin_setup_filter(
+    const Pin *pin);
+
+/* Filter value read from hardware.
+ */
+os_int pin_filter(
+    const Pin *pin,
+    os_int x);
+
+#else
+
+#define PINS_FILTER_POOL(name, n)
+#define PINS_FILTER_PTR(name)
+#define PINS_FILTER_NULL
+#define PINS_FILTER_IX(n)
+
+#endif
+#endif
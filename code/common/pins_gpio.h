@@ -19,6 +19,7 @@
 #include "pins.h"
 
 struct Pin;
+struct PinEdgeRing;
 
 /* Interrupt mode flags:
   - PINS_INT_FALLING	Triggers interrupt when the pin goes from HIGH to LOW
@@ -44,6 +45,12 @@ typedef struct PinInterruptConf
     /** Interrupt mode flags.
      */
     os_short flags;
+
+#if PINS_EDGE_CAPTURE
+    /** Ring buffer where to record edges, OS_NULL if not capturing.
+     */
+    struct PinEdgeRing *capture;
+#endif
 }
 PinInterruptConf;
 
@@ -53,10 +60,14 @@ PinInterruptConf;
 #define PINS_INTCONF_STRUCT(name) static PinInterruptConf name;
 #define PINS_INTCONF_PTR(name) ,&name
 #define PINS_INTCONF_NULL ,OS_NULL
+#define PINS_INTCONF_TABLE(name, n) static PinInterruptConf name[n];
+#define PINS_INTCONF_IX(n) ,n
 #else
 #define PINS_INTCONF_STRUCT(name)
 #define PINS_INTCONF_PTR(name)
 #define PINS_INTCONF_NULL
+#define PINS_INTCONF_TABLE(name, n)
+#define PINS_INTCONF_IX(n)
 #endif
 
 /* If we need to store SPI or I2C bus "pin" pointer
@@ -64,9 +75,11 @@ PinInterruptConf;
 #if PINS_SPI || PINS_I2C
 #define PINS_DEVCONF_PTR(name) ,&name
 #define PINS_DEVCONF_NULL ,OS_NULL
+#define PINS_DEVCONF_IX(n) ,n
 #else
 #define PINS_DEVCONF_PTR(name)
 #define PINS_DEVCONF_NULL
+#define PINS_DEVCONF_IX(n)
 #endif
 
 /* Parameter structure for pin_gpio_attach_interrupt() function.
@@ -80,6 +93,14 @@ typedef struct pinInterruptParams
     /** Interrupt mode flags.
      */
     os_short flags;
+
+#if PINS_EDGE_CAPTURE
+    /** Capture mode: If set, the library records every edge matching flags with
+        timestamp into this ring buffer before calling int_handler_func. The
+        int_handler_func can be OS_NULL when only capturing.
+     */
+    struct PinEdgeRing *capture;
+#endif
 }
 pinInterruptParams;
 
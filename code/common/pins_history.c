@@ -0,0 +1,371 @@
+/**
+
+  @file    common/pins_history.c
+  @brief   Per pin value history with time window queries.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pins.h"
+#if PINS_HISTORY
+
+/* IO device whose pins are recorded, set by pins_setup().
+ */
+static const IoPinsHdr *pins_history_hdr;
+
+/* Forward referred static functions.
+ */
+static PinHistory *pin_history(
+    const Pin *pin);
+
+static os_int pin_history_span(
+    PinHistory *h,
+    os_int window_ms,
+    os_timer *now);
+
+static os_uint pin_history_read_begin(
+    PinHistory *h);
+
+/* Update ring within os_lock(), so writers from different threads are serialized, and
+   sequence counter odd, so readers retry.
+ */
+#define PIN_HISTORY_WRITE_BEGIN(h) do {os_lock(); (h)->seq++; PINS_MEMORY_BARRIER();} while (0)
+#define PIN_HISTORY_WRITE_END(h) do {PINS_MEMORY_BARRIER(); (h)->seq++; os_unlock();} while (0)
+#define PIN_HISTORY_READ_RETRY(h, s) (PINS_MEMORY_BARRIER(), (h)->seq != (s))
+
+
+/**
+****************************************************************************************************
+
+  @brief Set IO device whose pins are recorded.
+  @anchor pins_setup_history
+
+  The pins_setup_history() function is called by pins_setup(). It clears the history.
+
+  @param   pins_hdr Top level pins IO configuration structure.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_setup_history(
+    const IoPinsHdr *pins_hdr)
+{
+    pins_history_hdr = pins_hdr;
+    pins_reset_history();
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Record pin value.
+  @anchor pin_history_record
+
+  The pin_history_record() function is called when pin value is read from or written to
+  hardware. The value is stored with current time, unless it is the same as the last value
+  recorded. When the ring is full, the oldest entry is overwritten. Can be called from any
+  thread.
+
+  @param   pin Pointer to pin configuration structure.
+  @param   x Pin value.
+  @param   state_bits Pin state bits.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pin_history_record(
+    const Pin *pin,
+    os_int x,
+    os_char state_bits)
+{
+    PinHistory *h;
+    PinHistoryEntry *e;
+
+    h = pin_history(pin);
+    if (h == OS_NULL) return;
+
+    PIN_HISTORY_WRITE_BEGIN(h);
+    if (h->count)
+    {
+        e = h->entry + (h->head ? h->head - 1 : h->n - 1);
+        if (e->value == x && e->state_bits == state_bits) {
+            PIN_HISTORY_WRITE_END(h);
+            return;
+        }
+    }
+
+    e = h->entry + h->head;
+    os_get_timer(&e->t);
+    e->value = x;
+    e->state_bits = state_bits;
+
+    if (++h->head >= h->n) h->head = 0;
+    if (h->count < h->n) h->count++;
+    PIN_HISTORY_WRITE_END(h);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get min, max and mean of pin value over time window.
+  @anchor pin_history_stats
+
+  The pin_history_stats() function walks recorded values from newest to the one which was
+  current when the window started. Each value counts in the mean for the time it was current
+  within the window, the newest one until now. Values without OSAL_STATE_CONNECTED state bit
+  are skipped. If all values were recorded within the same millisecond, plain mean is used.
+
+  @param   pin Pointer to pin configuration structure.
+  @param   window_ms Time window in milliseconds, from now backwards. 0 for all recorded values.
+  @param   stats Where to store the result.
+  @return  OSAL_SUCCESS if all good. OSAL_NOTHING_TO_DO if there are no values within the
+           window. OSAL_STATUS_FAILED if the pin has no history. stats is cleared if the
+           function fails.
+
+****************************************************************************************************
+*/
+osalStatus pin_history_stats(
+    const Pin *pin,
+    os_int window_ms,
+    PinHistoryStats *stats)
+{
+    PinHistory *h;
+    PinHistoryEntry *e;
+    os_timer now;
+    os_long age, prev_age, total_ms;
+    os_double weighted_sum, sum;
+    os_int ix, k;
+    os_uint seq;
+    os_boolean last;
+
+    h = pin_history(pin);
+    if (h == OS_NULL) {
+        os_memclear(stats, sizeof(PinHistoryStats));
+        return OSAL_STATUS_FAILED;
+    }
+
+    os_get_timer(&now);
+
+    /* Walk the ring again if it was updated meanwhile.
+     */
+    do {
+        seq = pin_history_read_begin(h);
+        os_memclear(stats, sizeof(PinHistoryStats));
+        weighted_sum = sum = 0.0;
+        total_ms = prev_age = 0;
+        ix = h->head;
+
+        for (k = 0; k < h->count; k++)
+        {
+            ix = ix ? ix - 1 : h->n - 1;
+            e = h->entry + ix;
+
+            age = os_get_ms_elapsed(&e->t, &now);
+            last = (os_boolean)(window_ms > 0 && age >= window_ms);
+            if (last) age = window_ms;
+
+            if (e->state_bits & OSAL_STATE_CONNECTED)
+            {
+                if (stats->n == 0 || e->value < stats->min) stats->min = e->value;
+                if (stats->n == 0 || e->value > stats->max) stats->max = e->value;
+                weighted_sum += (os_double)e->value * (os_double)(age - prev_age);
+                sum += (os_double)e->value;
+                total_ms += age - prev_age;
+                stats->n++;
+            }
+
+            prev_age = age;
+            if (last) break;
+        }
+    }
+    while (PIN_HISTORY_READ_RETRY(h, seq));
+
+    if (stats->n == 0) return OSAL_NOTHING_TO_DO;
+    stats->mean = total_ms > 0 ? weighted_sum / (os_double)total_ms
+        : sum / (os_double)stats->n;
+    return OSAL_SUCCESS;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Copy recorded values within time window.
+  @anchor pin_history_copy
+
+  The pin_history_copy() function copies recorded values, oldest first. The first value
+  copied is the one which was current when the window started, so it can be older than
+  the window. If buffer is too small, only the newest values are copied.
+
+  @param   pin Pointer to pin configuration structure.
+  @param   window_ms Time window in milliseconds, from now backwards. 0 for all recorded values.
+  @param   buf Where to copy the values.
+  @param   buf_n Buffer size as number of entries.
+  @return  Number of entries copied, 0 if the pin has no history.
+
+****************************************************************************************************
+*/
+os_int pin_history_copy(
+    const Pin *pin,
+    os_int window_ms,
+    PinHistoryEntry *buf,
+    os_int buf_n)
+{
+    PinHistory *h;
+    os_timer now;
+    os_int ix, k, i;
+    os_uint seq;
+
+    h = pin_history(pin);
+    if (h == OS_NULL || buf_n <= 0) return 0;
+
+    os_get_timer(&now);
+    do {
+        seq = pin_history_read_begin(h);
+        k = pin_history_span(h, window_ms, &now);
+        if (k > buf_n) k = buf_n;
+
+        ix = h->head - k;
+        if (ix < 0) ix += h->n;
+        for (i = 0; i < k; i++)
+        {
+            buf[i] = h->entry[ix];
+            if (++ix >= h->n) ix = 0;
+        }
+    }
+    while (PIN_HISTORY_READ_RETRY(h, seq));
+    return k;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Clear history of all pins.
+  @anchor pins_reset_history
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_reset_history(void)
+{
+    const IoPinsHdr *hdr;
+    PinHistory *h;
+    os_int ix;
+
+    hdr = pins_history_hdr;
+    if (hdr == OS_NULL || hdr->history == OS_NULL) return;
+
+    for (ix = 0; ix < hdr->n_rv; ix++)
+    {
+        h = hdr->history[ix];
+        if (h) {
+            PIN_HISTORY_WRITE_BEGIN(h);
+            h->head = h->count = 0;
+            PIN_HISTORY_WRITE_END(h);
+        }
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get history ring for a pin.
+  @anchor pin_history
+
+  The pin's index in history table is the pin's index in runtime value array.
+
+  @param   pin Pointer to pin configuration structure.
+  @return  Pointer to ring buffer, OS_NULL if none.
+
+****************************************************************************************************
+*/
+static PinHistory *pin_history(
+    const Pin *pin)
+{
+    const IoPinsHdr *hdr;
+    os_int ix;
+
+    hdr = pins_history_hdr;
+    if (hdr == OS_NULL || hdr->history == OS_NULL) return OS_NULL;
+
+    ix = (os_int)(PIN_RV(pin) - hdr->rv);
+    if (ix < 0 || ix >= hdr->n_rv) return OS_NULL;
+    return hdr->history[ix];
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Count newest entries needed to cover time window.
+  @anchor pin_history_span
+
+  Entries are counted from newest backwards, up to and including the one which was current
+  when the window started.
+
+  @param   h Pointer to ring buffer.
+  @param   window_ms Time window in milliseconds, 0 for all recorded values.
+  @param   now Current time.
+  @return  Number of entries.
+
+****************************************************************************************************
+*/
+static os_int pin_history_span(
+    PinHistory *h,
+    os_int window_ms,
+    os_timer *now)
+{
+    os_int ix, k;
+
+    if (window_ms <= 0) return h->count;
+
+    ix = h->head;
+    for (k = 0; k < h->count; )
+    {
+        ix = ix ? ix - 1 : h->n - 1;
+        k++;
+        if (os_get_ms_elapsed(&h->entry[ix].t, now) >= window_ms) break;
+    }
+    return k;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Start reading ring protected by sequence lock.
+  @anchor pin_history_read_begin
+
+  The pin_history_read_begin() function waits until the ring is not being updated and
+  returns the sequence number. After walking the ring the reader checks with
+  PIN_HISTORY_READ_RETRY() that sequence number has not changed.
+
+  @param   h Pointer to ring buffer.
+  @return  Sequence number, always even.
+
+****************************************************************************************************
+*/
+static os_uint pin_history_read_begin(
+    PinHistory *h)
+{
+    os_uint seq;
+
+    while ((seq = h->seq) & 1) {
+        os_timeslice();
+    }
+    PINS_MEMORY_BARRIER();
+    return seq;
+}
+
+#endif
@@ -0,0 +1,128 @@
+/**
+
+  @file    common/pins_history.h
+  @brief   Per pin value history with time window queries.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Optional history of pin values, enabled by defining PINS_HISTORY=1 for the build and
+  "history": N attribute for the pin in JSON configuration. The last N changes of pin value
+  or state bits are stored with timestamp in a ring buffer. Rings are allocated by
+  pins_to_c.py (or JSON configuration loader) and found trough a table in IoPinsHdr, one
+  entry per runtime value, OS_NULL for pins without history. Recording and queries never
+  allocate memory, and queries only walk the entries within the time window.
+
+  Pins may be read and written from several threads: Recording is serialized by os_lock(),
+  which is taken only for pins with history. Queries don't lock, each ring has a sequence
+  lock and query is repeated if the ring was updated meanwhile.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#pragma once
+#ifndef PINS_HISTORY_H_
+#define PINS_HISTORY_H_
+#include "pins.h"
+
+#if PINS_HISTORY
+
+/** One recorded value.
+ */
+typedef struct PinHistoryEntry
+{
+    /** Time when the value was stored, os_get_timer().
+     */
+    os_timer t;
+
+    /** Pin value and state bits from that moment on.
+     */
+    os_int value;
+    os_char state_bits;
+}
+PinHistoryEntry;
+
+/** Ring buffer of one pin.
+ */
+typedef struct PinHistory
+{
+    /** Ring buffer and number of entries in it.
+     */
+    PinHistoryEntry *entry;
+    os_int n;
+
+    /** Index where the next entry is written, and number of valid entries.
+     */
+    os_int head;
+    os_int count;
+
+    /** Sequence lock counter, odd while ring is being updated.
+     */
+    volatile os_uint seq;
+}
+PinHistory;
+
+/** Min, max and mean over time window, see pin_history_stats().
+ */
+typedef struct PinHistoryStats
+{
+    os_int min;
+    os_int max;
+
+    /** Time weighted mean: Each value counts for the time it was current within the window.
+     */
+    os_double mean;
+
+    /** Number of entries which contributed.
+     */
+    os_int n;
+}
+PinHistoryStats;
+
+#define PINS_HISTORY_RING(name, n) static PinHistoryEntry name##_buf[n]; \
+    static PinHistory name = {name##_buf, n, 0, 0};
+#define PINS_HISTORY_PTR(name) ,name
+#define PINS_HISTORY_NULL ,OS_NULL
+
+/* Set IO device whose pins are recorded and clear the history, called by pins_setup().
+ */
+void pins_setup_history(
+    const IoPinsHdr *pins_hdr);
+
+/* Record pin value, if it differs from the last one recorded.
+ */
+void pin_history_record(
+    const Pin *pin,
+    os_int x,
+    os_char state_bits);
+
+/* Get min, max and time weighted mean of pin value over time window.
+ */
+osalStatus pin_history_stats(
+    const Pin *pin,
+    os_int window_ms,
+    PinHistoryStats *stats);
+
+/* Copy recorded values within time window, oldest first.
+ */
+os_int pin_history_copy(
+    const Pin *pin,
+    os_int window_ms,
+    PinHistoryEntry *buf,
+    os_int buf_n);
+
+/* Clear history of all pins.
+ */
+void pins_reset_history(void);
+
+#else
+
+#define PINS_HISTORY_PTR(name)
+#define PINS_HISTORY_NULL
+
+#endif
+#endif
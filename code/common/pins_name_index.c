@@ -0,0 +1,94 @@
+/**
+
+  @file    common/pins_name_index.c
+  @brief   Find pins by name trough generated perfect hash.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pins.h"
+#if PINS_NAME_INDEX
+
+
+/**
+****************************************************************************************************
+
+  @brief Find pin by name.
+  @anchor pins_find_by_name
+
+  The pins_find_by_name() function looks up a pin by "group.pin" name, for example
+  "inputs.dip_switch_3", or the first pin of application pin group by group name, like
+  "leds". The rest of the group is found trough PIN_NEXT(). Lookup time does not depend on
+  number of pins.
+
+  @param   hdr Top level pins IO configuration structure.
+  @param   name Name to look for.
+  @return  Pointer to pin structure, OS_NULL if there is no pin with this name or the
+           configuration has no name index.
+
+****************************************************************************************************
+*/
+const Pin *pins_find_by_name(
+    const IoPinsHdr *hdr,
+    const os_char *name)
+{
+    const PinsNameIndex *ix;
+    os_short d;
+    os_uint slot;
+
+    ix = hdr->name_index;
+    if (ix == OS_NULL || name == OS_NULL) return OS_NULL;
+
+    d = ix->g[pins_name_hash(name, 0) % (os_uint)ix->n];
+    if (d < 0) {
+        slot = (os_uint)(-1 - d);
+    }
+    else {
+        slot = pins_name_hash(name, (os_uint)d) % (os_uint)ix->n;
+    }
+
+    /* Any name hashes to some slot, check that it is the right one.
+     */
+    if (os_strcmp(ix->name[slot], name)) return OS_NULL;
+    return ix->pin[slot];
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Hash function of the name index.
+  @anchor pins_name_hash
+
+  32 bit FNV-1a hash, the seed is XORed into the offset basis. Low bits of FNV depend only
+  on low bits of the input, so high bits are folded in since the result is used modulo
+  number of names. Must match name_hash() in pins_to_c.py.
+
+  @param   name Name to hash, '\0' terminated UTF-8 string.
+  @param   seed 0 to select bucket, displacement from the index to select slot.
+  @return  Hash value.
+
+****************************************************************************************************
+*/
+os_uint pins_name_hash(
+    const os_char *name,
+    os_uint seed)
+{
+    os_uint h;
+
+    h = 2166136261U ^ seed;
+    while (*name) {
+        h ^= (os_uchar)*(name++);
+        h *= 16777619U;
+    }
+    return h ^ (h >> 16);
+}
+
+#endif
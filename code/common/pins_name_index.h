@@ -0,0 +1,42 @@
+/**
+
+  @file    common/pins_name_index.h
+  @brief   Find pins by name trough generated perfect hash.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  pins_to_c.py generates minimal perfect hash over "group.pin" names of all pins, like
+  "inputs.dip_switch_3", and names of application pin groups (the *_GROUP defines), like
+  "leds". Lookup hashes the name twice at most and compares it to one name, no hash table
+  is built in RAM. Useful for diagnostic shells and remote configuration, which address
+  pins by name.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#pragma once
+#ifndef PINS_NAME_INDEX_H_
+#define PINS_NAME_INDEX_H_
+#include "pins.h"
+
+#if PINS_NAME_INDEX
+
+/* Find pin by name.
+ */
+const Pin *pins_find_by_name(
+    const IoPinsHdr *hdr,
+    const os_char *name);
+
+/* Hash function of the name index, pins_to_c.py implements the same.
+ */
+os_uint pins_name_hash(
+    const os_char *name,
+    os_uint seed);
+
+#endif
+#endif
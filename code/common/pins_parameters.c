@@ -15,6 +15,36 @@
 */
 #include "pins.h"
 
+#if PINS_COMPACT
+/** Parameter value modified by pin_set_prm(). In compact mode parameters are constant
+    (in flash), so modified values are kept in this small table. The pin is identified by
+    index of it's runtime value.
+ */
+typedef struct PinPrmOverride
+{
+    pin_cix rv;
+    os_short prm;
+    os_short value;
+}
+PinPrmOverride;
+
+static PinPrmOverride pin_prm_overrides[PINS_PRM_OVERRIDES];
+static volatile os_short pin_nro_prm_overrides;
+#endif
+
+/* Forward referred static functions.
+ */
+static inline const PinPrmValue *pin_find_prm(
+    const Pin *pin,
+    pinPrm prm);
+
+#if PINS_COMPACT
+static PinPrmOverride *pin_find_prm_override(
+    const Pin *pin,
+    pinPrm prm);
+#endif
+
+
 /**
 ****************************************************************************************************
 
@@ -24,6 +54,12 @@
   The pin_set_prm() function sets parameter value. Notce that only parameters configured for
   the IO pin in JSON can be set. Attempt to set not configured parameter, will be ignored.
 
+  If the pin has parameter slot map generated by pins_to_c.py, the parameter is located
+  by single indexed load. Otherwise parameter array is searched.
+
+  In compact mode (PINS_COMPACT) the parameter array is constant and the new value is
+  stored in override table of PINS_PRM_OVERRIDES entries.
+
   @param   pin Pointer to static information structure for the pin.
   @param   prm Parameter number which to get like PIN_TOUCH, PIN_SPEED... See pinPrm enumeration
            in pins_basics.h for full list.
@@ -37,21 +73,57 @@ void pin_set_prm(
     pinPrm prm,
     os_int value)
 {
-    PinPrmValue *p;
-    os_char count;
+    const PinPrmValue *p;
+#if PINS_COMPACT
+    PinPrmOverride *o;
+#endif
+
+    p = pin_find_prm(pin, prm);
+    if (p == OS_NULL) {
+        osal_debug_error_int("Attemp to set nonexistent pin parameter ", prm);
+        return;
+    }
 
-    p = pin->prm + PINS_N_RESERVED;
-    count = pin->prm_n - PINS_N_RESERVED;
-    while (count-- > 0)
+#if PINS_COMPACT
+    o = pin_find_prm_override(pin, prm);
+    if (o == OS_NULL)
     {
-        if (p->ix == (os_short)prm) {
-            p->value = (os_short)value;
+        if (pin_nro_prm_overrides >= PINS_PRM_OVERRIDES) {
+            osal_debug_error_int("pin_set_prm: Too many modified parameters, PINS_PRM_OVERRIDES=",
+                PINS_PRM_OVERRIDES);
             return;
         }
-        p++;
+        o = pin_prm_overrides + pin_nro_prm_overrides;
+        o->rv = pin->rv;
+        o->prm = (os_short)prm;
+        o->value = (os_short)value;
+        PINS_MEMORY_BARRIER();
+        pin_nro_prm_overrides++;
+    }
+    else {
+        o->value = (os_short)value;
     }
+#else
+    ((PinPrmValue*)p)->value = (os_short)value;
+#endif
 
-    osal_debug_error_int("Attemp to set nonexistent pin parameter ", prm);
+    /* If scaling parameter was modified, recalculate precomputed scaling.
+     */
+    if (prm >= PIN_MIN && prm <= PIN_DIGS &&
+        (pin->flags & PIN_SCALING_SET))
+    {
+        pin_setup_scaling(pin);
+    }
+
+#if PINS_INPUT_FILTERS
+    /* If filter parameter was modified, set up the filter again (does nothing if the pin
+       has no filter).
+     */
+    if (prm >= PIN_AVG && prm <= PIN_DEBOUNCE)
+    {
+        pin_setup_filter(pin);
+    }
+#endif
 }
 
 
@@ -64,6 +136,9 @@ void pin_set_prm(
   The pin_get_prm() function returns a parameter value configured for the IO pin in JSON. Some
   parameter values may also be modified in run time.
 
+  The parameter is located trough generated slot map, if the pin has one. This makes parameter
+  access constant time, which matters since parameters are read for every pin in every loop.
+
   @param   pin Pointer to static information structure for the pin.
   @param   prm Parameter number which to get like PIN_TOUCH, PIN_SPEED... See pinPrm enumeration
            in pins_basics.h for full list.
@@ -76,23 +151,104 @@ os_int pin_get_prm(
     const Pin *pin,
     pinPrm prm)
 {
-    PinPrmValue *p;
+    const PinPrmValue *p;
+#if PINS_COMPACT
+    PinPrmOverride *o;
+
+    if (pin_nro_prm_overrides)
+    {
+        o = pin_find_prm_override(pin, prm);
+        if (o) return o->value;
+    }
+#endif
+
+    /* Default is zero, not finding the parameter is not error.
+     */
+    p = pin_find_prm(pin, prm);
+    return p ? p->value : 0;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Find parameter configured for the pin.
+  @anchor pin_find_prm
+
+  The pin_find_prm() function looks up parameter trough slot map, if the pin has one, or
+  searches pin's parameter array.
+
+  @param   pin Pointer to static information structure for the pin.
+  @param   prm Parameter number, see pinPrm enumeration.
+  @return  Pointer to parameter in pin's parameter array, OS_NULL if parameter is not set.
+
+****************************************************************************************************
+*/
+static inline const PinPrmValue *pin_find_prm(
+    const Pin *pin,
+    pinPrm prm)
+{
+    const PinPrmValue *p;
     os_char count;
 
-    p = pin->prm + PINS_N_RESERVED;
-    count = pin->prm_n - PINS_N_RESERVED;
+#if PINS_PRM_SLOT_MAP
+    const os_uchar *slot;
+    os_uchar n;
+    osal_debug_assert(prm < PIN_NRO_PRMS);
+
+    slot = PIN_PRM_SLOT(pin);
+    if (slot)
+    {
+        n = slot[prm];
+        return n ? PIN_PRM(pin) + (n - 1) : OS_NULL;
+    }
+#endif
+
+    p = PIN_PRM(pin);
+    count = pin->prm_n;
     while (count-- > 0)
     {
         if (p->ix == (os_short)prm) {
-            return p->value;
+            return p;
         }
         p++;
     }
+    return OS_NULL;
+}
 
-    /* Default is zero, getting here is not error.
-     */
-    return 0;
+
+#if PINS_COMPACT
+/**
+****************************************************************************************************
+
+  @brief Find modified parameter value in override table.
+  @anchor pin_find_prm_override
+
+  @param   pin Pointer to static information structure for the pin.
+  @param   prm Parameter number, see pinPrm enumeration.
+  @return  Pointer to override table entry, OS_NULL if the parameter has not been modified.
+
+****************************************************************************************************
+*/
+static PinPrmOverride *pin_find_prm_override(
+    const Pin *pin,
+    pinPrm prm)
+{
+    PinPrmOverride *o;
+    os_short n;
+
+    o = pin_prm_overrides;
+    n = pin_nro_prm_overrides;
+    while (n-- > 0)
+    {
+        if (o->rv == pin->rv && o->prm == (os_short)prm) {
+            return o;
+        }
+        o++;
+    }
+    return OS_NULL;
 }
+#endif
 
 
 /**
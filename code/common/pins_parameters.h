@@ -18,6 +18,27 @@
 #define PINS_PARAMETERS_H_
 #include "pins.h"
 
+/* If we need to store parameter slot map pointer for the pin.
+ */
+#if PINS_PRM_SLOT_MAP
+#define PINS_PRM_SLOTS_PTR(name) ,name
+#define PINS_PRM_SLOTS_NULL ,OS_NULL
+#define PINS_PRM_SLOTS_IX(n) ,n
+#else
+#define PINS_PRM_SLOTS_PTR(name)
+#define PINS_PRM_SLOTS_NULL
+#define PINS_PRM_SLOTS_IX(n)
+#endif
+
+/* Compact mode: Maximum number of parameters which can be modified by pin_set_prm() in
+   run time, constant parameters themselves cannot be written.
+ */
+#if PINS_COMPACT
+#ifndef PINS_PRM_OVERRIDES
+#define PINS_PRM_OVERRIDES 16
+#endif
+#endif
+
 /* Modify IO pin parameter.
  */
 void pin_set_prm(
@@ -0,0 +1,305 @@
+/**
+
+  @file    common/pins_profiler.c
+  @brief   Main loop phase profiler.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pins.h"
+#if PINS_PROFILER
+
+/* Measurements for all phases.
+ */
+static PinsProfPhase pins_prof[PINS_PROFILER_MAX_PHASES] = {
+    {"read_all"},
+    {"devicebus"},
+    {"display"},
+    {"morse"}
+};
+
+/* Forward referred static functions.
+ */
+static void pins_profiler_append(
+    os_char *buf,
+    os_memsz buf_sz,
+    const os_char *label,
+    os_long x);
+
+
+/**
+****************************************************************************************************
+
+  @brief Start of phase.
+  @anchor pins_profile_begin
+
+  The pins_profile_begin() function records start time of the phase. Use PINS_PROFILE_BEGIN()
+  macro, so that call is compiled out when profiler is not enabled.
+
+  @param   id Phase identifier, PINS_PROF_READ_ALL... or application's phase.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_profile_begin(
+    os_int id)
+{
+    PinsProfPhase *p;
+    os_int64 now;
+    os_uint period;
+
+    if ((os_uint)id >= PINS_PROFILER_MAX_PHASES) return;
+    p = pins_prof + id;
+    /* One is added so that zero start time always means "not started".
+     */
+    now = pins_now_us() + 1;
+
+    if (p->prev_start_us)
+    {
+        period = (os_uint)(now - p->prev_start_us);
+        if (period < p->min_period_us || p->min_period_us == 0) p->min_period_us = period;
+        if (period > p->max_period_us) p->max_period_us = period;
+    }
+    p->prev_start_us = now;
+    p->start_us = now;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief End of phase.
+  @anchor pins_profile_end
+
+  The pins_profile_end() function adds duration since pins_profile_begin() to the phase's
+  statistics and ring of recent durations.
+
+  @param   id Phase identifier.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_profile_end(
+    os_int id)
+{
+    PinsProfPhase *p;
+    os_uint d;
+
+    if ((os_uint)id >= PINS_PROFILER_MAX_PHASES) return;
+    p = pins_prof + id;
+    if (p->start_us == 0) return;
+
+    d = (os_uint)(pins_now_us() + 1 - p->start_us);
+    p->start_us = 0;
+
+    if (d < p->min_us || p->n_calls == 0) p->min_us = d;
+    if (d > p->max_us) p->max_us = d;
+    p->sum_us += d;
+    p->n_calls++;
+
+    p->recent_us[p->recent_pos] = d;
+    if (++(p->recent_pos) >= PINS_PROFILER_RING_SZ) p->recent_pos = 0;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Name an application phase.
+  @anchor pins_set_profile_phase_name
+
+  Phases without name are not included in text dump or JSON export.
+
+  @param   id Phase identifier, PINS_PROF_APP or above.
+  @param   name Phase name, the string must remain valid.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_set_profile_phase_name(
+    os_int id,
+    const os_char *name)
+{
+    if ((os_uint)id >= PINS_PROFILER_MAX_PHASES) return;
+    pins_prof[id].name = name;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Take snapshot of measurements for one phase.
+  @anchor pins_get_profile_phase
+
+  @param   id Phase identifier.
+  @param   phase Where to store the snapshot.
+  @return  OSAL_SUCCESS if all good, OSAL_STATUS_FAILED if id is out of range.
+
+****************************************************************************************************
+*/
+osalStatus pins_get_profile_phase(
+    os_int id,
+    PinsProfPhase *phase)
+{
+    if ((os_uint)id >= PINS_PROFILER_MAX_PHASES) return OSAL_STATUS_FAILED;
+    os_memcpy(phase, pins_prof + id, sizeof(PinsProfPhase));
+    return OSAL_SUCCESS;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Clear all measurements.
+  @anchor pins_reset_profiler
+
+  Phase names are kept.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_reset_profiler(void)
+{
+    const os_char *name;
+    os_int i;
+
+    for (i = 0; i < PINS_PROFILER_MAX_PHASES; i++)
+    {
+        name = pins_prof[i].name;
+        os_memclear(pins_prof + i, sizeof(PinsProfPhase));
+        pins_prof[i].name = name;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Write human readable summary of all phases.
+  @anchor pins_profiler_text
+
+  The pins_profiler_text() function writes one line for each named phase, for example
+  "read_all: calls=1000 min=12us avg=15us max=90us jitter=40us". The output is truncated
+  if buffer is too small.
+
+  @param   buf Buffer where to write the summary.
+  @param   buf_sz Buffer size in bytes.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_profiler_text(
+    os_char *buf,
+    os_memsz buf_sz)
+{
+    PinsProfPhase *p;
+    os_int i;
+
+    *buf = '\0';
+    for (i = 0; i < PINS_PROFILER_MAX_PHASES; i++)
+    {
+        p = pins_prof + i;
+        if (p->name == OS_NULL) continue;
+
+        os_strncat(buf, p->name, buf_sz);
+        pins_profiler_append(buf, buf_sz, ": calls=", p->n_calls);
+        pins_profiler_append(buf, buf_sz, " min=", p->min_us);
+        pins_profiler_append(buf, buf_sz, "us avg=", p->n_calls ? p->sum_us / p->n_calls : 0);
+        pins_profiler_append(buf, buf_sz, "us max=", p->max_us);
+        pins_profiler_append(buf, buf_sz, "us jitter=", p->max_period_us - p->min_period_us);
+        os_strncat(buf, "us\n", buf_sz);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Write summary of all phases as JSON.
+  @anchor pins_profiler_json
+
+  The pins_profiler_json() function writes named phases as JSON for tools, for example
+  {"phases":[{"name":"read_all","calls":1000,"min_us":12,"avg_us":15,"max_us":90,
+  "jitter_us":40,"recent_us":[15,14,...]}]}. Recent durations are listed oldest first.
+  The output is truncated if buffer is too small.
+
+  @param   buf Buffer where to write the JSON.
+  @param   buf_sz Buffer size in bytes.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_profiler_json(
+    os_char *buf,
+    os_memsz buf_sz)
+{
+    PinsProfPhase *p;
+    os_int i, j, n, pos;
+    os_boolean first = OS_TRUE;
+
+    os_strncpy(buf, "{\"phases\":[", buf_sz);
+    for (i = 0; i < PINS_PROFILER_MAX_PHASES; i++)
+    {
+        p = pins_prof + i;
+        if (p->name == OS_NULL) continue;
+
+        os_strncat(buf, first ? "{\"name\":\"" : ",{\"name\":\"", buf_sz);
+        first = OS_FALSE;
+        os_strncat(buf, p->name, buf_sz);
+        pins_profiler_append(buf, buf_sz, "\",\"calls\":", p->n_calls);
+        pins_profiler_append(buf, buf_sz, ",\"min_us\":", p->min_us);
+        pins_profiler_append(buf, buf_sz, ",\"avg_us\":", p->n_calls ? p->sum_us / p->n_calls : 0);
+        pins_profiler_append(buf, buf_sz, ",\"max_us\":", p->max_us);
+        pins_profiler_append(buf, buf_sz, ",\"jitter_us\":", p->max_period_us - p->min_period_us);
+        os_strncat(buf, ",\"recent_us\":[", buf_sz);
+
+        n = p->n_calls < PINS_PROFILER_RING_SZ ? (os_int)p->n_calls : PINS_PROFILER_RING_SZ;
+        pos = p->recent_pos - n;
+        if (pos < 0) pos += PINS_PROFILER_RING_SZ;
+        for (j = 0; j < n; j++)
+        {
+            pins_profiler_append(buf, buf_sz, j ? "," : "", p->recent_us[pos]);
+            if (++pos >= PINS_PROFILER_RING_SZ) pos = 0;
+        }
+        os_strncat(buf, "]}", buf_sz);
+    }
+    os_strncat(buf, "]}", buf_sz);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Append label and integer to string buffer.
+  @anchor pins_profiler_append
+
+  @param   buf String buffer.
+  @param   buf_sz Buffer size in bytes.
+  @param   label Text to append before the number.
+  @param   x Number to append.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_profiler_append(
+    os_char *buf,
+    os_memsz buf_sz,
+    const os_char *label,
+    os_long x)
+{
+    os_char nbuf[OSAL_NBUF_SZ];
+
+    os_strncat(buf, label, buf_sz);
+    osal_int_to_str(nbuf, sizeof(nbuf), x);
+    os_strncat(buf, nbuf, buf_sz);
+}
+
+#endif
@@ -0,0 +1,133 @@
+/**
+
+  @file    common/pins_profiler.h
+  @brief   Main loop phase profiler.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Measures how long each phase of the application loop takes: pins_read_all(),
+  pins_run_devicebus(), run_display(), blink_morse_code() and phases marked by the application
+  with PINS_PROFILE_BEGIN()/PINS_PROFILE_END(). For each phase minimum, average and maximum
+  duration, jitter of the call period and a ring of most recent durations are kept. Cost is
+  two clock reads and a few additions per phase, so it can be left on in production.
+  Enabled by defining PINS_PROFILER=1 for the build.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#pragma once
+#ifndef PINS_PROFILER_H_
+#define PINS_PROFILER_H_
+#include "pins.h"
+
+#if PINS_PROFILER
+
+/** Maximum number of phases, library phases included.
+ */
+#ifndef PINS_PROFILER_MAX_PHASES
+#define PINS_PROFILER_MAX_PHASES 16
+#endif
+
+/** Number of recent durations kept for each phase.
+ */
+#ifndef PINS_PROFILER_RING_SZ
+#define PINS_PROFILER_RING_SZ 32
+#endif
+
+/** Phase identifiers used by the library. Application phases are numbered from
+    PINS_PROF_APP up to PINS_PROFILER_MAX_PHASES - 1.
+ */
+#define PINS_PROF_READ_ALL 0
+#define PINS_PROF_DEVICEBUS 1
+#define PINS_PROF_DISPLAY 2
+#define PINS_PROF_MORSE 3
+#define PINS_PROF_APP 4
+
+/** Measurements for one phase, durations in microseconds.
+ */
+typedef struct PinsProfPhase
+{
+    /** Phase name for text dump and export, OS_NULL if phase is not used.
+     */
+    const os_char *name;
+
+    /** Number of completed calls, and minimum, maximum and sum of durations.
+     */
+    os_uint n_calls;
+    os_uint min_us;
+    os_uint max_us;
+    os_int64 sum_us;
+
+    /** Shortest and longest time from start of previous call to start of this one.
+        Jitter is the difference.
+     */
+    os_uint min_period_us;
+    os_uint max_period_us;
+
+    /** Start time of current and previous call.
+     */
+    os_int64 start_us;
+    os_int64 prev_start_us;
+
+    /** Most recent durations, recent_pos is where next one is written.
+     */
+    os_uint recent_us[PINS_PROFILER_RING_SZ];
+    os_short recent_pos;
+}
+PinsProfPhase;
+
+/* Mark start and end of profiled phase.
+ */
+#define PINS_PROFILE_BEGIN(id) pins_profile_begin(id)
+#define PINS_PROFILE_END(id) pins_profile_end(id)
+
+/* Start of phase.
+ */
+void pins_profile_begin(
+    os_int id);
+
+/* End of phase.
+ */
+void pins_profile_end(
+    os_int id);
+
+/* Name an application phase.
+ */
+void pins_set_profile_phase_name(
+    os_int id,
+    const os_char *name);
+
+/* Take snapshot of measurements for one phase.
+ */
+osalStatus pins_get_profile_phase(
+    os_int id,
+    PinsProfPhase *phase);
+
+/* Clear all measurements.
+ */
+void pins_reset_profiler(void);
+
+/* Write human readable summary of all phases.
+ */
+void pins_profiler_text(
+    os_char *buf,
+    os_memsz buf_sz);
+
+/* Write summary of all phases as JSON.
+ */
+void pins_profiler_json(
+    os_char *buf,
+    os_memsz buf_sz);
+
+#else
+
+#define PINS_PROFILE_BEGIN(id)
+#define PINS_PROFILE_END(id)
+
+#endif
+#endif
@@ -0,0 +1,207 @@
+/**
+
+  @file    common/pins_scaling.c
+  @brief   Precomputed pin value scaling.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pins.h"
+
+
+/**
+****************************************************************************************************
+
+  @brief Calculate gain and offset for a pin.
+  @anchor pin_calculate_scaling
+
+  The pin_calculate_scaling() function reads "min", "max", "smin", "smax" and "digs" parameters
+  of the pin and calculates gains and offsets for both directions. This is the only place where
+  scaling parameters are interpreted.
+
+  @param   pin Pointer to pin configuration structure.
+  @param   scaling Pointer to structure where to store the result.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pin_calculate_scaling(
+    const Pin *pin,
+    PinScaling *scaling)
+{
+    os_double pow10;
+    os_int maxx, maxy, digs, dx, dy;
+
+    os_memclear(scaling, sizeof(PinScaling));
+
+    scaling->minx = pin_get_prm(pin, PIN_MIN);
+    maxx = pin_get_prm(pin, PIN_MAX);
+    scaling->miny = pin_get_prm(pin, PIN_SMIN);
+    maxy = pin_get_prm(pin, PIN_SMAX);
+    digs = pin_get_prm(pin, PIN_DIGS);
+
+    dx = maxx - scaling->minx;
+    dy = maxy - scaling->miny;
+    if (dx == 0 || dy == 0) {
+        osal_debug_error_int("Pin scaling error, pin addr=", pin->addr);
+        return;
+    }
+
+    pow10 = 1.0;
+    while (digs > 0) {
+        pow10 *= 10.0;
+        digs--;
+    }
+    while (digs < 0) {
+        pow10 *= 0.1;
+        digs++;
+    }
+
+    scaling->gain = (os_double)dy / ((os_double)dx * pow10);
+    scaling->offset = scaling->miny / pow10 - scaling->gain * scaling->minx;
+    scaling->inv_gain = (os_double)dx * pow10 / (os_double)dy;
+    scaling->inv_offset = scaling->minx - (os_double)dx / (os_double)dy * scaling->miny;
+
+    scaling->gain_q = (os_int)((((os_int64)dy << PINS_SCALING_Q) + dx / 2) / dx);
+    scaling->inv_gain_q = (os_int)((((os_int64)dx << PINS_SCALING_Q) + dy / 2) / dy);
+    scaling->valid = OS_TRUE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get scaling for a pin.
+  @anchor pin_get_scaling
+
+  The pin_get_scaling() function returns pointer to precomputed scaling for the pin. If the
+  pin has no storage for precomputed scaling (hand written configuration or PINS_SCALING_CACHE
+  is zero), scaling is calculated into tmp.
+
+  @param   pin Pointer to pin configuration structure.
+  @param   tmp Temporary structure used if scaling is not precomputed.
+  @return  Pointer to scaling structure.
+
+****************************************************************************************************
+*/
+const PinScaling *pin_get_scaling(
+    const Pin *pin,
+    PinScaling *tmp)
+{
+#if PINS_SCALING_CACHE
+    if (PIN_SCALING(pin)) {
+        return PIN_SCALING(pin);
+    }
+#endif
+    pin_calculate_scaling(pin, tmp);
+    return tmp;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Calculate and store precomputed scaling for a pin.
+  @anchor pin_setup_scaling
+
+  The pin_setup_scaling() function is called by pins_setup() for every pin with PIN_SCALING_SET
+  flag, and by pin_set_prm() when scaling parameter is modified.
+
+  @param   pin Pointer to pin configuration structure.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pin_setup_scaling(
+    const Pin *pin)
+{
+#if PINS_SCALING_CACHE
+    if (PIN_SCALING(pin)) {
+        pin_calculate_scaling(pin, PIN_SCALING(pin));
+    }
+#endif
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get scaled pin value as integer.
+  @anchor pin_value_scaled_int
+
+  The pin_value_scaled_int() function is like pin_value_scaled(), but uses only integer
+  arithmetic and returns value in "smin" ... "smax" range, decimal digits are not applied.
+  For example with "digs": 1 value 123 means 12.3. Useful on targets without FPU.
+
+  @param   pin Pointer to pin configuration structure.
+  @param   state_bits Pointer to byte where to store state bits, Set OS_NULL if not needed.
+  @return  Scaled integer value.
+
+****************************************************************************************************
+*/
+os_int pin_value_scaled_int(
+    const Pin *pin,
+    os_char *state_bits)
+{
+    const PinScaling *scaling;
+    PinScaling tmp;
+    os_int ivalue;
+
+    ivalue = pin_value(pin, state_bits);
+    if ((pin->flags & PIN_SCALING_SET) == 0) {
+        return ivalue;
+    }
+
+    scaling = pin_get_scaling(pin, &tmp);
+    if (!scaling->valid) {
+        return ivalue;
+    }
+
+    return scaling->miny + (os_int)(((os_int64)(ivalue - scaling->minx) * scaling->gain_q
+        + (1 << (PINS_SCALING_Q - 1))) >> PINS_SCALING_Q);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Set IO pin state with integer scaling.
+  @anchor pin_set_scaled_int
+
+  The pin_set_scaled_int() function is integer only version of pin_set_scaled(). Value y
+  is given in "smin" ... "smax" range, without decimal digits applied.
+
+  @param   pin Pointer to pin configuration structure.
+  @param   y Scaled integer value to set.
+  @param   flags PIN_FORWARD_TO_IOCOM to forward change to IOCOM.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pin_set_scaled_int(
+    const Pin *pin,
+    os_int y,
+    os_short flags)
+{
+    const PinScaling *scaling;
+    PinScaling tmp;
+
+    if (pin->flags & PIN_SCALING_SET)
+    {
+        scaling = pin_get_scaling(pin, &tmp);
+        if (scaling->valid)
+        {
+            y = scaling->minx + (os_int)(((os_int64)(y - scaling->miny) * scaling->inv_gain_q
+                + (1 << (PINS_SCALING_Q - 1))) >> PINS_SCALING_Q);
+        }
+    }
+
+    pin_set_ext(pin, y, flags);
+}
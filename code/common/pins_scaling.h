@@ -0,0 +1,104 @@
+/**
+
+  @file    common/pins_scaling.h
+  @brief   Precomputed pin value scaling.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Scaling for a pin is set by "min", "max", "smin", "smax" and "digs" attributes in JSON.
+  The gain and offset are calculated once when pins are set up, so scaling a value is just
+  a multiplication and addition. Integer only fixed point path is provided for targets
+  without floating point unit.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#pragma once
+#ifndef PINS_SCALING_H_
+#define PINS_SCALING_H_
+#include "pins.h"
+
+/** Number of fractional bits in fixed point gains.
+ */
+#define PINS_SCALING_Q 16
+
+/** Precomputed scaling for a pin. Floating point scaled value is x * gain + offset, including
+    decimal digits. Integer scaled value (smin...smax range) is
+    miny + ((x - minx) * gain_q) >> PINS_SCALING_Q.
+ */
+typedef struct PinScaling
+{
+    /** Hardware value to scaled floating point value.
+     */
+    os_double gain, offset;
+
+    /** Scaled floating point value to hardware value.
+     */
+    os_double inv_gain, inv_offset;
+
+    /** Fixed point gains for integer only path.
+     */
+    os_int gain_q, inv_gain_q;
+
+    /** Start of hardware value range and scaled integer range.
+     */
+    os_int minx, miny;
+
+    /** OS_TRUE if scaling parameters are sensible (nonzero ranges).
+     */
+    os_boolean valid;
+}
+PinScaling;
+
+/* If we need to store precomputed scaling by pin.
+ */
+#if PINS_SCALING_CACHE
+#define PINS_SCALING_STRUCT(name) static PinScaling name;
+#define PINS_SCALING_PTR(name) ,&name
+#define PINS_SCALING_NULL ,OS_NULL
+#define PINS_SCALING_TABLE(name, n) static PinScaling name[n];
+#define PINS_SCALING_IX(n) ,n
+#else
+#define PINS_SCALING_STRUCT(name)
+#define PINS_SCALING_PTR(name)
+#define PINS_SCALING_NULL
+#define PINS_SCALING_TABLE(name, n)
+#define PINS_SCALING_IX(n)
+#endif
+
+/* Calculate gain and offset for a pin from it's parameters.
+ */
+void pin_calculate_scaling(
+    const Pin *pin,
+    PinScaling *scaling);
+
+/* Get scaling for a pin, either precomputed or calculated into tmp.
+ */
+const PinScaling *pin_get_scaling(
+    const Pin *pin,
+    PinScaling *tmp);
+
+/* Calculate and store precomputed scaling for a pin, called by pins_setup().
+ */
+void pin_setup_scaling(
+    const Pin *pin);
+
+/* Get scaled pin value as integer without reading hardware (integer only).
+ */
+os_int pin_value_scaled_int(
+    const Pin *pin,
+    os_char *state_bits);
+
+/* Set IO pin state with integer scaling (integer only).
+ */
+void pin_set_scaled_int(
+    const Pin *pin,
+    os_int y,
+    os_short flags);
+
+#endif
@@ -19,6 +19,85 @@
  */
 pin_to_iocom_t *pin_to_iocom_func = OS_NULL;
 
+/* Function pointer to move a batch of changed pins to iocom. OS_NULL if not connected
+   to IOCOM or if the IOCOM extension doesn't support batches.
+ */
+pins_flush_iocom_t *pins_flush_iocom_func = OS_NULL;
+
+/* Journal of changed pins to be forwarded to IOCOM at end of the batch. A pin is in
+   the journal only once, PIN_RV_QUEUED bit in PinRV flags marks it. The journal belongs to
+   the thread which started the outermost batch, typically the main loop, and only that
+   thread accesses it, so journaling a pin needs no lock. Devicebus threads and other
+   threads calling pin_set_ext() meanwhile forward their changes directly.
+ */
+static const Pin *pins_journal[PINS_IOCOM_JOURNAL_SZ];
+static os_int pins_journal_n;
+
+/* Set while some thread owns the journal, accessed within os_lock() once per batch.
+ */
+static os_boolean pins_journal_busy;
+
+/* Batch nesting depth of calling thread, and OS_TRUE if calling thread owns the journal.
+ */
+static PINS_THREAD_LOCAL os_int pins_batch_depth;
+static PINS_THREAD_LOCAL os_boolean pins_batch_owner;
+
+#if PINS_BANK_IO
+/* GPIO bank snapshots taken during one pins_read_all() call.
+ */
+typedef struct PinsBankSnapshot
+{
+    os_uint bits[PINS_MAX_GPIO_BANKS];
+    os_char state_bits[PINS_MAX_GPIO_BANKS];
+    os_uint read_mask;
+}
+PinsBankSnapshot;
+
+/* GPIO output bank writes collected by pins_set_group() or pins_set_array().
+ */
+typedef struct PinsBankWrite
+{
+    os_uint mask[PINS_MAX_GPIO_BANKS];
+    os_uint bits[PINS_MAX_GPIO_BANKS];
+}
+PinsBankWrite;
+#endif
+
+/* Forward referred static functions.
+ */
+static void pin_forward_to_iocom(
+    const Pin *pin);
+
+static void pin_store_value(
+    const Pin *pin,
+    os_int x,
+    os_short flags);
+
+#if PINS_BANK_IO
+static os_int pin_get_from_bank(
+    const Pin *pin,
+    PinsBankSnapshot *snapshot,
+    os_char *state_bits);
+
+static void pins_write_banks(
+    PinsBankWrite *w);
+#endif
+
+static void pin_write_hw(
+    const Pin *pin,
+    os_int x,
+    void *bank_write);
+
+static inline os_boolean pin_filter_and_store(
+    const Pin *pin,
+    os_int x,
+    os_char state_bits);
+
+#if PINS_SCAN_PLAN
+static void pins_read_plan(
+    const PinsScanPlan *plan);
+#endif
+
 
 /**
 ****************************************************************************************************
@@ -28,7 +107,11 @@ pin_to_iocom_t *pin_to_iocom_func = OS_NULL;
 
   The pins_setup() function...
   @param   pins_hdr Top level pins IO configuration structure.
-  @param   flags Reserved for future, set 0 for now.
+  @param   flags PINS_DEFAULT to initialize everything before returning. PINS_DEFER_DEVICE_INIT
+           to set up pins and SPI/I2C device structures, but leave opening SPI and I2C
+           devices to devicebus: Each devicebus thread opens devices of its own bus, so
+           buses are initialized in parallel, or pins_run_devicebus() opens device on its
+           first turn. Check readiness by pins_devicebus_pending() or device's init_state.
 
   @return  If pins library is successfully set up, the function returns OSAL_SUCCESS.
            Other return values indicate an error.
@@ -45,6 +128,12 @@ osalStatus pins_setup(
     osalStatus s;
 
     s = pins_ll_initialize_lib();
+#if PINS_STATISTICS
+    pins_setup_stats(pins_hdr);
+#endif
+#if PINS_HISTORY
+    pins_setup_history(pins_hdr);
+#endif
 
     gcount = pins_hdr->n_groups;
     group = pins_hdr->group;
@@ -57,14 +146,22 @@ osalStatus pins_setup(
         while (pcount--)
         {
 #if PINS_SPI || PINS_I2C
-            if (pin->bus_device == OS_NULL) {
+            if (PIN_BUS_DEVICE(pin) == OS_NULL) {
                 pin_ll_setup(pin, flags);
             }
 #else
             pin_ll_setup(pin, flags);
 #endif
-            ((PinRV*)pin->prm)->value = pin_get_prm(pin, PIN_INIT);
-            ((PinRV*)pin->prm)->state_bits = OSAL_STATE_NO_READ_SUPPORT;
+            PIN_RV(pin)->value = pin_get_prm(pin, PIN_INIT);
+            PIN_RV(pin)->state_bits = OSAL_STATE_NO_READ_SUPPORT;
+            if (pin->flags & PIN_SCALING_SET) {
+                pin_setup_scaling(pin);
+            }
+#if PINS_INPUT_FILTERS
+            if (PIN_FILTER(pin)) {
+                pin_setup_filter(pin);
+            }
+#endif
             pin++;
         }
 
@@ -73,6 +170,7 @@ osalStatus pins_setup(
 
 #if PINS_SPI || PINS_I2C
     /* SPI and I2C initialization. */
+    pins_devicebus.defer_device_init = (os_boolean)((flags & PINS_DEFER_DEVICE_INIT) != 0);
     pins_initialize_bus_devices();
 #endif
 
@@ -143,34 +241,108 @@ void pin_set_ext(
     os_int x,
     os_short flags)
 {
-#if PINS_SPI || PINS_I2C
-    if (pin->bus_device) {
-        pin->bus_device->set_func(pin->bus_device, pin->addr, x);
+#if PINS_STATISTICS
+    PinsStatsTime stats_t;
+    PINS_STATS_START(&stats_t);
+    pin_write_hw(pin, x, OS_NULL);
+    pin_stats_write(pin, &stats_t);
+#else
+    pin_write_hw(pin, x, OS_NULL);
+#endif
+    pin_store_value(pin, x, flags);
+}
 
-/* osal_trace_int("~HERE Setting BUS DEVICE pin addr ", pin->addr);
-osal_trace_int("HERE to value ", x); */
 
+/**
+****************************************************************************************************
+
+  @brief Set states of a group of IO pins.
+  @anchor pins_set_group
+
+  The pins_set_group() function writes values to all pins in group, linked by Pin.next. If the
+  backend supports bank IO (PINS_BANK_IO), digital outputs within same GPIO bank are written
+  with one pin_ll_set_bank() call. How close together the outputs change depends on the
+  backend, on Raspberry PI outputs set and outputs cleared are two separate register writes.
+  Other pins, like bus device pins, are written one by one.
+
+  @param   pin Pointer to first pin of the group.
+  @param   x Array of values to set, one for each pin in group in Pin.next order.
+  @param   flags PIN_FORWARD_TO_IOCOM to forward changes to IOCOM.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_set_group(
+    const Pin *pin,
+    const os_int *x,
+    os_short flags)
+{
+    const Pin *p;
+    os_int i;
+#if PINS_BANK_IO
+    PinsBankWrite bank_write, *w;
+    os_memclear(&bank_write, sizeof(bank_write));
+    w = &bank_write;
+#else
+    void *w = OS_NULL;
+#endif
+
+    for (p = pin, i = 0; p; p = PIN_NEXT(p), i++) {
+        pin_write_hw(p, x[i], w);
     }
-    else {
-        pin_ll_set(pin, x);
+
+#if PINS_BANK_IO
+    pins_write_banks(w);
+#endif
+
+    for (p = pin, i = 0; p; p = PIN_NEXT(p), i++) {
+        pin_store_value(p, x[i], flags);
     }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Set states of IO pins given as array.
+  @anchor pins_set_array
+
+  The pins_set_array() function is like pins_set_group(), but pins are given as array of
+  pointers. Pins do not need to belong to same group.
+
+  @param   pins Array of pin pointers.
+  @param   x Array of values to set, one for each pin.
+  @param   n_pins Number of pins in arrays.
+  @param   flags PIN_FORWARD_TO_IOCOM to forward changes to IOCOM.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_set_array(
+    const Pin * const *pins,
+    const os_int *x,
+    os_int n_pins,
+    os_short flags)
+{
+    os_int i;
+#if PINS_BANK_IO
+    PinsBankWrite bank_write, *w;
+    os_memclear(&bank_write, sizeof(bank_write));
+    w = &bank_write;
 #else
-    pin_ll_set(pin, x);
+    void *w = OS_NULL;
 #endif
 
-    if (flags & PIN_FORWARD_TO_IOCOM)
-    {
-        if (x != ((PinRV*)pin->prm)->value || ((PinRV*)pin->prm)->state_bits != OSAL_STATE_CONNECTED)
-        {
-            ((PinRV*)pin->prm)->value = x;
-            ((PinRV*)pin->prm)->state_bits = OSAL_STATE_CONNECTED;
+    for (i = 0; i < n_pins; i++) {
+        pin_write_hw(pins[i], x[i], w);
+    }
 
-                if (pin_to_iocom_func &&
-                    pin->signal)
-                {
-                    pin_to_iocom_func(pin);
-                }
-        }
+#if PINS_BANK_IO
+    pins_write_banks(w);
+#endif
+
+    for (i = 0; i < n_pins; i++) {
+        pin_store_value(pins[i], x[i], flags);
     }
 }
 
@@ -198,38 +370,17 @@ void pin_set_scaled(
     os_double x,
     os_boolean flags)
 {
-    os_double gain;
-    os_int minx, maxx, miny, maxy, digs, dx, dy;
+    const PinScaling *scaling;
+    PinScaling tmp;
 
     if (pin->flags & PIN_SCALING_SET)
     {
-        minx = pin_get_prm(pin, PIN_MIN);
-        maxx = pin_get_prm(pin, PIN_MAX);
-        miny = pin_get_prm(pin, PIN_SMIN);
-        maxy = pin_get_prm(pin, PIN_SMAX);
-        digs = pin_get_prm(pin, PIN_DIGS);
-
-        while (digs > 0) {
-            x *= 10.0;
-            digs--;
-        }
-
-        while (digs < 0) {
-            x *= 0.1;
-            digs++;
-        }
-
-        dx = maxx - minx;
-        dy = maxy - miny;
-        if (dx == 0 || dy == 0) {
-            osal_debug_error("Pin value scaling error (set)");
-            goto justset;
+        scaling = pin_get_scaling(pin, &tmp);
+        if (scaling->valid) {
+            x = scaling->inv_gain * x + scaling->inv_offset;
         }
-        gain = (os_double)dx / (os_double)dy;
-
-        x = gain * (x - miny) + minx;
     }
-justset:
+
     pin_set_ext(pin, os_round_int(x), flags);
 }
 
@@ -255,45 +406,147 @@ os_int pin_get_ext(
 {
     os_int x;
     os_char tmp_state_bits;
+#if PINS_STATISTICS
+    PinsStatsTime stats_t;
+#endif
 
     if (state_bits == OS_NULL) {
         state_bits = &tmp_state_bits;
     }
 
+#if PINS_STATISTICS
+    PINS_STATS_START(&stats_t);
+#endif
 #if PINS_SPI || PINS_I2C
-    if (pin->bus_device) {
-        x = pin->bus_device->get_func(pin->bus_device, pin->addr, state_bits);
+    if (PIN_BUS_DEVICE(pin)) {
+        x = PIN_BUS_DEVICE(pin)->get_func(PIN_BUS_DEVICE(pin), pin->addr, state_bits);
     }
     else {
         x = pin_ll_get(pin, state_bits);
     }
 #else
     x = pin_ll_get(pin, state_bits);
+#endif
+#if PINS_STATISTICS
+    pin_stats_read(pin, &stats_t);
 #endif
     if (*state_bits & OSAL_STATE_NO_READ_SUPPORT) {
-        *state_bits = ((PinRV*)pin->prm)->state_bits;
-        return ((PinRV*)pin->prm)->value;
+        *state_bits = PIN_RV(pin)->state_bits;
+        return PIN_RV(pin)->value;
+    }
+
+#if PINS_INPUT_FILTERS
+    if (PIN_FILTER(pin)) {
+        x = pin_filter(pin, x);
     }
+#endif
 
-    if (x != ((PinRV*)pin->prm)->value ||
-        *state_bits != ((PinRV*)pin->prm)->state_bits)
+    if (x != PIN_RV(pin)->value ||
+        *state_bits != PIN_RV(pin)->state_bits)
     {
-        ((PinRV*)pin->prm)->value = x;
-        ((PinRV*)pin->prm)->state_bits = *state_bits;
+        PIN_RV(pin)->value = x;
+        PIN_RV(pin)->state_bits = *state_bits;
+#if PINS_STATISTICS
+        pin_stats_change(pin);
+#endif
+#if PINS_TRACE
+        pin_trace_record(pin, x, *state_bits, PINS_TRACE_READ);
+#endif
+#if PINS_HISTORY
+        pin_history_record(pin, x, *state_bits);
+#endif
 
 //        if (flags & PIN_FORWARD_TO_IOCOM)  should this be here like in set()?s
 //        {
-            if (pin_to_iocom_func &&
-                pin->signal)
-            {
-                pin_to_iocom_func(pin);
-            }
+            pin_forward_to_iocom(pin);
         // }
     }
     return x;
 }
 
 
+/**
+****************************************************************************************************
+
+  @brief Store input value as if read from hardware.
+  @anchor pin_store_input
+
+  The pin_store_input() function stores input value: If value or state bits differ from
+  current ones, they are stored, the change is forwarded to IOCOM and simulated interrupt is
+  triggered. Input filters are not applied here. pins_read_all() stores values read from
+  hardware by this function after filtering, trace replay uses it to inject recorded values.
+
+  @param   pin Pointer to pin configuration structure.
+  @param   x Pin value.
+  @param   state_bits Pin state bits.
+  @return  OS_TRUE if pin value or state bits changed.
+
+****************************************************************************************************
+*/
+os_boolean pin_store_input(
+    const Pin *pin,
+    os_int x,
+    os_char state_bits)
+{
+    if (x == PIN_RV(pin)->value &&
+        state_bits == PIN_RV(pin)->state_bits)
+    {
+        return OS_FALSE;
+    }
+
+    PIN_RV(pin)->value = x;
+    PIN_RV(pin)->state_bits = state_bits;
+#if PINS_STATISTICS
+    pin_stats_change(pin);
+#endif
+#if PINS_TRACE
+    pin_trace_record(pin, x, state_bits, PINS_TRACE_READ);
+#endif
+#if PINS_HISTORY
+    pin_history_record(pin, x, state_bits);
+#endif
+
+    pin_forward_to_iocom(pin);
+
+#if PINS_SIMULATED_INTERRUPTS
+    if (PIN_INT_CONF(pin)) {
+        pin_gpio_simulate_interrupt(pin, x);
+    }
+#endif
+    return OS_TRUE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Filter and store input value read from hardware.
+  @anchor pin_filter_and_store
+
+  The pin_filter_and_store() function applies input filter, if any, to value read by
+  pins_read_all() or pins_read_plan() and stores it by pin_store_input().
+
+  @param   pin Pointer to pin configuration structure.
+  @param   x Value read from hardware.
+  @param   state_bits State bits from hardware.
+  @return  OS_TRUE if pin value or state bits changed.
+
+****************************************************************************************************
+*/
+static inline os_boolean pin_filter_and_store(
+    const Pin *pin,
+    os_int x,
+    os_char state_bits)
+{
+#if PINS_INPUT_FILTERS
+    if (PIN_FILTER(pin) && (state_bits & OSAL_STATE_NO_READ_SUPPORT) == 0) {
+        x = pin_filter(pin, x);
+    }
+#endif
+    return pin_store_input(pin, x, state_bits);
+}
+
+
 /**
 ****************************************************************************************************
 
@@ -347,10 +600,10 @@ os_int pin_value(
     os_char *state_bits)
 {
     if (state_bits) {
-        *state_bits = ((PinRV*)pin->prm)->state_bits;
+        *state_bits = PIN_RV(pin)->state_bits;
     }
 
-    return ((PinRV*)pin->prm)->value;
+    return PIN_RV(pin)->value;
 }
 
 
@@ -363,7 +616,8 @@ os_int pin_value(
   The pin_value_scaled() function is like pin_value, but does scale the value
   "min", "max", "dmin", "dmax" and "digs",
 
-  If the pin has scaling set by "min" - "dmin", "dmax", "digs", value is scaled,
+  If the pin has scaling set by "min" - "dmin", "dmax", "digs", value is scaled. Gain and
+  offset are precomputed by pins_setup(), so this is one multiplication and addition.
 
   @param   pin Pointer to pin configuration structure.
   @return  Pin value from IO hardware. -1 if value is not available (not read, errornous, etc.).
@@ -374,41 +628,21 @@ os_double pin_value_scaled(
     const Pin *pin,
     os_char *state_bits)
 {
-    os_double gain, dvalue;
-    os_int ivalue, minx, maxx, miny, maxy, digs, dx, dy;
+    const PinScaling *scaling;
+    PinScaling tmp;
+    os_int ivalue;
 
     ivalue = pin_value(pin, state_bits);
     if ((pin->flags & PIN_SCALING_SET) == 0) {
         return ivalue;
     }
 
-    minx = pin_get_prm(pin, PIN_MIN);
-    maxx = pin_get_prm(pin, PIN_MAX);
-    miny = pin_get_prm(pin, PIN_SMIN);
-    maxy = pin_get_prm(pin, PIN_SMAX);
-    digs = pin_get_prm(pin, PIN_DIGS);
-
-    dx = maxx - minx;
-    dy = maxy - miny;
-    if (dx == 0 || dy == 0) {
-        osal_debug_error_int("Pin scaling error, pin addr=", pin->addr);
+    scaling = pin_get_scaling(pin, &tmp);
+    if (!scaling->valid) {
         return ivalue;
     }
-    gain = (os_double)dy / (os_double)dx;
 
-    dvalue = gain * (ivalue - minx) + miny;
-
-    while (digs > 0) {
-        dvalue *= 0.1;
-        digs--;
-    }
-
-    while (digs < 0) {
-        dvalue *= 10.0;
-        digs++;
-    }
-
-    return dvalue;
+    return scaling->gain * ivalue + scaling->offset;
 }
 
 
@@ -421,6 +655,16 @@ os_double pin_value_scaled(
   The pins_read_all() can be called at beginning of loop() function to read all hardware IO
   pins to memory and forward these as IO com signals as appropriate.
 
+  If the backend supports bank IO (PINS_BANK_IO), each GPIO bank is read only once per call
+  and digital input values are picked from the bank snapshot.
+
+  Groups with "scan-ms" attribute are skipped until the scan period has elapsed since the
+  group was last read (PINS_SCAN_SCHEDULER).
+
+  If pins_to_c.py has generated a scan plan for the configuration (PINS_SCAN_PLAN), inputs
+  are read by pins_read_plan() class by class. The generic loop is used for hand written
+  configurations, for groups with "scan-ms" and with PINS_RESET_IOCOM flag.
+
   The function is also used to set up initial state when connecting PINS library to IOCOM library.
 
   @param   hdr Pointer to IO hardware configuration structure.
@@ -439,9 +683,37 @@ void pins_read_all(
     os_int x;
     os_short n_groups, n_pins, i, j;
     os_char type, state_bits;
+#if PINS_BANK_IO
+    PinsBankSnapshot snapshot;
+    snapshot.read_mask = 0;
+#endif
+#if PINS_SCAN_SCHEDULER
+    os_timer now;
+    os_boolean now_set = OS_FALSE;
+#endif
+#if PINS_SCAN_PLAN
+    os_boolean planned = OS_FALSE;
+#endif
+#if PINS_STATISTICS
+    PinsStatsTime stats_t, read_all_t;
+    PINS_STATS_START(&read_all_t);
+#endif
 
+    PINS_PROFILE_BEGIN(PINS_PROF_READ_ALL);
+    pins_begin_iocom_batch();
     n_groups = hdr->n_groups;
 
+#if PINS_SCAN_PLAN
+    /* If configuration has scan plan, use it. The generic loop below then reads only
+       groups with "scan-ms", which are not in the plan.
+     */
+    if (hdr->scan_plan && (flags & PINS_RESET_IOCOM) == 0)
+    {
+        pins_read_plan(hdr->scan_plan);
+        planned = OS_TRUE;
+    }
+#endif
+
     for (i = 0; i<n_groups; i++)
     {
         group = hdr->group[i];
@@ -458,6 +730,28 @@ void pins_read_all(
             continue;
         }
 
+#if PINS_SCAN_PLAN
+        if (planned && group->scan == OS_NULL) {
+            continue;
+        }
+#endif
+
+#if PINS_SCAN_SCHEDULER
+        /* Skip the group if it is not yet time to scan it.
+         */
+        if (group->scan && (flags & PINS_RESET_IOCOM) == 0)
+        {
+            if (!now_set) {
+                os_get_timer(&now);
+                now_set = OS_TRUE;
+            }
+            if (!os_has_elapsed_since(&group->scan->last_scan, &now, group->scan->period_ms)) {
+                continue;
+            }
+            group->scan->last_scan = now;
+        }
+#endif
+
         n_pins = group->n_pins;
 
         for (j = 0; j < n_pins; j++, pin++)
@@ -465,40 +759,34 @@ void pins_read_all(
             if (type == PIN_INPUT ||
                 type == PIN_ANALOG_INPUT)
             {
+#if PINS_STATISTICS
+                PINS_STATS_START(&stats_t);
+#endif
 #if PINS_SPI || PINS_I2C
-                if (pin->bus_device) {
-                    x = pin->bus_device->get_func(pin->bus_device, pin->addr, &state_bits);
+                if (PIN_BUS_DEVICE(pin)) {
+                    x = PIN_BUS_DEVICE(pin)->get_func(PIN_BUS_DEVICE(pin), pin->addr, &state_bits);
+                }
+                else
+#endif
+#if PINS_BANK_IO
+                if (type == PIN_INPUT && pin->addr >= 0) {
+                    x = pin_get_from_bank(pin, &snapshot, &state_bits);
                 }
-                else {
+                else
+#endif
+                {
                     x = pin_ll_get(pin, &state_bits);
                 }
-#else
-                x = pin_ll_get(pin, &state_bits);
+#if PINS_STATISTICS
+                pin_stats_read(pin, &stats_t);
 #endif
 
-                if (x != ((PinRV*)pin->prm)->value ||
-                    state_bits != ((PinRV*)pin->prm)->state_bits ||
+                /* When setting up initial state for IOCOM, forward also unchanged values.
+                 */
+                if (!pin_filter_and_store(pin, x, state_bits) &&
                     (flags & PINS_RESET_IOCOM))
                 {
-                    ((PinRV*)pin->prm)->value = x;
-                    ((PinRV*)pin->prm)->state_bits = state_bits;
-
-                    /* If this is PINS library is connected to IOCOM library
-                       and this pin is mapped to IOCOM signal, then forward
-                       the change to IOCOM.
-                     */
-                    if (pin_to_iocom_func &&
-                        pin->signal)
-                    {
-                        pin_to_iocom_func(pin);
-                    }
-
-#if PINS_SIMULATED_INTERRUPTS
-                    if (pin->int_conf)
-                    {
-                        pin_gpio_simulate_interrupt(pin, x);
-                    }
-#endif
+                    pin_forward_to_iocom(pin);
                 }
             }
             else
@@ -509,15 +797,133 @@ void pins_read_all(
                     pin_timer_simulate_interrupt(pin);
                 }
 #endif
-                if (pin_to_iocom_func &&
-                    pin->signal)
-                {
-                    pin_to_iocom_func(pin);
-                }
+                pin_forward_to_iocom(pin);
             }
         }
     }
+
+    pins_end_iocom_batch();
+#if PINS_STATISTICS
+    pins_stats_read_all(&read_all_t);
+#endif
+    PINS_PROFILE_END(PINS_PROF_READ_ALL);
+}
+
+
+#if PINS_SCAN_PLAN
+/**
+****************************************************************************************************
+
+  @brief Read all inputs using scan plan.
+  @anchor pins_read_plan
+
+  The pins_read_plan() function is called by pins_read_all() when pins_to_c.py has generated
+  scan plan for the configuration. Each class of inputs is read in it's own loop, so pin
+  type, bus device and interrupt configuration don't need to be checked for each pin.
+
+  @param   plan Scan plan generated for the IO device.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_read_plan(
+    const PinsScanPlan *plan)
+{
+    const Pin *pin;
+    os_int x;
+    os_short i, n;
+    os_char state_bits;
+#if PINS_BANK_IO
+    PinsBankSnapshot snapshot;
+    snapshot.read_mask = 0;
+#endif
+#if PINS_STATISTICS
+    PinsStatsTime stats_t;
+#endif
+
+    /* Digital inputs, read trough GPIO bank snapshot if supported.
+     */
+    n = plan->n_gpio_in;
+    for (i = 0; i < n; i++)
+    {
+        pin = plan->gpio_in[i];
+#if PINS_STATISTICS
+        PINS_STATS_START(&stats_t);
+#endif
+#if PINS_BANK_IO
+        x = pin_get_from_bank(pin, &snapshot, &state_bits);
+#else
+        x = pin_ll_get(pin, &state_bits);
+#endif
+#if PINS_STATISTICS
+        pin_stats_read(pin, &stats_t);
+#endif
+        pin_filter_and_store(pin, x, state_bits);
+    }
+
+    /* Other directly read inputs.
+     */
+    n = plan->n_direct_in;
+    for (i = 0; i < n; i++)
+    {
+        pin = plan->direct_in[i];
+#if PINS_STATISTICS
+        PINS_STATS_START(&stats_t);
+#endif
+        x = pin_ll_get(pin, &state_bits);
+#if PINS_STATISTICS
+        pin_stats_read(pin, &stats_t);
+#endif
+        pin_filter_and_store(pin, x, state_bits);
+    }
+
+#if PINS_SPI || PINS_I2C
+    /* Inputs from SPI and I2C devices.
+     */
+    n = plan->n_bus_in;
+    for (i = 0; i < n; i++)
+    {
+        pin = plan->bus_in[i];
+#if PINS_STATISTICS
+        PINS_STATS_START(&stats_t);
+#endif
+        x = PIN_BUS_DEVICE(pin)->get_func(PIN_BUS_DEVICE(pin), pin->addr, &state_bits);
+#if PINS_STATISTICS
+        pin_stats_read(pin, &stats_t);
+#endif
+        pin_filter_and_store(pin, x, state_bits);
+    }
+#endif
+
+    /* Inputs with interrupt configuration.
+     */
+    n = plan->n_int_in;
+    for (i = 0; i < n; i++)
+    {
+        pin = plan->int_in[i];
+#if PINS_STATISTICS
+        PINS_STATS_START(&stats_t);
+#endif
+        x = pin_ll_get(pin, &state_bits);
+#if PINS_STATISTICS
+        pin_stats_read(pin, &stats_t);
+#endif
+        pin_filter_and_store(pin, x, state_bits);
+    }
+
+#if PINS_SIMULATED_INTERRUPTS
+    /* Timers.
+     */
+    n = plan->n_timer;
+    for (i = 0; i < n; i++)
+    {
+        pin = plan->timer[i];
+        pin_timer_simulate_interrupt(pin);
+        pin_forward_to_iocom(pin);
+    }
+#endif
 }
+#endif
 
 
 /**
@@ -539,8 +945,343 @@ void pins_read_group(
 {
     os_char state_bits;
 
+    pins_begin_iocom_batch();
     while (pin) {
         pin_get_ext(pin, &state_bits);
-        pin = pin->next;
+        pin = PIN_NEXT(pin);
+    }
+    pins_end_iocom_batch();
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Start collecting pin changes to IOCOM.
+  @anchor pins_begin_iocom_batch
+
+  The pins_begin_iocom_batch() function starts a batch: Until matching pins_end_iocom_batch()
+  changed pins are only recorded in journal, instead of writing each change as IOCOM signal
+  separately. pins_read_all() and pins_read_group() do this internally, application can use
+  these to batch it's own pin_set() calls. Batches can be nested.
+
+  Batch depth is per thread. The thread which starts outermost batch takes the journal, if
+  no other thread has it. Pins changed by other threads are forwarded directly, also if
+  some other thread is within a batch.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_begin_iocom_batch(void)
+{
+    if (pins_batch_depth++) return;
+
+    os_lock();
+    pins_batch_owner = (os_boolean)!pins_journal_busy;
+    if (pins_batch_owner) pins_journal_busy = OS_TRUE;
+    os_unlock();
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief End batch and forward collected pin changes to IOCOM.
+  @anchor pins_end_iocom_batch
+
+  The pins_end_iocom_batch() function ends the batch started by pins_begin_iocom_batch().
+  When outermost batch ends, the journaled changes are flushed to IOCOM.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_end_iocom_batch(void)
+{
+    if (pins_batch_depth <= 0) return;
+    if (--pins_batch_depth) return;
+    if (!pins_batch_owner) return;
+
+    pins_flush_iocom();
+
+    pins_batch_owner = OS_FALSE;
+    os_lock();
+    pins_journal_busy = OS_FALSE;
+    os_unlock();
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Forward journaled pin changes to IOCOM.
+  @anchor pins_flush_iocom
+
+  The pins_flush_iocom() function writes all pins in change journal as IOCOM signals and
+  empties the journal. If IOCOM extension has set pins_flush_iocom_func, the whole journal
+  is passed to it, so it can lock each memory block once and write consecutive signals
+  together. Otherwise pins are forwarded one by one.
+
+  Does nothing unless called by the thread which owns the journal. The journal is copied
+  and emptied first, so that pins changed by IOCOM callbacks during the flush get journaled
+  again.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_flush_iocom(void)
+{
+    const Pin *pins[PINS_IOCOM_JOURNAL_SZ];
+    os_int i, n;
+
+    if (!pins_batch_owner) return;
+    n = pins_journal_n;
+    if (n == 0) return;
+    os_memcpy((void*)pins, (const void*)pins_journal, n * sizeof(const Pin*));
+    pins_journal_n = 0;
+
+    for (i = 0; i < n; i++) {
+        PIN_RV(pins[i])->flags &= ~PIN_RV_QUEUED;
+    }
+
+    if (pins_flush_iocom_func) {
+        pins_flush_iocom_func(pins, n);
+    }
+    else if (pin_to_iocom_func) {
+        for (i = 0; i < n; i++) {
+            pin_to_iocom_func(pins[i]);
+        }
+    }
+}
+
+
+#if PINS_BANK_IO
+/**
+****************************************************************************************************
+
+  @brief Get digital input value from GPIO bank snapshot.
+  @anchor pin_get_from_bank
+
+  The pin_get_from_bank() function reads the GPIO bank containing the pin, if it has not yet
+  been read during this pins_read_all() call, and returns the pin's bit from the snapshot.
+  Touch sensors, pins beyond PINS_MAX_GPIO_BANKS and pins with simulated input source are
+  read one by one.
+
+  @param   pin Pointer to pin configuration structure, digital input.
+  @param   snapshot Bank snapshots for this pins_read_all() call.
+  @param   state_bits Pointer to byte where to store state bits.
+  @return  Pin value 0 or 1.
+
+****************************************************************************************************
+*/
+static os_int pin_get_from_bank(
+    const Pin *pin,
+    PinsBankSnapshot *snapshot,
+    os_char *state_bits)
+{
+    os_short bank;
+
+    bank = PINS_GPIO_BANK(pin->addr);
+    if (bank >= PINS_MAX_GPIO_BANKS || pin_get_prm(pin, PIN_TOUCH)) {
+        return pin_ll_get(pin, state_bits);
+    }
+#ifdef PINS_SIMULATE_HW
+    if (pin_get_prm(pin, PIN_SIM)) {
+        return pin_ll_get(pin, state_bits);
+    }
+#endif
+
+    if ((snapshot->read_mask & (1 << bank)) == 0) {
+        snapshot->bits[bank] = pin_ll_get_bank(bank, &snapshot->state_bits[bank]);
+        snapshot->read_mask |= 1 << bank;
+    }
+
+    *state_bits = snapshot->state_bits[bank];
+    if (*state_bits & OSAL_STATE_NO_READ_SUPPORT) {
+        return pin_ll_get(pin, state_bits);
+    }
+
+    return (os_int)((snapshot->bits[bank] >> PINS_GPIO_BANK_BIT(pin->addr)) & 1);
+}
+#endif
+
+
+/**
+****************************************************************************************************
+
+  @brief Store value written to pin and forward it to IOCOM.
+  @anchor pin_store_value
+
+  The pin_store_value() function is called after value has been written to hardware. It stores
+  the value for the Pin structure and, if appropriate, writes it as IOCOM signal.
+
+  When trace is recorded, changed value is traced if the write is forwarded to IOCOM. Other
+  writes are always traced, since the stored value is not updated for them.
+  Value history gets every write, pin_history_record() skips values which did not change.
+
+  @param   pin Pointer to pin configuration structure.
+  @param   x Value which was written.
+  @param   flags PIN_FORWARD_TO_IOCOM to forward change to IOCOM.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pin_store_value(
+    const Pin *pin,
+    os_int x,
+    os_short flags)
+{
+    if (flags & PIN_FORWARD_TO_IOCOM)
+    {
+        if (x != PIN_RV(pin)->value || PIN_RV(pin)->state_bits != OSAL_STATE_CONNECTED)
+        {
+            PIN_RV(pin)->value = x;
+            PIN_RV(pin)->state_bits = OSAL_STATE_CONNECTED;
+#if PINS_TRACE
+            pin_trace_record(pin, x, OSAL_STATE_CONNECTED, PINS_TRACE_WRITE);
+#endif
+
+            pin_forward_to_iocom(pin);
+        }
+    }
+#if PINS_TRACE
+    else {
+        pin_trace_record(pin, x, OSAL_STATE_CONNECTED, PINS_TRACE_WRITE);
+    }
+#endif
+#if PINS_HISTORY
+    pin_history_record(pin, x, OSAL_STATE_CONNECTED);
+#endif
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Write pin value to hardware.
+  @anchor pin_write_hw
+
+  The pin_write_hw() function writes value to bus device or to GPIO pin. If bank_write is
+  given and the pin is digital output in GPIO bank, the write is only collected into
+  bank_write and committed later by pins_write_banks().
+
+  @param   pin Pointer to pin configuration structure.
+  @param   x Value to write.
+  @param   bank_write Pointer to PinsBankWrite to collect GPIO output bits, OS_NULL to write
+           immediately.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pin_write_hw(
+    const Pin *pin,
+    os_int x,
+    void *bank_write)
+{
+#if PINS_BANK_IO
+    PinsBankWrite *w;
+    os_short bank;
+    os_uint bit;
+#endif
+
+#if PINS_SPI || PINS_I2C
+    if (PIN_BUS_DEVICE(pin)) {
+        PIN_BUS_DEVICE(pin)->set_func(PIN_BUS_DEVICE(pin), pin->addr, x);
+        return;
+    }
+#endif
+
+#if PINS_BANK_IO
+    if (bank_write && pin->type == PIN_OUTPUT && pin->addr >= 0)
+    {
+        bank = PINS_GPIO_BANK(pin->addr);
+        if (bank < PINS_MAX_GPIO_BANKS)
+        {
+            w = (PinsBankWrite*)bank_write;
+            bit = 1u << PINS_GPIO_BANK_BIT(pin->addr);
+            w->mask[bank] |= bit;
+            if (x) w->bits[bank] |= bit;
+            else w->bits[bank] &= ~bit;
+            return;
+        }
+    }
+#else
+    OSAL_UNUSED(bank_write);
+#endif
+
+    pin_ll_set(pin, x);
+}
+
+
+#if PINS_BANK_IO
+/**
+****************************************************************************************************
+
+  @brief Commit collected GPIO output bank writes.
+  @anchor pins_write_banks
+
+  The pins_write_banks() function calls pin_ll_set_bank() once for each GPIO bank which has
+  pins to write.
+
+  @param   w Pointer to collected bank writes.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_write_banks(
+    PinsBankWrite *w)
+{
+    os_short bank;
+
+    for (bank = 0; bank < PINS_MAX_GPIO_BANKS; bank++) {
+        if (w->mask[bank]) {
+            pin_ll_set_bank(bank, w->mask[bank], w->bits[bank]);
+        }
+    }
+}
+#endif
+
+
+/**
+****************************************************************************************************
+
+  @brief Forward pin value change to IOCOM.
+  @anchor pin_forward_to_iocom
+
+  The pin_forward_to_iocom() function writes pin value as IOCOM signal, if PINS library is
+  connected to IOCOM and the pin is mapped to a signal. Within a batch of the thread owning
+  the journal the pin is only added to change journal, without locking. If the journal is
+  full, it is flushed and the pin is written directly.
+
+  @param   pin Pointer to pin configuration structure.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pin_forward_to_iocom(
+    const Pin *pin)
+{
+    PinRV *rv;
+
+    if (pin_to_iocom_func == OS_NULL ||
+        PIN_SIGNAL(pin) == OS_NULL)
+    {
+        return;
+    }
+
+    if (pins_batch_owner)
+    {
+        rv = PIN_RV(pin);
+        if (rv->flags & PIN_RV_QUEUED) return;
+
+        if (pins_journal_n < PINS_IOCOM_JOURNAL_SZ) {
+            rv->flags |= PIN_RV_QUEUED;
+            pins_journal[pins_journal_n++] = pin;
+            return;
+        }
+        pins_flush_iocom();
     }
+    pin_to_iocom_func(pin);
 }
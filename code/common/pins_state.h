@@ -22,6 +22,7 @@
  */
 #define PINS_DEFAULT 0
 #define PINS_RESET_IOCOM 1
+#define PINS_DEFER_DEVICE_INIT 2
 
 /* Function type to forward changes to iocom
  */
@@ -32,6 +33,17 @@ typedef void pin_to_iocom_t(
  */
 extern pin_to_iocom_t *pin_to_iocom_func;
 
+/* Function type to forward a batch of changed pins to iocom. The function may reorder
+   the pins array.
+ */
+typedef void pins_flush_iocom_t(
+    const Pin **pins,
+    os_int n_pins);
+
+/* Function pointer to forward batch of changes to iocom. OS_NULL if not connected to IOCOM.
+ */
+extern pins_flush_iocom_t *pins_flush_iocom_func;
+
 /* Setup IO hardware for a device.
  */
 osalStatus pins_setup(
@@ -63,6 +75,21 @@ void pin_set_ext(
     os_int x,
     os_short flags);
 
+/* Set states of a group of IO pins, linked by Pin.next.
+ */
+void pins_set_group(
+    const Pin *pin,
+    const os_int *x,
+    os_short flags);
+
+/* Set states of IO pins given as array of pin pointers.
+ */
+void pins_set_array(
+    const Pin * const *pins,
+    const os_int *x,
+    os_int n_pins,
+    os_short flags);
+
 /* Set IO pin state with scaling.
  */
 void pin_set_scaled(
@@ -98,6 +125,13 @@ os_double pin_value_scaled(
     const Pin *pin,
     os_char *state_bits);
 
+/* Store input value as if read from hardware, used to inject values.
+ */
+os_boolean pin_store_input(
+    const Pin *pin,
+    os_int x,
+    os_char state_bits);
+
 /* Read all inputs of the IO device into global Pin structurees
  */
 void pins_read_all(
@@ -109,4 +143,16 @@ void pins_read_all(
 void pins_read_group(
     const Pin *pin);
 
+/* Start collecting pin changes to IOCOM, changes are written at end of batch.
+ */
+void pins_begin_iocom_batch(void);
+
+/* End batch and forward collected pin changes to IOCOM.
+ */
+void pins_end_iocom_batch(void);
+
+/* Forward pin changes collected so far to IOCOM.
+ */
+void pins_flush_iocom(void);
+
 #endif
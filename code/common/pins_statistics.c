@@ -0,0 +1,333 @@
+/**
+
+  @file    common/pins_statistics.c
+  @brief   Pin IO statistics and latency histograms.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pins.h"
+#if PINS_STATISTICS
+
+/* IO device whose pins are tracked, set by pins_setup().
+ */
+static const IoPinsHdr *pins_stats_hdr;
+
+/* Latency of pins_read_all() calls.
+ */
+static PinsLatencyHist pins_read_all_latency;
+
+/* Forward referred static functions.
+ */
+static PinStats *pin_stats(
+    const Pin *pin);
+
+static void pins_add_latency(
+    PinsLatencyHist *hist,
+    PinsStatsTime *start_t);
+
+
+/**
+****************************************************************************************************
+
+  @brief Set IO device whose pins are tracked.
+  @anchor pins_setup_stats
+
+  The pins_setup_stats() function is called by pins_setup(). It clears the statistics.
+
+  @param   pins_hdr Top level pins IO configuration structure.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_setup_stats(
+    const IoPinsHdr *pins_hdr)
+{
+    pins_stats_hdr = pins_hdr;
+    pins_reset_stats();
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Record hardware read of a pin.
+  @anchor pin_stats_read
+
+  The pin_stats_read() function is called by pin_get_ext() and pins_read_all() right after
+  reading pin value from hardware, before filtering.
+
+  @param   pin Pointer to pin configuration structure.
+  @param   start_t Time taken by PINS_STATS_START() before the read.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pin_stats_read(
+    const Pin *pin,
+    PinsStatsTime *start_t)
+{
+    PinStats *s;
+
+    s = pin_stats(pin);
+    if (s == OS_NULL) return;
+
+    s->n_reads++;
+    pins_add_latency(&s->read_latency, start_t);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Count change of pin value or state bits.
+  @anchor pin_stats_change
+
+  The pin_stats_change() function is called when value read from hardware, after filtering,
+  differs from the current pin value or state bits.
+
+  @param   pin Pointer to pin configuration structure.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pin_stats_change(
+    const Pin *pin)
+{
+    PinStats *s;
+
+    s = pin_stats(pin);
+    if (s) s->n_changes++;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Record hardware write of a pin.
+  @anchor pin_stats_write
+
+  The pin_stats_write() function is called by pin_set_ext() after writing the pin value.
+
+  @param   pin Pointer to pin configuration structure.
+  @param   start_t Time taken by PINS_STATS_START() before the write.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pin_stats_write(
+    const Pin *pin,
+    PinsStatsTime *start_t)
+{
+    PinStats *s;
+
+    s = pin_stats(pin);
+    if (s == OS_NULL) return;
+
+    s->n_writes++;
+    pins_add_latency(&s->write_latency, start_t);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Record duration of pins_read_all() call.
+  @anchor pins_stats_read_all
+
+  @param   start_t Time taken by PINS_STATS_START() when pins_read_all() was called.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_stats_read_all(
+    PinsStatsTime *start_t)
+{
+    pins_add_latency(&pins_read_all_latency, start_t);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Take a snapshot of pin's statistics.
+  @anchor pins_get_pin_stats
+
+  The pins_get_pin_stats() function copies pin's counters and histograms.
+
+  @param   pin Pointer to pin configuration structure.
+  @param   stats Where to store the snapshot.
+  @return  OSAL_SUCCESS if all good. OSAL_STATUS_FAILED if the pin has no statistics
+           table entry, stats is cleared.
+
+****************************************************************************************************
+*/
+osalStatus pins_get_pin_stats(
+    const Pin *pin,
+    PinStats *stats)
+{
+    PinStats *s;
+
+    s = pin_stats(pin);
+    if (s == OS_NULL) {
+        os_memclear(stats, sizeof(PinStats));
+        return OSAL_STATUS_FAILED;
+    }
+
+    os_memcpy(stats, s, sizeof(PinStats));
+    return OSAL_SUCCESS;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Take a snapshot of pins_read_all() latency histogram.
+  @anchor pins_get_read_all_stats
+
+  @param   hist Where to store the snapshot.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_get_read_all_stats(
+    PinsLatencyHist *hist)
+{
+    os_memcpy(hist, &pins_read_all_latency, sizeof(PinsLatencyHist));
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Clear all statistics.
+  @anchor pins_reset_stats
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_reset_stats(void)
+{
+    const IoPinsHdr *hdr;
+
+    hdr = pins_stats_hdr;
+    if (hdr && hdr->stats) {
+        os_memclear(hdr->stats, hdr->n_rv * sizeof(PinStats));
+    }
+    os_memclear(&pins_read_all_latency, sizeof(PinsLatencyHist));
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get latency percentile from histogram.
+  @anchor pins_latency_percentile
+
+  The pins_latency_percentile() function finds the bucket containing given percentile and
+  returns upper bound of the bucket, but not more than maximum latency seen.
+
+  @param   hist Pointer to latency histogram.
+  @param   per_mille Percentile * 10, for example 500 for median or 990 for 99th percentile.
+  @return  Latency in ticks, 0 if histogram is empty.
+
+****************************************************************************************************
+*/
+os_uint pins_latency_percentile(
+    const PinsLatencyHist *hist,
+    os_int per_mille)
+{
+    os_uint limit, sum, ticks;
+    os_int k;
+
+    if (hist->count == 0) return 0;
+
+    limit = (os_uint)(((os_int64)hist->count * per_mille + 999) / 1000);
+    if (limit == 0) limit = 1;
+
+    sum = 0;
+    for (k = 0; k < PINS_STATS_HIST_SZ - 1; k++)
+    {
+        sum += hist->bucket[k];
+        if (sum >= limit) break;
+    }
+
+    ticks = k ? ((os_uint)1 << k) - 1 : 0;
+    if (k == PINS_STATS_HIST_SZ - 1 || ticks > hist->max_ticks) {
+        ticks = hist->max_ticks;
+    }
+    return ticks;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get statistics table entry for a pin.
+  @anchor pin_stats
+
+  The pin's index in statistics table is the pin's index in runtime value array.
+
+  @param   pin Pointer to pin configuration structure.
+  @return  Pointer to statistics, OS_NULL if none.
+
+****************************************************************************************************
+*/
+static PinStats *pin_stats(
+    const Pin *pin)
+{
+    const IoPinsHdr *hdr;
+    os_int ix;
+
+    hdr = pins_stats_hdr;
+    if (hdr == OS_NULL || hdr->stats == OS_NULL) return OS_NULL;
+
+    ix = (os_int)(PIN_RV(pin) - hdr->rv);
+    if (ix < 0 || ix >= hdr->n_rv) return OS_NULL;
+    return hdr->stats + ix;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Add latency since start time to histogram.
+  @anchor pins_add_latency
+
+  @param   hist Pointer to latency histogram.
+  @param   start_t Start time.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_add_latency(
+    PinsLatencyHist *hist,
+    PinsStatsTime *start_t)
+{
+    PinsStatsTime now;
+    os_int64 d;
+    os_uint ticks;
+    os_int k;
+
+    PINS_STATS_START(&now);
+    d = now - *start_t;
+    if (d < 0) d = 0;
+    ticks = d > 0x7FFFFFFF ? 0x7FFFFFFF : (os_uint)d;
+
+    for (k = 0; ticks >> k; k++);
+    if (k >= PINS_STATS_HIST_SZ) k = PINS_STATS_HIST_SZ - 1;
+
+    hist->bucket[k]++;
+    hist->count++;
+    if (ticks > hist->max_ticks) hist->max_ticks = ticks;
+}
+
+#endif
@@ -0,0 +1,139 @@
+/**
+
+  @file    common/pins_statistics.h
+  @brief   Pin IO statistics and latency histograms.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Optional instrumentation of pin_get_ext(), pin_set_ext() and pins_read_all(), enabled by
+  defining PINS_STATISTICS=1 for the build. Per pin read, write and change counters and log2
+  latency histograms are kept in a table generated by pins_to_c.py, one entry per pin in
+  the same order as the runtime value array. Latencies are in microseconds, from
+  pins_now_us(), unless PINS_STATS_START() is defined for the build to read a hardware
+  cycle counter.
+
+  The counters are updated without locks, so pins should be read and written from one
+  thread when statistics are used.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#pragma once
+#ifndef PINS_STATISTICS_H_
+#define PINS_STATISTICS_H_
+#include "pins.h"
+
+#if PINS_STATISTICS
+
+/** Number of log2 histogram buckets. Bucket 0 counts zero latencies, bucket k > 0
+    latencies from 2^(k-1) to 2^k - 1 ticks. Last bucket collects everything longer.
+ */
+#ifndef PINS_STATS_HIST_SZ
+#define PINS_STATS_HIST_SZ 16
+#endif
+
+/** Latency histogram.
+ */
+typedef struct PinsLatencyHist
+{
+    os_uint count;
+    os_uint max_ticks;
+    os_uint bucket[PINS_STATS_HIST_SZ];
+}
+PinsLatencyHist;
+
+/** Statistics for one pin.
+ */
+typedef struct PinStats
+{
+    /** Number of hardware reads and writes, and how many reads changed pin value
+        or state bits.
+     */
+    os_uint n_reads;
+    os_uint n_writes;
+    os_uint n_changes;
+
+    /** Duration of pin_ll_get() or bus device get_func, and of hardware write.
+     */
+    PinsLatencyHist read_latency;
+    PinsLatencyHist write_latency;
+}
+PinStats;
+
+#define PINS_STATS_TABLE(name, n) static PinStats name[n];
+#define PINS_STATS_PTR(name) ,name
+#define PINS_STATS_NULL ,OS_NULL
+
+/** Time stamp for latency measurement, see PINS_STATS_START().
+ */
+typedef os_int64 PinsStatsTime;
+
+/* Read time for latency measurement into PinsStatsTime, microseconds. Can be defined for
+   the build to read a faster hardware cycle counter, histogram buckets are then in counter
+   ticks.
+ */
+#ifndef PINS_STATS_START
+#define PINS_STATS_START(t) (*(t) = pins_now_us())
+#endif
+
+/* Set IO device whose pins are tracked, called by pins_setup().
+ */
+void pins_setup_stats(
+    const IoPinsHdr *pins_hdr);
+
+/* Record hardware read of a pin.
+ */
+void pin_stats_read(
+    const Pin *pin,
+    PinsStatsTime *start_t);
+
+/* Count change of pin value or state bits.
+ */
+void pin_stats_change(
+    const Pin *pin);
+
+/* Record hardware write of a pin.
+ */
+void pin_stats_write(
+    const Pin *pin,
+    PinsStatsTime *start_t);
+
+/* Record duration of pins_read_all() call.
+ */
+void pins_stats_read_all(
+    PinsStatsTime *start_t);
+
+/* Take a snapshot of pin's statistics.
+ */
+osalStatus pins_get_pin_stats(
+    const Pin *pin,
+    PinStats *stats);
+
+/* Take a snapshot of pins_read_all() latency histogram.
+ */
+void pins_get_read_all_stats(
+    PinsLatencyHist *hist);
+
+/* Clear all statistics.
+ */
+void pins_reset_stats(void);
+
+/* Get latency percentile from histogram, upper bound of the bucket.
+ */
+os_uint pins_latency_percentile(
+    const PinsLatencyHist *hist,
+    os_int per_mille);
+
+#else
+
+#define PINS_STATS_TABLE(name, n)
+#define PINS_STATS_PTR(name)
+#define PINS_STATS_NULL
+
+#endif
+#endif
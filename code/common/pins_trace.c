@@ -0,0 +1,375 @@
+/**
+
+  @file    common/pins_trace.c
+  @brief   Binary pin change trace recorder.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pins.h"
+#if PINS_TRACE
+
+/** Trace recorder state.
+ */
+typedef struct PinsTrace
+{
+    /** Pin configuration being traced, used to convert pin to index.
+     */
+    const IoPinsHdr *hdr;
+
+    /** Trace file, OS_NULL if not recording.
+     */
+    osalStream f;
+
+    /** Two record buffers. Records are added to buf[active], n is number of records in it.
+     */
+    PinsTraceRecord buf[2][PINS_TRACE_BUF_RECORDS];
+    os_int active;
+    os_int n;
+
+    /** Number of records in a full buffer waiting to be written to file, 0 if buffer
+        is free. Set by recorder and cleared by writer.
+     */
+    volatile os_int n_full[2];
+
+    /** Start time of the trace and time of last buffer swap, microseconds.
+     */
+    os_int64 start_us;
+    os_int64 swap_us;
+
+    /** Number of records dropped because both buffers were full.
+     */
+    os_uint dropped;
+
+    /** Recording running.
+     */
+    volatile os_boolean running;
+
+#if OSAL_MULTITHREAD_SUPPORT
+    /** File writer thread and event to wake it up.
+     */
+    osalThread *thread;
+    osalEvent event;
+    volatile os_boolean stop_thread;
+#endif
+}
+PinsTrace;
+
+static PinsTrace pins_trace;
+
+/* Forward referred static functions.
+ */
+static os_boolean pins_trace_swap(
+    os_int64 now_us);
+
+static void pins_trace_write_full(void);
+
+#if OSAL_MULTITHREAD_SUPPORT
+static void pins_trace_thread(
+    void *prm,
+    osalEvent done);
+#endif
+
+
+/**
+****************************************************************************************************
+
+  @brief Start recording pin changes into file.
+  @anchor pins_start_trace
+
+  The pins_start_trace() function creates the trace file, writes file header and starts the
+  file writer thread. From this on pin changes are recorded until pins_stop_trace() is called.
+
+  @param   hdr Top level pins IO configuration structure.
+  @param   path Path to trace file. Existing file is overwritten.
+  @return  OSAL_SUCCESS if recording was started, other values indicate an error.
+
+****************************************************************************************************
+*/
+osalStatus pins_start_trace(
+    const IoPinsHdr *hdr,
+    const os_char *path)
+{
+    PinsTrace *t;
+    os_uint h[PINS_TRACE_HDR_SZ / sizeof(os_uint)];
+    os_memsz n_written;
+    osalStatus s;
+#if OSAL_MULTITHREAD_SUPPORT
+    osalThreadOptPrms opt;
+#endif
+
+    pins_stop_trace();
+    t = &pins_trace;
+    os_memclear(t, sizeof(PinsTrace));
+
+    t->f = osal_file_open(path, OS_NULL, &s, OSAL_STREAM_WRITE);
+    if (t->f == OS_NULL) {
+        osal_debug_error_str("pins_start_trace: Cannot create ", path);
+        return s;
+    }
+
+    os_memcpy(h, PINS_TRACE_MAGIC, 4);
+    h[1] = PINS_TRACE_VERSION;
+    h[2] = sizeof(PinsTraceRecord);
+    h[3] = (os_uint)hdr->n_rv;
+    s = osal_file_write(t->f, (const os_char*)h, PINS_TRACE_HDR_SZ, &n_written, OSAL_STREAM_DEFAULT);
+    if (s) {
+        osal_file_close(t->f, OSAL_STREAM_DEFAULT);
+        t->f = OS_NULL;
+        return s;
+    }
+
+    t->hdr = hdr;
+    t->start_us = t->swap_us = pins_now_us();
+
+#if OSAL_MULTITHREAD_SUPPORT
+    t->event = osal_event_create();
+    os_memclear(&opt, sizeof(opt));
+    opt.thread_name = "pinstrace";
+    t->thread = osal_thread_create(pins_trace_thread, t, &opt, OSAL_THREAD_ATTACHED);
+#endif
+
+    PINS_MEMORY_BARRIER();
+    t->running = OS_TRUE;
+    return OSAL_SUCCESS;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Stop recording.
+  @anchor pins_stop_trace
+
+  The pins_stop_trace() function stops recording, stops the writer thread, appends records
+  still in buffers to file and closes it.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_stop_trace(void)
+{
+    PinsTrace *t;
+
+    t = &pins_trace;
+    if (t->f == OS_NULL) return;
+
+    t->running = OS_FALSE;
+    PINS_MEMORY_BARRIER();
+
+#if OSAL_MULTITHREAD_SUPPORT
+    if (t->thread)
+    {
+        t->stop_thread = OS_TRUE;
+        osal_event_set(t->event);
+        osal_thread_join(t->thread);
+        t->thread = OS_NULL;
+    }
+    if (t->event)
+    {
+        osal_event_delete(t->event);
+        t->event = OS_NULL;
+    }
+#endif
+
+    /* Write full buffer, if any, and then the active one.
+     */
+    pins_trace_write_full();
+    if (t->n) {
+        t->n_full[t->active] = t->n;
+        t->n = 0;
+        pins_trace_write_full();
+    }
+
+    osal_file_close(t->f, OSAL_STREAM_DEFAULT);
+    t->f = OS_NULL;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Record pin change.
+  @anchor pin_trace_record
+
+  The pin_trace_record() function is called by pins library when value read from hardware
+  changes, or a value is written to pin. It adds a record to active buffer. If the buffer is
+  full, or PINS_TRACE_FLUSH_MS has passed since last swap, buffers are swapped and writer
+  is woken up.
+
+  @param   pin Pointer to pin configuration structure.
+  @param   x Pin value.
+  @param   state_bits Pin state bits.
+  @param   type PINS_TRACE_READ or PINS_TRACE_WRITE.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pin_trace_record(
+    const Pin *pin,
+    os_int x,
+    os_char state_bits,
+    os_char type)
+{
+    PinsTrace *t;
+    PinsTraceRecord *r;
+    os_int64 now;
+    os_int ix;
+
+    t = &pins_trace;
+    if (!t->running || PIN_RV(pin) == OS_NULL) return;
+    ix = (os_int)(PIN_RV(pin) - t->hdr->rv);
+    if ((os_uint)ix >= (os_uint)t->hdr->n_rv) return;
+
+    now = pins_now_us();
+    if (t->n >= PINS_TRACE_BUF_RECORDS && !pins_trace_swap(now)) {
+        t->dropped++;
+        return;
+    }
+
+    r = t->buf[t->active] + t->n++;
+    r->t_us = now - t->start_us;
+    r->value = x;
+    r->pin_ix = (os_ushort)ix;
+    r->state_bits = state_bits;
+    r->type = type;
+
+    if (now - t->swap_us >= 1000 * (os_int64)PINS_TRACE_FLUSH_MS) {
+        pins_trace_swap(now);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get number of dropped records.
+  @anchor pins_trace_dropped
+
+  @return  Number of records dropped since pins_start_trace() because the file writer did
+           not keep up.
+
+****************************************************************************************************
+*/
+os_uint pins_trace_dropped(void)
+{
+    return pins_trace.dropped;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Swap buffers.
+  @anchor pins_trace_swap
+
+  The pins_trace_swap() function hands the active buffer to the writer and starts filling
+  the other one, if the writer has finished with it.
+
+  @param   now_us Current time, microseconds.
+  @return  OS_TRUE if buffers were swapped, OS_FALSE if the other buffer is still being written.
+
+****************************************************************************************************
+*/
+static os_boolean pins_trace_swap(
+    os_int64 now_us)
+{
+    PinsTrace *t;
+    os_int other;
+
+    t = &pins_trace;
+    other = 1 - t->active;
+    if (t->n_full[other]) return OS_FALSE;
+
+    PINS_MEMORY_BARRIER();
+    t->n_full[t->active] = t->n;
+    t->active = other;
+    t->n = 0;
+    t->swap_us = now_us;
+
+#if OSAL_MULTITHREAD_SUPPORT
+    osal_event_set(t->event);
+#else
+    pins_trace_write_full();
+#endif
+    return OS_TRUE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Append full buffers to trace file.
+  @anchor pins_trace_write_full
+
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_trace_write_full(void)
+{
+    PinsTrace *t;
+    os_memsz n_written;
+    os_int i, n;
+
+    t = &pins_trace;
+    for (i = 0; i < 2; i++)
+    {
+        n = t->n_full[i];
+        if (n == 0) continue;
+        PINS_MEMORY_BARRIER();
+
+        if (osal_file_write(t->f, (const os_char*)t->buf[i], n * sizeof(PinsTraceRecord),
+            &n_written, OSAL_STREAM_DEFAULT))
+        {
+            osal_debug_error("pins_trace: File write failed");
+        }
+
+        PINS_MEMORY_BARRIER();
+        t->n_full[i] = 0;
+    }
+}
+
+
+#if OSAL_MULTITHREAD_SUPPORT
+/**
+****************************************************************************************************
+
+  @brief Trace file writer thread.
+  @anchor pins_trace_thread
+
+  The pins_trace_thread() function waits for buffer swaps and appends full buffers to the
+  trace file, until pins_stop_trace() is called.
+
+  @param   prm Pointer to trace recorder state.
+  @param   done Event to set when the thread has started.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_trace_thread(
+    void *prm,
+    osalEvent done)
+{
+    PinsTrace *t;
+
+    t = (PinsTrace*)prm;
+    osal_event_set(done);
+
+    while (!t->stop_thread && osal_go())
+    {
+        osal_event_wait(t->event, PINS_TRACE_FLUSH_MS);
+        pins_trace_write_full();
+    }
+}
+#endif
+
+#endif
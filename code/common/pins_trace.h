@@ -0,0 +1,115 @@
+/**
+
+  @file    common/pins_trace.h
+  @brief   Binary pin change trace recorder.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Records every pin value change detected by pins_read_all() and pin_get_ext(), and every
+  value written by pin_set_ext(), pins_set_group() and pins_set_multiple(), as fixed size
+  binary records with microsecond timestamp. Enabled by defining PINS_TRACE=1 for the build
+  and started by pins_start_trace().
+
+  Recording only copies 16 bytes into one of two buffers. When the buffer fills up, or a
+  change is recorded PINS_TRACE_FLUSH_MS after the previous swap, buffers are swapped and
+  a background thread appends the full buffer to the trace file. If the thread has not yet
+  written the other buffer, new records are dropped and counted. Without multithreading
+  support the buffer is written when swapped. Use scripts/pins_trace_to_csv.py to convert the trace to CSV.
+
+  The file format is defined also when the recorder is not compiled in, so that traces can
+  be replayed by the simulation backend, see pins_replay_trace().
+
+  Records are written without locks, so pins should be read and written from one thread
+  while the trace is running.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#pragma once
+#ifndef PINS_TRACE_H_
+#define PINS_TRACE_H_
+#include "pins.h"
+
+/** Trace file starts with PINS_TRACE_MAGIC, format version, record size and number of pins,
+    each as 32 bit little endian integer. Records follow.
+ */
+#define PINS_TRACE_MAGIC "PTRC"
+#define PINS_TRACE_VERSION 1
+#define PINS_TRACE_HDR_SZ 16
+
+/** Record types.
+ */
+#define PINS_TRACE_READ 1
+#define PINS_TRACE_WRITE 2
+
+/** One trace record, 16 bytes. Fields are stored in processor's byte order, which is little
+    endian on all supported targets.
+ */
+typedef struct PinsTraceRecord
+{
+    /** Microseconds since pins_start_trace().
+     */
+    os_int64 t_us;
+
+    /** Pin value after change.
+     */
+    os_int value;
+
+    /** Index of the pin's runtime value in IoPinsHdr.rv array, same order as pins appear
+        in JSON configuration.
+     */
+    os_ushort pin_ix;
+
+    /** State bits of the pin.
+     */
+    os_char state_bits;
+
+    /** PINS_TRACE_READ or PINS_TRACE_WRITE.
+     */
+    os_char type;
+}
+PinsTraceRecord;
+
+#if PINS_TRACE
+
+/** Number of records in each of the two buffers.
+ */
+#ifndef PINS_TRACE_BUF_RECORDS
+#define PINS_TRACE_BUF_RECORDS 1024
+#endif
+
+/** Maximum time in milliseconds recorded changes may wait in buffer before written to file.
+ */
+#ifndef PINS_TRACE_FLUSH_MS
+#define PINS_TRACE_FLUSH_MS 500
+#endif
+
+/* Start recording pin changes into file.
+ */
+osalStatus pins_start_trace(
+    const IoPinsHdr *hdr,
+    const os_char *path);
+
+/* Stop recording, write buffered records and close the file.
+ */
+void pins_stop_trace(void);
+
+/* Record pin change, called by pins library.
+ */
+void pin_trace_record(
+    const Pin *pin,
+    os_int x,
+    os_char state_bits,
+    os_char type);
+
+/* Number of records dropped since start because the file writer fell behind.
+ */
+os_uint pins_trace_dropped(void);
+
+#endif
+#endif
@@ -187,7 +187,7 @@ os_int OS_ISR_FUNC_ATTR pin_ll_get(
         case PIN_INPUT:
             /* Touch sensor
              */
-            if (pin->prm) {
+            if (pin->prm_n) {
                 if (pin_get_prm(pin, PIN_TOUCH)) {
                     /* return touchRead(pin->addr); */
                     break;
@@ -90,7 +90,7 @@ os_int OS_ISR_FUNC_ATTR pin_ll_get(
         case PIN_INPUT:
             /* Touch sensor
              */
-            if (pin->prm) {
+            if (pin->prm_n) {
                 if (pin_get_prm(pin, PIN_TOUCH)) {
                     *state_bits = OSAL_STATE_CONNECTED;
 #ifndef OSAL_ESPIDF_FRAMEWORK
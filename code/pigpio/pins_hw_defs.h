@@ -41,5 +41,9 @@ typedef void pin_interrupt_handler(void *arg);
 #define PINS_SIMULATION 0
 #define PINS_SIMULATED_INTERRUPTS 0
 
+/* GPIO banks 0-31 and 32-53 can be read with single gpioRead_Bits_x_y() call.
+ */
+#define PINS_BANK_IO 1
+
 #endif
 #endif
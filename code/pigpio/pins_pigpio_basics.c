@@ -218,5 +218,88 @@ os_int pin_ll_get(
     return 0;
 }
 
+
+/**
+****************************************************************************************************
+
+  @brief Get states of all digital inputs in GPIO bank.
+  @anchor pin_ll_get_bank
+
+  The pin_ll_get_bank() function reads GPIO 0 - 31 or 32 - 53 with one register access.
+
+  @param   bank GPIO bank number 0 or 1, see PINS_GPIO_BANK() macro.
+  @param   state_bits Pointer to byte where to store state bits like OSAL_STATE_CONNECTED.
+  @return  Bank snapshot, bit n is state of GPIO pin bank * 32 + n.
+
+****************************************************************************************************
+*/
+os_uint pin_ll_get_bank(
+    os_short bank,
+    os_char *state_bits)
+{
+    switch (bank)
+    {
+        case 0:
+            *state_bits = OSAL_STATE_CONNECTED;
+            return gpioRead_Bits_0_31();
+
+        case 1:
+            *state_bits = OSAL_STATE_CONNECTED;
+            return gpioRead_Bits_32_53();
+
+        default:
+            *state_bits = OSAL_STATE_NO_READ_SUPPORT;
+            return 0;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Set states of digital outputs in GPIO bank.
+  @anchor pin_ll_set_bank
+
+  The pin_ll_set_bank() function sets and clears GPIO 0 - 31 or 32 - 53 outputs selected by mask
+  with gpioWrite_Bits_x_y_Set() and gpioWrite_Bits_x_y_Clear() calls, one register write each.
+  The hardware has separate set and clear registers, so this is not one atomic write: Outputs
+  going high change together and outputs going low change together, but there is a short
+  window after the set write when only the first half has changed.
+
+  @param   bank GPIO bank number 0 or 1, see PINS_GPIO_BANK() macro.
+  @param   mask Bit n set to modify GPIO pin bank * 32 + n.
+  @param   bits New pin states, bit n is state of GPIO pin bank * 32 + n.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pin_ll_set_bank(
+    os_short bank,
+    os_uint mask,
+    os_uint bits)
+{
+    os_uint set_bits, clear_bits;
+
+    set_bits = bits & mask;
+    clear_bits = ~bits & mask;
+
+    switch (bank)
+    {
+        case 0:
+            if (set_bits) gpioWrite_Bits_0_31_Set(set_bits);
+            if (clear_bits) gpioWrite_Bits_0_31_Clear(clear_bits);
+            break;
+
+        case 1:
+            if (set_bits) gpioWrite_Bits_32_53_Set(set_bits);
+            if (clear_bits) gpioWrite_Bits_32_53_Clear(clear_bits);
+            break;
+
+        default:
+            osal_debug_error_int("pin_ll_set_bank: no such GPIO bank ", bank);
+            break;
+    }
+}
+
 #endif
 
@@ -36,4 +36,12 @@ typedef void pin_interrupt_handler(void);
 #define PINS_SIMULATION 1
 #define PINS_SIMULATED_INTERRUPTS 1
 
+/* Simulated GPIO can be read as 32 bit banks.
+ */
+#define PINS_BANK_IO 1
+
+/* Simulated GPIO interrupts can record edges into capture ring.
+ */
+#define PINS_EDGE_CAPTURE 1
+
 #endif
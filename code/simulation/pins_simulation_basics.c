@@ -18,12 +18,23 @@
 
 #include <stdlib.h> /* for rand() */
 
+#if PINS_BANK_IO
+/* Simulated state of GPIO outputs, bit n of bank b is state of GPIO pin b * 32 + n.
+   Bits set in pin_sim_out_mask are outputs, these read back from pin_sim_out_bank.
+ */
+static os_uint pin_sim_out_bank[PINS_MAX_GPIO_BANKS];
+static os_uint pin_sim_out_mask[PINS_MAX_GPIO_BANKS];
+#endif
+
 /**
 ****************************************************************************************************
 
   @brief Initialize hardware IO library.
   @anchor pins_ll_initialize_lib
 
+  The pins_ll_initialize_lib() function is called by pins_setup(). Simulation time is restarted,
+  so that simulated input sources are repeatable from one run to the next.
+
   @return  If IO library is successfully initialized, the function returns OSAL_SUCCESS.
            Other return values indicate an error.
 
@@ -32,6 +43,7 @@
 osalStatus pins_ll_initialize_lib(
     void)
 {
+    pins_sim_reset_time();
     return OSAL_SUCCESS;
 }
 
@@ -60,7 +72,9 @@ void pins_ll_shutdown_lib(
   @brief Initialize hardware IO pin.
   @anchor pin_ll_setup
 
-  The pin_ll_setup() function...
+  The pin_ll_setup() function marks digital output in GPIO bank as output, so that
+  pin_ll_get_bank() reads back the state written to it.
+
   @param   pin Pin to initialize.
   @param   flags Reserved for future, set 0 for now.
   @return  None.
@@ -71,6 +85,15 @@ void pin_ll_setup(
     const Pin *pin,
     os_int flags)
 {
+#if PINS_BANK_IO
+    os_short bank;
+
+    bank = PINS_GPIO_BANK(pin->addr);
+    if (pin->type == PIN_OUTPUT && pin->addr >= 0 && bank < PINS_MAX_GPIO_BANKS) {
+        pin_sim_out_mask[bank] |= 1u << PINS_GPIO_BANK_BIT(pin->addr);
+    }
+#endif
+    OSAL_UNUSED(flags);
 }
 
 
@@ -99,7 +122,10 @@ void pin_ll_shutdown(
   @brief Set IO pin state.
   @anchor pin_ll_set
 
-  The pin_ll_set() function...
+  The pin_ll_set() function traces the write. State of digital output in GPIO bank is
+  stored, so that it is same whether the output is written by pin_ll_set() or
+  pin_ll_set_bank().
+
   @param   pin Pointer to pin structure.
   @param   x Value to set, for example 0 or 1 for digital output.
   @return  None.
@@ -110,6 +136,18 @@ void pin_ll_set(
     const Pin *pin,
     os_int x)
 {
+#if PINS_BANK_IO
+    os_short bank;
+
+    bank = PINS_GPIO_BANK(pin->addr);
+    if (pin->type == PIN_OUTPUT && pin->addr >= 0 && bank < PINS_MAX_GPIO_BANKS)
+    {
+        pin_sim_out_mask[bank] |= 1u << PINS_GPIO_BANK_BIT(pin->addr);
+        if (x) pin_sim_out_bank[bank] |= 1u << PINS_GPIO_BANK_BIT(pin->addr);
+        else pin_sim_out_bank[bank] &= ~(1u << PINS_GPIO_BANK_BIT(pin->addr));
+    }
+#endif
+
     osal_trace_int("~Setting pin addr ", pin->addr);
     osal_trace_int(" to value ", x);
 }
@@ -121,7 +159,8 @@ void pin_ll_set(
   @brief Get IO pin state.
   @anchor pin_ll_get
 
-  The pin_ll_get() function...
+  The pin_ll_get() function returns value from pin's simulated input source if "sim"
+  attribute is set for the pin in JSON, otherwise a random value.
 
   @param   pin Pointer to pin structure.
   @param   state_bits Pointer to byte where to store state bits like OSAL_STATE_CONNECTED,
@@ -135,6 +174,10 @@ os_int pin_ll_get(
     const Pin *pin,
     os_char *state_bits)
 {
+    if (pin_get_prm(pin, PIN_SIM)) {
+        return pin_sim_get(pin, state_bits);
+    }
+
     switch (pin->type)
     {
         case PIN_INPUT:
@@ -147,4 +190,74 @@ os_int pin_ll_get(
     }
 }
 
+
+/**
+****************************************************************************************************
+
+  @brief Get states of all digital inputs in GPIO bank.
+  @anchor pin_ll_get_bank
+
+  The pin_ll_get_bank() function reads 32 GPIO pins with one call. Bit n of the return value
+  is state of GPIO pin bank * 32 + n. Output bits read back the state last written by
+  pin_ll_set() or pin_ll_set_bank(), other bits are random.
+
+  @param   bank GPIO bank number, see PINS_GPIO_BANK() macro.
+  @param   state_bits Pointer to byte where to store state bits like OSAL_STATE_CONNECTED.
+  @return  Bank snapshot, one bit per pin.
+
+****************************************************************************************************
+*/
+os_uint pin_ll_get_bank(
+    os_short bank,
+    os_char *state_bits)
+{
+    os_uint bits;
+
+    *state_bits = OSAL_STATE_CONNECTED;
+    bits = ((os_uint)osal_rand(0, 65535) << 16) | (os_uint)osal_rand(0, 65535);
+    if (bank < 0 || bank >= PINS_MAX_GPIO_BANKS) return bits;
+    return (bits & ~pin_sim_out_mask[bank]) | (pin_sim_out_bank[bank] & pin_sim_out_mask[bank]);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Set states of digital outputs in GPIO bank.
+  @anchor pin_ll_set_bank
+
+  The pin_ll_set_bank() function sets GPIO outputs selected by mask with one call. Simulated
+  output state is updated and each modified pin is traced like pin_ll_set() does.
+
+  @param   bank GPIO bank number, see PINS_GPIO_BANK() macro.
+  @param   mask Bit n set to modify GPIO pin bank * 32 + n.
+  @param   bits New pin states, bit n is state of GPIO pin bank * 32 + n.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pin_ll_set_bank(
+    os_short bank,
+    os_uint mask,
+    os_uint bits)
+{
+    os_short n;
+
+    if (bank < 0 || bank >= PINS_MAX_GPIO_BANKS) {
+        osal_debug_error_int("pin_ll_set_bank: no such GPIO bank ", bank);
+        return;
+    }
+
+    pin_sim_out_bank[bank] = (pin_sim_out_bank[bank] & ~mask) | (bits & mask);
+    pin_sim_out_mask[bank] |= mask;
+
+    for (n = 0; n < 32; n++)
+    {
+        if (mask & (1u << n)) {
+            osal_trace_int("~Setting pin addr ", 32 * bank + n);
+            osal_trace_int(" to value ", (bits >> n) & 1);
+        }
+    }
+}
+
 #endif
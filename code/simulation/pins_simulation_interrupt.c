@@ -40,8 +40,13 @@ void pin_gpio_attach_interrupt(
     pinInterruptParams *prm)
 {
 #if PINS_SIMULATED_INTERRUPTS
+    PinInterruptConf *int_conf;
+#if PINS_EDGE_CAPTURE
+    PinEdgeRing *capture;
+#endif
 
-    if (pin->int_conf == OS_NULL)
+    int_conf = PIN_INT_CONF(pin);
+    if (int_conf == OS_NULL)
     {
         osal_debug_error("pin_gpio_attach_interrupt: No \'interrupt\' attribute in JSON, etc");
         return;
@@ -50,8 +55,24 @@ void pin_gpio_attach_interrupt(
     /** Store the interrupt handler function pointer and flags (when to trigger interrupts)
         for simulation.
      */
-    pin->int_conf->int_handler_func = prm->int_handler_func;
-    pin->int_conf->flags = prm->flags;
+    int_conf->int_handler_func = prm->int_handler_func;
+    int_conf->flags = prm->flags;
+#if PINS_EDGE_CAPTURE
+    capture = prm->capture;
+    if (capture)
+    {
+        if (capture->buf == OS_NULL || capture->buf_sz < 2) {
+            osal_debug_error("pin_gpio_attach_interrupt: No capture ring buffer");
+            capture = OS_NULL;
+        }
+        else {
+            capture->head = capture->tail = 0;
+            capture->overflow_count = 0;
+        }
+    }
+    PINS_MEMORY_BARRIER();
+    int_conf->capture = capture;
+#endif
 #endif
 }
 
@@ -72,19 +93,29 @@ void pin_gpio_attach_interrupt(
 void pin_gpio_detach_interrupt(
     const struct Pin *pin)
 {
-    if (pin->int_conf == OS_NULL)
+    PinInterruptConf *int_conf;
+
+    int_conf = PIN_INT_CONF(pin);
+    if (int_conf == OS_NULL)
     {
         osal_debug_error("pin_gpio_detach_interrupt: No \'interrupt\' attribute in JSON, etc");
         return;
     }
 
-    if (pin->int_conf->int_handler_func == OS_NULL)
+#if PINS_EDGE_CAPTURE
+    if (int_conf->int_handler_func == OS_NULL && int_conf->capture == OS_NULL)
+#else
+    if (int_conf->int_handler_func == OS_NULL)
+#endif
     {
         osal_debug_error("pin_gpio_detach_interrupt: Interrupt was not attached to pin?");
         return;
     }
 
-    pin->int_conf->int_handler_func = OS_NULL;
+    int_conf->int_handler_func = OS_NULL;
+#if PINS_EDGE_CAPTURE
+    int_conf->capture = OS_NULL;
+#endif
 }
 
 
@@ -99,7 +130,8 @@ void pin_gpio_detach_interrupt(
   - x is zero and PINS_INT_FALLING flag is set (included in PINS_INT_CHANGE).
   - x is nonzero and PINS_INT_RISING flag is set (included in PINS_INT_CHANGE).
 
-  For PC simulation only.
+  If capture ring is set for the pin, the edge is recorded into it before calling
+  the interrupt handler. For PC simulation only.
 
   @param   pin The GPIO pin structure.
   @param   x New pin state.
@@ -111,27 +143,43 @@ void pin_gpio_simulate_interrupt(
     const struct Pin *pin,
     os_int x)
 {
+    PinInterruptConf *int_conf;
+    pin_interrupt_handler *int_handler_func;
     os_short flags;
 
     /* If pin is not configured for interrupts.
      */
-    if (pin->int_conf == OS_NULL)
+    int_conf = PIN_INT_CONF(pin);
+    if (int_conf == OS_NULL)
     {
         osal_debug_error("pin_gpio_simulate_interrupt: NULL int_conf pointer");
         return;
     }
 
-    /* If interrupt handler not set, just return.
+    /* If interrupt handler not set and not capturing, just return.
      */
-    if (pin->int_conf->int_handler_func == OS_NULL) return;
+    int_handler_func = int_conf->int_handler_func;
+#if PINS_EDGE_CAPTURE
+    if (int_handler_func == OS_NULL && int_conf->capture == OS_NULL) return;
+#else
+    if (int_handler_func == OS_NULL) return;
+#endif
 
-    /* If new signal value matches rising/falling edge flag, call interrupt handler.
+    /* If new signal value matches rising/falling edge flag, record the edge and
+       call interrupt handler.
      */
-    flags = pin->int_conf->flags;
+    flags = int_conf->flags;
     if (((flags & PINS_INT_FALLING) && x == 0) ||
         ((flags & PINS_INT_RISING) && x != 0))
     {
-        pin->int_conf->int_handler_func();
+#if PINS_EDGE_CAPTURE
+        if (int_conf->capture) {
+            pin_capture_edge(int_conf->capture, pin, x);
+        }
+#endif
+        if (int_handler_func) {
+            int_handler_func();
+        }
     }
 }
 
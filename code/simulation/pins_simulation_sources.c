@@ -0,0 +1,509 @@
+/**
+
+  @file    simulation/pins_simulation_sources.c
+  @brief   Deterministic input sources for simulated pins.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Replay trace formats:
+  - CSV: One row per line, first column is time in ms from start of trace, following columns
+    are values. Lines starting with '#' or a letter (header) are skipped.
+  - Binary: Starts with "PSIM" and number of value columns as 32 bit integer, followed by
+    rows of 32 bit integers: Time in ms and values. Little endian.
+
+  Rows must be in time order. The last row is held when the trace ends.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pinsx.h"
+#ifdef PINS_SIMULATE_HW
+
+#include <math.h> /* for sin() */
+
+/* Replay trace reader state. Current row values are used until time reaches next row.
+ */
+typedef struct PinsSimReplay
+{
+    osalStream f;
+    os_boolean binary;
+    os_boolean at_end;
+    os_int n_columns;
+
+    /** Simulation time when replay was opened. Row times are relative to this.
+     */
+    os_long base_ms;
+
+    os_int value[PINS_SIM_REPLAY_MAX_COLUMNS];
+    os_int next_value[PINS_SIM_REPLAY_MAX_COLUMNS];
+    os_long next_ms;
+    os_int next_n;
+
+    /* Read buffer.
+     */
+    os_char buf[512];
+    os_int buf_pos;
+    os_int buf_n;
+}
+PinsSimReplay;
+
+static PinsSimReplay pins_sim_replay;
+
+/* Simulation time. Start timer is taken by pins_setup(), or at first read if pins_setup()
+   has not been called. Manual time is used if set.
+ */
+static os_timer pins_sim_start_t;
+static os_boolean pins_sim_started;
+static os_long pins_sim_manual_ms;
+static os_boolean pins_sim_manual;
+
+/* Forward referred static functions.
+ */
+static os_long pins_sim_now_ms(void);
+
+static os_int pins_sim_noise(
+    const Pin *pin,
+    os_uint step,
+    os_int min,
+    os_int range);
+
+static void pins_sim_advance_replay(
+    os_long now_ms);
+
+static osalStatus pins_sim_read_row(void);
+
+static os_int pins_sim_getc(void);
+
+
+/**
+****************************************************************************************************
+
+  @brief Get value from pin's simulated input source.
+  @anchor pin_sim_get
+
+  The pin_sim_get() function is called by pin_ll_get() for pins with "sim" attribute.
+
+  @param   pin Pointer to pin structure.
+  @param   state_bits Pointer to byte where to store state bits.
+  @return  Pin value.
+
+****************************************************************************************************
+*/
+os_int pin_sim_get(
+    const Pin *pin,
+    os_char *state_bits)
+{
+    os_long now_ms, t;
+    os_int source, period, min, max, range, column;
+    os_double a;
+
+    *state_bits = OSAL_STATE_CONNECTED;
+    source = pin_get_prm(pin, PIN_SIM);
+    if (source == PIN_SIM_CONST) {
+        return pin_get_prm(pin, PIN_INIT);
+    }
+
+    now_ms = pins_sim_now_ms();
+    if (source == PIN_SIM_REPLAY)
+    {
+        column = pin_get_prm(pin, PIN_SIM_COLUMN);
+        pins_sim_advance_replay(now_ms);
+        if (pins_sim_replay.f == OS_NULL && !pins_sim_replay.at_end) {
+            *state_bits = OSAL_STATE_UNCONNECTED;
+            return 0;
+        }
+        if (column < 1 || column > pins_sim_replay.n_columns) {
+            *state_bits = OSAL_STATE_UNCONNECTED;
+            return 0;
+        }
+        return pins_sim_replay.value[column - 1];
+    }
+
+    /* Waveform range. If "sim-max" is not set, use "max" or 1 for digital input.
+     */
+    min = pin_get_prm(pin, PIN_SIM_MIN);
+    max = pin_get_prm(pin, PIN_SIM_MAX);
+    if (max == 0 && min == 0) {
+        max = pin_get_prm(pin, PIN_MAX);
+        if (max == 0) max = (pin->type == PIN_INPUT) ? 1 : 4095;
+    }
+    range = max - min;
+
+    period = pin_get_prm(pin, PIN_SIM_PERIOD);
+    if (period <= 0) period = 1000;
+    t = now_ms % period;
+
+    switch (source)
+    {
+        case PIN_SIM_SQUARE:
+            return (t < period / 2) ? min : max;
+
+        case PIN_SIM_SINE:
+            a = sin(2.0 * 3.14159265358979 * (os_double)t / period);
+            return min + (os_int)(range * (a + 1.0) / 2.0 + 0.5);
+
+        case PIN_SIM_RAMP:
+            return min + (os_int)(((os_int64)range * t) / period);
+
+        case PIN_SIM_NOISE:
+            return pins_sim_noise(pin, (os_uint)(now_ms / period), min, range);
+
+        default:
+            *state_bits = OSAL_STATE_CONNECTED|OSAL_STATE_ORANGE;
+            return 0;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Set simulation time.
+  @anchor pins_sim_set_time
+
+  The pins_sim_set_time() function sets time used by simulated sources, so that test runs are
+  exactly repeatable regardless of how fast the loop runs.
+
+  @param   ms Simulation time in milliseconds.
+  @param   manual OS_TRUE to use ms as simulation time from now on. OS_FALSE to return to
+           real time since pins_setup().
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_sim_set_time(
+    os_long ms,
+    os_boolean manual)
+{
+    pins_sim_manual_ms = ms;
+    pins_sim_manual = manual;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Restart simulation time from zero.
+  @anchor pins_sim_reset_time
+
+  The pins_sim_reset_time() function is called by pins_setup() through pins_ll_initialize_lib(),
+  so that waveforms start from the same phase on every run. Manual time is not modified.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_sim_reset_time(void)
+{
+    os_get_timer(&pins_sim_start_t);
+    pins_sim_started = OS_TRUE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Open trace to replay.
+  @anchor pins_sim_open_replay
+
+  The pins_sim_open_replay() function opens CSV or binary trace file and reads the first
+  row. Replay starts from current simulation time. Pins with "sim": "replay" read value from
+  column given by "sim-column".
+
+  @param   path Path to trace file.
+  @return  OSAL_SUCCESS if all good, other values indicate an error.
+
+****************************************************************************************************
+*/
+osalStatus pins_sim_open_replay(
+    const os_char *path)
+{
+    PinsSimReplay *r;
+    os_uchar hdr[8];
+    os_memsz n_read;
+    osalStatus s;
+
+    pins_sim_close_replay();
+    r = &pins_sim_replay;
+
+    r->f = osal_file_open(path, OS_NULL, &s, OSAL_STREAM_READ);
+    if (r->f == OS_NULL) {
+        osal_debug_error_str("pins_sim_open_replay: Cannot open ", path);
+        return s;
+    }
+
+    /* Binary trace starts with "PSIM" and number of columns.
+     */
+    s = osal_file_read(r->f, (os_char*)hdr, sizeof(hdr), &n_read, OSAL_STREAM_DEFAULT);
+    if (s == OSAL_SUCCESS && n_read == sizeof(hdr) && !os_memcmp(hdr, "PSIM", 4))
+    {
+        r->binary = OS_TRUE;
+        r->n_columns = (os_int)(hdr[4] | (hdr[5] << 8) | (hdr[6] << 16) | ((os_uint)hdr[7] << 24));
+        if (r->n_columns < 0 || r->n_columns > PINS_SIM_REPLAY_MAX_COLUMNS) {
+            osal_debug_error("pins_sim_open_replay: Too many columns");
+            pins_sim_close_replay();
+            return OSAL_STATUS_FAILED;
+        }
+    }
+    else
+    {
+        os_memcpy(r->buf, hdr, n_read);
+        r->buf_n = (os_int)n_read;
+    }
+
+    if (pins_sim_read_row()) {
+        osal_debug_error("pins_sim_open_replay: Empty trace");
+        pins_sim_close_replay();
+        return OSAL_STATUS_FAILED;
+    }
+
+    /* Row times are relative to start of replay.
+     */
+    r->base_ms = pins_sim_now_ms();
+    pins_sim_advance_replay(r->base_ms);
+    return OSAL_SUCCESS;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Close replay trace.
+  @anchor pins_sim_close_replay
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_sim_close_replay(void)
+{
+    if (pins_sim_replay.f) {
+        osal_file_close(pins_sim_replay.f, OSAL_STREAM_DEFAULT);
+    }
+    os_memclear(&pins_sim_replay, sizeof(PinsSimReplay));
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get simulation time.
+  @anchor pins_sim_now_ms
+
+  @return  Milliseconds since pins_setup(), or time set by pins_sim_set_time().
+
+****************************************************************************************************
+*/
+static os_long pins_sim_now_ms(void)
+{
+    os_timer now;
+
+    if (pins_sim_manual) {
+        return pins_sim_manual_ms;
+    }
+
+    os_get_timer(&now);
+    if (!pins_sim_started) {
+        pins_sim_start_t = now;
+        pins_sim_started = OS_TRUE;
+    }
+    return (os_long)os_get_ms_elapsed(&pins_sim_start_t, &now);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Pseudo random value for noise source.
+  @anchor pins_sim_noise
+
+  Integer hash of seed, pin address and time step. Same inputs always give same value.
+
+  @param   pin Pointer to pin structure.
+  @param   step Time step, time divided by noise sample time.
+  @param   min Minimum value.
+  @param   range Maximum - minimum.
+  @return  Noise value.
+
+****************************************************************************************************
+*/
+static os_int pins_sim_noise(
+    const Pin *pin,
+    os_uint step,
+    os_int min,
+    os_int range)
+{
+    os_uint h;
+
+    h = (os_uint)pin_get_prm(pin, PIN_SIM_SEED) * 0x9E3779B1u;
+    h ^= (os_uint)pin->addr * 0x85EBCA6Bu + step;
+    h ^= h >> 16;
+    h *= 0x7FEB352Du;
+    h ^= h >> 15;
+    h *= 0x846CA68Bu;
+    h ^= h >> 16;
+
+    if (range <= 0) return min;
+    return min + (os_int)(h % (os_uint)(range + 1));
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Move replay forward to current time.
+  @anchor pins_sim_advance_replay
+
+  Rows whose time has been reached are made current. When the trace ends, file is closed
+  and the last row is held.
+
+  @param   now_ms Current simulation time.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_sim_advance_replay(
+    os_long now_ms)
+{
+    PinsSimReplay *r;
+
+    r = &pins_sim_replay;
+    while (r->f && now_ms - r->base_ms >= r->next_ms)
+    {
+        os_memcpy(r->value, r->next_value, r->next_n * sizeof(os_int));
+        if (!r->binary && r->next_n > r->n_columns) r->n_columns = r->next_n;
+
+        if (pins_sim_read_row())
+        {
+            osal_file_close(r->f, OSAL_STREAM_DEFAULT);
+            r->f = OS_NULL;
+            r->at_end = OS_TRUE;
+        }
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Read next row of replay trace.
+  @anchor pins_sim_read_row
+
+  The row is stored in next_ms, next_value and next_n.
+
+  @return  OSAL_SUCCESS if row was read, OSAL_END_OF_FILE at end of trace.
+
+****************************************************************************************************
+*/
+static osalStatus pins_sim_read_row(void)
+{
+    PinsSimReplay *r;
+    os_int c, i, j, x, n;
+    os_boolean neg, digits;
+
+    r = &pins_sim_replay;
+
+    if (r->binary)
+    {
+        for (i = 0; i <= r->n_columns; i++)
+        {
+            x = 0;
+            for (j = 0; j < 4; j++) {
+                c = pins_sim_getc();
+                if (c < 0) return OSAL_END_OF_FILE;
+                x |= (os_int)((os_uint)c << (8 * j));
+            }
+            if (i == 0) r->next_ms = x;
+            else r->next_value[i - 1] = x;
+        }
+        r->next_n = r->n_columns;
+        return OSAL_SUCCESS;
+    }
+
+    /* CSV: Skip empty, comment and header lines.
+     */
+    while (OS_TRUE)
+    {
+        c = pins_sim_getc();
+        if (c < 0) return OSAL_END_OF_FILE;
+        if (c == '-' || (c >= '0' && c <= '9')) break;
+        if (c == '\n' || c == '\r' || c == ' ' || c == '\t') continue;
+        do {
+            c = pins_sim_getc();
+        }
+        while (c >= 0 && c != '\n');
+    }
+
+    /* Parse comma separated integers until end of line.
+     */
+    n = -1;
+    x = 0;
+    neg = digits = OS_FALSE;
+    while (OS_TRUE)
+    {
+        if (c == '-') {
+            neg = OS_TRUE;
+        }
+        else if (c >= '0' && c <= '9') {
+            x = 10 * x + (c - '0');
+            digits = OS_TRUE;
+        }
+        else if (c == ',' || c == '\n' || c < 0)
+        {
+            if (digits) {
+                if (neg) x = -x;
+                if (n < 0) r->next_ms = x;
+                else if (n < PINS_SIM_REPLAY_MAX_COLUMNS) r->next_value[n] = x;
+            }
+            else if (n >= 0 && n < PINS_SIM_REPLAY_MAX_COLUMNS) {
+                r->next_value[n] = 0;
+            }
+            n++;
+            x = 0;
+            neg = digits = OS_FALSE;
+            if (c != ',') break;
+        }
+        c = pins_sim_getc();
+    }
+
+    r->next_n = n;
+    if (r->next_n > PINS_SIM_REPLAY_MAX_COLUMNS) r->next_n = PINS_SIM_REPLAY_MAX_COLUMNS;
+    return OSAL_SUCCESS;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get next byte from replay trace.
+  @anchor pins_sim_getc
+
+  @return  Byte 0 - 255, or -1 at end of file.
+
+****************************************************************************************************
+*/
+static os_int pins_sim_getc(void)
+{
+    PinsSimReplay *r;
+    os_memsz n_read;
+
+    r = &pins_sim_replay;
+    if (r->buf_pos >= r->buf_n)
+    {
+        if (osal_file_read(r->f, r->buf, sizeof(r->buf), &n_read, OSAL_STREAM_DEFAULT) ||
+            n_read == 0)
+        {
+            return -1;
+        }
+        r->buf_n = (os_int)n_read;
+        r->buf_pos = 0;
+    }
+    return (os_uchar)r->buf[r->buf_pos++];
+}
+
+#endif
@@ -0,0 +1,67 @@
+/**
+
+  @file    simulation/pins_simulation_sources.h
+  @brief   Deterministic input sources for simulated pins.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  By default simulated inputs return random values, which change on every read. A pin can
+  instead be given a source in JSON with "sim" attribute:
+  - "const": Value of "init" attribute.
+  - "square", "sine", "ramp": Waveform between "sim-min" and "sim-max" with period
+    "sim-period-ms".
+  - "noise": Pseudo random value between "sim-min" and "sim-max", seeded by "sim-seed"
+    and held for "sim-period-ms".
+  - "replay": Column "sim-column" of trace opened by pins_sim_open_replay().
+
+  Waveforms and noise are pure functions of simulation time, so these need no state. Time is
+  milliseconds since pins_setup(), which restarts it from zero so that waveform phase is the
+  same on every run. Application can set time with pins_sim_set_time() for fully repeatable
+  runs regardless of loop speed. Replay reads the trace file row by row into a fixed buffer,
+  nothing is allocated during playback.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#pragma once
+#ifndef PINS_SIMULATION_SOURCES_H_
+#define PINS_SIMULATION_SOURCES_H_
+#include "pins.h"
+
+/** Maximum number of value columns in replay trace.
+ */
+#ifndef PINS_SIM_REPLAY_MAX_COLUMNS
+#define PINS_SIM_REPLAY_MAX_COLUMNS 64
+#endif
+
+/* Get value from pin's simulated input source.
+ */
+os_int pin_sim_get(
+    const Pin *pin,
+    os_char *state_bits);
+
+/* Set simulation time, or resume real time.
+ */
+void pins_sim_set_time(
+    os_long ms,
+    os_boolean manual);
+
+/* Restart simulation time from zero, called by pins_setup().
+ */
+void pins_sim_reset_time(void);
+
+/* Open CSV or binary trace to replay.
+ */
+osalStatus pins_sim_open_replay(
+    const os_char *path);
+
+/* Close replay trace.
+ */
+void pins_sim_close_replay(void);
+
+#endif
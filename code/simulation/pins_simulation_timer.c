@@ -21,8 +21,10 @@ void pin_timer_attach_interrupt(
     pinTimerParams *prm)
 {
 #if PINS_SIMULATED_INTERRUPTS
+    PinInterruptConf *int_conf;
 
-    if (pin->int_conf == OS_NULL)
+    int_conf = PIN_INT_CONF(pin);
+    if (int_conf == OS_NULL)
     {
         osal_debug_error("pin_timer_attach_interrupt: pin->int_conf is NULL");
         return;
@@ -31,9 +33,34 @@ void pin_timer_attach_interrupt(
     /** Store the interrupt handler function pointer and flags (when to trigger interrupts)
         for simulation.
      */
-    pin->int_conf->int_handler_func = prm->int_handler_func;
-    // pin->int_conf->flags = prm->flags;
-    os_get_timer(&pin->int_conf->hit_timer);
+    int_conf->int_handler_func = prm->int_handler_func;
+    // int_conf->flags = prm->flags;
+    os_get_timer(&int_conf->hit_timer);
+#endif
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Detach interrupt from timer.
+  @anchor pin_timer_detach_interrupt
+
+  The pin_timer_detach_interrupt() function stops calling the simulated timer interrupt
+  handler.
+
+  @param   pin Pointer to the pin structure.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pin_timer_detach_interrupt(
+    const struct Pin *pin)
+{
+#if PINS_SIMULATED_INTERRUPTS
+    if (PIN_INT_CONF(pin)) {
+        PIN_INT_CONF(pin)->int_handler_func = OS_NULL;
+    }
 #endif
 }
 
@@ -55,12 +82,14 @@ void pin_timer_attach_interrupt(
 void pin_timer_simulate_interrupt(
     const struct Pin *pin)
 {
+    PinInterruptConf *int_conf;
     os_timer ti;
     os_int x, period_ms;
 
     /* If pin is not configured for interrupts.
      */
-    if (pin->int_conf == OS_NULL)
+    int_conf = PIN_INT_CONF(pin);
+    if (int_conf == OS_NULL)
     {
         osal_debug_error("pin_gpio_simulate_interrupt: NULL int_conf pointer");
         return;
@@ -68,7 +97,7 @@ void pin_timer_simulate_interrupt(
 
     /* If interrupt handler not set, just return.
      */
-    if (pin->int_conf->int_handler_func == OS_NULL) return;
+    if (int_conf->int_handler_func == OS_NULL) return;
 
     os_get_timer(&ti);
     x = pin_get_frequency(pin, 50);
@@ -76,10 +105,10 @@ void pin_timer_simulate_interrupt(
     if (x > 0) period_ms = (os_int)(1000.0 / x + 0.5);
     if (period_ms < 1) period_ms = 1;
 
-    if (os_has_elapsed_since(&pin->int_conf->hit_timer, &ti, period_ms))
+    if (os_has_elapsed_since(&int_conf->hit_timer, &ti, period_ms))
     {
-        pin->int_conf->int_handler_func();
-        pin->int_conf->hit_timer = ti;
+        int_conf->int_handler_func();
+        int_conf->hit_timer = ti;
     }
 }
 #endif
@@ -0,0 +1,318 @@
+/**
+
+  @file    simulation/pins_simulation_trace_replay.c
+  @brief   Replay pin change trace trough PINS and IOCOM.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pinsx.h"
+#ifdef PINS_SIMULATE_HW
+
+/* Number of records read from file at once.
+ */
+#define PINS_REPLAY_CHUNK 64
+
+/* Forward referred static functions.
+ */
+static const Pin **pins_replay_map_pins(
+    const IoPinsHdr *hdr,
+    os_memsz *map_sz);
+
+static void pins_replay_record(
+    const Pin *pin,
+    const PinsTraceRecord *r,
+    PinsTraceReplayStats *stats);
+
+static void pins_replay_end_batch(
+    os_int64 scheduled_us,
+    os_int64 begin_us,
+    os_boolean paced,
+    PinsTraceReplayStats *stats);
+
+
+/**
+****************************************************************************************************
+
+  @brief Replay pin change trace file.
+  @anchor pins_replay_trace
+
+  The pins_replay_trace() function reads trace file written by pins_start_trace() and feeds
+  the records to pins, see pins_simulation_trace_replay.h. The function returns when whole
+  trace has been played.
+
+  @param   hdr Top level pins IO configuration structure, same configuration the trace was
+           recorded with.
+  @param   path Path to trace file.
+  @param   speed Playback speed: 1 for original speed, 10 for ten times faster, etc.
+           PINS_REPLAY_MAX_SPEED to play as fast as possible.
+  @param   stats Where to store throughput and latency results.
+  @return  OSAL_SUCCESS if trace was played, other values indicate an error.
+
+****************************************************************************************************
+*/
+osalStatus pins_replay_trace(
+    const IoPinsHdr *hdr,
+    const os_char *path,
+    os_int speed,
+    PinsTraceReplayStats *stats)
+{
+    osalStream f;
+    const Pin **map;
+    PinsTraceRecord buf[PINS_REPLAY_CHUNK], *r;
+    os_uint h[PINS_TRACE_HDR_SZ / sizeof(os_uint)];
+    os_int64 start_us, first_t_us, batch_t_us, scheduled_us, begin_us, now;
+    os_memsz map_sz, n_read, n_bytes, keep;
+    os_int i, n;
+    os_boolean in_batch;
+    osalStatus s;
+
+    os_memclear(stats, sizeof(PinsTraceReplayStats));
+
+    f = osal_file_open(path, OS_NULL, &s, OSAL_STREAM_READ);
+    if (f == OS_NULL) {
+        osal_debug_error_str("pins_replay_trace: Cannot open ", path);
+        return s;
+    }
+
+    s = osal_file_read(f, (os_char*)h, PINS_TRACE_HDR_SZ, &n_read, OSAL_STREAM_DEFAULT);
+    if (s || n_read != PINS_TRACE_HDR_SZ || os_memcmp(h, PINS_TRACE_MAGIC, 4) ||
+        h[1] != PINS_TRACE_VERSION || h[2] != sizeof(PinsTraceRecord))
+    {
+        osal_debug_error_str("pins_replay_trace: Not a trace file ", path);
+        osal_file_close(f, OSAL_STREAM_DEFAULT);
+        return OSAL_STATUS_FAILED;
+    }
+
+    map = pins_replay_map_pins(hdr, &map_sz);
+    if (map == OS_NULL) {
+        osal_file_close(f, OSAL_STREAM_DEFAULT);
+        return OSAL_STATUS_MEMORY_ALLOCATION_FAILED;
+    }
+
+    start_us = pins_now_us();
+    first_t_us = batch_t_us = scheduled_us = begin_us = 0;
+    in_batch = OS_FALSE;
+    keep = 0;
+
+    while (OS_TRUE)
+    {
+        s = osal_file_read(f, (os_char*)buf + keep, sizeof(buf) - keep, &n_read,
+            OSAL_STREAM_DEFAULT);
+        n_bytes = keep + n_read;
+        n = (os_int)(n_bytes / sizeof(PinsTraceRecord));
+        if (n == 0) break;
+
+        for (i = 0; i < n; i++)
+        {
+            r = buf + i;
+
+            /* Records with same time stamp make one batch. Before starting a new batch,
+               wait until it's time for it, unless playing at maximum speed.
+             */
+            if (!in_batch || r->t_us != batch_t_us)
+            {
+                if (in_batch) {
+                    pins_replay_end_batch(scheduled_us, begin_us, speed > 0, stats);
+                }
+                else {
+                    first_t_us = r->t_us;
+                }
+
+                batch_t_us = r->t_us;
+                now = pins_now_us();
+                if (speed > 0)
+                {
+                    scheduled_us = start_us + (batch_t_us - first_t_us) / speed;
+                    while (now < scheduled_us)
+                    {
+                        if (scheduled_us - now > 2000) {
+                            os_sleep((os_long)((scheduled_us - now) / 1000 - 1));
+                        }
+                        else {
+                            os_timeslice();
+                        }
+                        now = pins_now_us();
+                    }
+                }
+
+                begin_us = now;
+                pins_begin_iocom_batch();
+                in_batch = OS_TRUE;
+            }
+
+            if (r->pin_ix >= map_sz || map[r->pin_ix] == OS_NULL) {
+                stats->n_skipped++;
+                continue;
+            }
+            pins_replay_record(map[r->pin_ix], r, stats);
+        }
+
+        /* Keep partial record for next read.
+         */
+        keep = n_bytes - n * sizeof(PinsTraceRecord);
+        if (keep) {
+            os_memcpy(buf, (os_char*)buf + n * sizeof(PinsTraceRecord), keep);
+        }
+        if (s) break;
+    }
+
+    if (in_batch) {
+        pins_replay_end_batch(scheduled_us, begin_us, speed > 0, stats);
+    }
+
+    stats->trace_us = batch_t_us - first_t_us;
+    stats->elapsed_us = pins_now_us() - start_us;
+    if (stats->elapsed_us > 0) {
+        stats->records_per_s = (os_uint)(1000000 * (os_int64)stats->n_records / stats->elapsed_us);
+    }
+
+    os_free((void*)map, map_sz * sizeof(const Pin*));
+    osal_file_close(f, OSAL_STREAM_DEFAULT);
+    return OSAL_SUCCESS;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Make table to find pin by trace pin index.
+  @anchor pins_replay_map_pins
+
+  Trace records identify pin by index of it's runtime value in IoPinsHdr.rv array.
+
+  @param   hdr Top level pins IO configuration structure.
+  @param   map_sz Where to store number of items in table.
+  @return  Pointer to table of pin pointers, allocated by os_malloc(). OS_NULL if memory
+           allocation failed.
+
+****************************************************************************************************
+*/
+static const Pin **pins_replay_map_pins(
+    const IoPinsHdr *hdr,
+    os_memsz *map_sz)
+{
+    const Pin **map, *pin;
+    os_int i, j, ix;
+
+    *map_sz = hdr->n_rv > 0 ? hdr->n_rv : 1;
+    map = (const Pin**)os_malloc(*map_sz * sizeof(const Pin*), OS_NULL);
+    if (map == OS_NULL) return OS_NULL;
+    os_memclear(map, *map_sz * sizeof(const Pin*));
+
+    for (i = 0; i < hdr->n_groups; i++)
+    {
+        pin = hdr->group[i]->pin;
+        for (j = 0; j < hdr->group[i]->n_pins; j++, pin++)
+        {
+            if (PIN_RV(pin) == OS_NULL) continue;
+            ix = (os_int)(PIN_RV(pin) - hdr->rv);
+            if ((os_uint)ix < (os_uint)*map_sz) {
+                map[ix] = pin;
+            }
+        }
+    }
+
+    return map;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Feed one trace record to pins.
+  @anchor pins_replay_record
+
+  Read record is stored as input value and forwarded to IOCOM. Write record is set to pin's
+  IOCOM signal and forwarded to the pin, as if received from controller. If the pin has no
+  signal, the value is written to pin directly.
+
+  @param   pin Pointer to pin configuration structure.
+  @param   r Trace record.
+  @param   stats Replay results to update.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_replay_record(
+    const Pin *pin,
+    const PinsTraceRecord *r,
+    PinsTraceReplayStats *stats)
+{
+    const iocSignal *signal;
+
+    stats->n_records++;
+
+    if (r->type == PINS_TRACE_WRITE)
+    {
+        stats->n_writes++;
+        signal = PIN_SIGNAL(pin);
+        if (signal && (signal->flags & IOC_PIN_PTR))
+        {
+            ioc_set_ext(signal, r->value, r->state_bits | OSAL_STATE_CONNECTED);
+            forward_signal_change_to_io_pin(signal, IOC_SIGNAL_NO_TBUF_CHECK);
+        }
+        else
+        {
+            pin_set_ext(pin, r->value, PIN_NO_IOCOM_FORWARD);
+        }
+    }
+    else
+    {
+        stats->n_reads++;
+        if (pin_store_input(pin, r->value, r->state_bits)) {
+            stats->n_changes++;
+        }
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief End batch of records with same time stamp.
+  @anchor pins_replay_end_batch
+
+  Flushes batched changes to IOCOM and updates batch processing time and lag statistics.
+
+  @param   scheduled_us Time when the batch should have been processed.
+  @param   begin_us Time when processing the batch started.
+  @param   paced OS_FALSE if played at maximum speed, lag is not measured.
+  @param   stats Replay results to update.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_replay_end_batch(
+    os_int64 scheduled_us,
+    os_int64 begin_us,
+    os_boolean paced,
+    PinsTraceReplayStats *stats)
+{
+    os_int64 now;
+    os_uint d, lag;
+
+    pins_end_iocom_batch();
+    now = pins_now_us();
+
+    d = (os_uint)(now - begin_us);
+    if (d > stats->max_batch_us) stats->max_batch_us = d;
+    stats->sum_batch_us += d;
+    stats->n_batches++;
+    if (!paced) return;
+
+    lag = (os_uint)(now - scheduled_us);
+    if (lag > stats->max_lag_us) stats->max_lag_us = lag;
+    stats->sum_lag_us += lag;
+    if (lag > PINS_REPLAY_LATE_US) stats->n_late++;
+}
+
+
+#endif
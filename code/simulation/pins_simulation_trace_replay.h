@@ -0,0 +1,90 @@
+/**
+
+  @file    simulation/pins_simulation_trace_replay.h
+  @brief   Replay pin change trace trough PINS and IOCOM.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Feeds a trace recorded by pins_start_trace(), or synthetic trace in the same format, to
+  pins as if the changes happened now. Read records are stored with pin_store_input(), which
+  updates PinRV and forwards the change to IOCOM trough pin_to_iocom(). Write records are
+  written to the pin's IOCOM signal and passed to forward_signal_change_to_io_pin(), as if
+  received from the controller. Records with the same time stamp are forwarded in one IOCOM
+  batch, like pins_read_all() does.
+
+  The trace can be played at original speed, faster, or as fast as possible to find out how
+  many changes per second the PINS to IOCOM path sustains. Achieved throughput and how far
+  behind the trace schedule processing fell are reported.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#pragma once
+#ifndef PINS_SIMULATION_TRACE_REPLAY_H_
+#define PINS_SIMULATION_TRACE_REPLAY_H_
+#include "pins.h"
+
+/** Speed argument for pins_replay_trace() to play without waiting.
+ */
+#define PINS_REPLAY_MAX_SPEED 0
+
+/** Batch finished later than this after its trace time is counted late, microseconds.
+ */
+#ifndef PINS_REPLAY_LATE_US
+#define PINS_REPLAY_LATE_US 1000
+#endif
+
+/** Trace replay results.
+ */
+typedef struct PinsTraceReplayStats
+{
+    /** Number of records replayed, of which reads and writes. n_changes is number of read
+        records which changed pin value or state bits.
+     */
+    os_uint n_records;
+    os_uint n_reads;
+    os_uint n_writes;
+    os_uint n_changes;
+
+    /** Number of records skipped because pin index was not in configuration.
+     */
+    os_uint n_skipped;
+
+    /** Time span of the trace and wall clock time replay took, microseconds.
+     */
+    os_int64 trace_us;
+    os_int64 elapsed_us;
+
+    /** Achieved throughput, records per second.
+     */
+    os_uint records_per_s;
+
+    /** Processing time of one batch (records with same time stamp), microseconds.
+     */
+    os_uint n_batches;
+    os_uint max_batch_us;
+    os_int64 sum_batch_us;
+
+    /** Delay from batch's scheduled time to when it was processed, microseconds. Zero
+        when played at maximum speed. n_late counts batches later than PINS_REPLAY_LATE_US.
+     */
+    os_uint max_lag_us;
+    os_int64 sum_lag_us;
+    os_uint n_late;
+}
+PinsTraceReplayStats;
+
+/* Replay pin change trace file.
+ */
+osalStatus pins_replay_trace(
+    const IoPinsHdr *hdr,
+    const os_char *path,
+    os_int speed,
+    PinsTraceReplayStats *stats);
+
+#endif
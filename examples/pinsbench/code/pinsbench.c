@@ -0,0 +1,488 @@
+/**
+
+  @file    pins/examples/pinsbench/code/pinsbench.c
+  @brief   Benchmark for the core pins layer with large synthetic configurations.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Measures pins_setup(), pins_read_all(), pin_set_ext(), pin_get_prm() and forwarding pin
+  values to IOCOM with configuration generated by make_bench_config.py. One executable is
+  built for each configuration size, pinsbench100, pinsbench1000 and pinsbench10000, and
+  pinsbenchin1000 with 1000 digital inputs to compare bank reads to reading pin by pin.
+
+  Each measurement is repeated PINSBENCH_ROUNDS times and the fastest round is reported,
+  which gives numbers stable enough for regression tracking. Output is one line per
+  measurement: "pinsbench <config> <name> <ns per call> <ns per pin>".
+
+  Linux only, runs against the simulation backend.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pinsbench.h"
+#include <time.h>
+
+/* Here we include hardware specific IO code. The file name is always same, but
+   config/include/bench<n> is added to compiler's include paths.
+ */
+#include "pins_io.c"
+
+/* Number of rounds for each measurement, and how many pin operations to run per round.
+ */
+#define PINSBENCH_ROUNDS 7
+#define PINSBENCH_PIN_OPS 2000000
+
+/* IOCOM signals which generated pins point to, and memory block for these.
+ */
+bench_signals_t bench;
+static iocRoot bench_root;
+static iocHandle bench_exp;
+
+/* Number of pins in configuration and loop counter for current measurement.
+ */
+static os_int bench_n_pins;
+static os_int bench_loops;
+
+/* Result of bench_get_prm(), keeps compiler from optimizing the loop away.
+ */
+static volatile os_int bench_sink;
+
+#if PINS_PRM_SLOT_MAP && !PINS_COMPACT
+/* Pins with many parameters for comparing slot map to linear parameter search. Copies of
+   these pins have prm_slot cleared, so pin_get_prm() searches their parameter array as
+   with PINS_PRM_SLOT_MAP 0.
+ */
+#define PINSBENCH_MAX_PRM_PINS 32
+#define PINSBENCH_PRM_LOOKUPS 3
+static const Pin *bench_prm_pin[PINSBENCH_MAX_PRM_PINS];
+static Pin bench_prm_linear_pin[PINSBENCH_MAX_PRM_PINS];
+static os_int bench_n_prm_pins;
+#endif
+
+#if PINS_EDGE_CAPTURE && PINS_SIMULATED_INTERRUPTS && PINS_NAME_INDEX
+/* Pin with interrupt and capture ring for edge capture measurement. Number of edges
+   simulated per call before the ring is emptied.
+ */
+#define PINSBENCH_EDGES 64
+static const Pin *bench_edge_pin;
+static PinEdgeEvent bench_edge_buf[PINSBENCH_EDGES + 1], bench_edges[PINSBENCH_EDGES];
+static PinEdgeRing bench_edge_ring;
+#endif
+
+/* Forward referred static functions.
+ */
+static void bench_setup(void);
+static void bench_read_all(void);
+static void bench_read_per_pin(void);
+static void bench_set_ext(void);
+static void bench_get_prm(void);
+static void bench_to_iocom(void);
+#if PINS_PRM_SLOT_MAP && !PINS_COMPACT
+static void bench_setup_prm_pins(void);
+static void bench_get_prm_slot(void);
+static void bench_get_prm_linear(void);
+#endif
+#if PINS_EDGE_CAPTURE && PINS_SIMULATED_INTERRUPTS && PINS_NAME_INDEX
+static os_boolean bench_setup_edge_capture(void);
+static void bench_edge_capture(void);
+#endif
+
+static void bench_measure(
+    const os_char *name,
+    void (*func)(void),
+    os_int loops);
+
+static void bench_setup_iocom(void);
+
+/* If needed for the operating system, EOSAL_C_MAIN macro generates the actual C main() function.
+ */
+EOSAL_C_MAIN
+
+
+/**
+****************************************************************************************************
+
+  @brief Process entry point.
+
+  The osal_main() function sets up IO and IOCOM signals, runs all measurements and
+  functional checks.
+
+  @param   argc Number of command line arguments.
+  @param   argv Array of string pointers, one for each command line argument. UTF8 encoded.
+
+  @return  OSAL_SUCCESS if all good, OSAL_STATUS_FAILED if a functional check failed.
+
+****************************************************************************************************
+*/
+osalStatus osal_main(
+    os_int argc,
+    os_char *argv[])
+{
+    os_int loops;
+    osalStatus s;
+
+    bench_n_pins = pins_hdr.n_rv;
+    loops = PINSBENCH_PIN_OPS / bench_n_pins;
+    if (loops < 1) loops = 1;
+
+    bench_measure("setup", bench_setup, 10);
+    bench_measure("read_all", bench_read_all, loops);
+    bench_measure("read_per_pin", bench_read_per_pin, loops);
+    bench_measure("set_ext", bench_set_ext, loops);
+    bench_measure("get_prm", bench_get_prm, loops);
+#if PINS_PRM_SLOT_MAP && !PINS_COMPACT
+    bench_setup_prm_pins();
+    bench_measure("get_prm_slot", bench_get_prm_slot, loops);
+    bench_measure("get_prm_linear", bench_get_prm_linear, loops);
+#endif
+#if PINS_EDGE_CAPTURE && PINS_SIMULATED_INTERRUPTS && PINS_NAME_INDEX
+    if (bench_setup_edge_capture()) {
+        bench_measure("edge_capture", bench_edge_capture, PINSBENCH_PIN_OPS / PINSBENCH_EDGES);
+        pin_gpio_detach_interrupt(bench_edge_pin);
+    }
+#endif
+
+    s = bench_run_checks();
+
+    bench_setup_iocom();
+    bench_measure("to_iocom", bench_to_iocom, loops);
+
+    ioc_release_root(&bench_root);
+    return s;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Loop function, not used by benchmark.
+
+****************************************************************************************************
+*/
+osalStatus osal_loop(
+    void *app_context)
+{
+    return OSAL_END_OF_FILE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Finished with the application, clean up.
+
+****************************************************************************************************
+*/
+void osal_main_cleanup(
+    void *app_context)
+{
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Run measurement and print the result.
+  @anchor bench_measure
+
+  The bench_measure() function runs func PINSBENCH_ROUNDS times, each round calling it
+  loops times, and prints time per call and per pin of the fastest round.
+
+  @param   name Measurement name to print.
+  @param   func Function to measure.
+  @param   loops How many times to call func per round.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void bench_measure(
+    const os_char *name,
+    void (*func)(void),
+    os_int loops)
+{
+    struct timespec t0, t1;
+    os_int64 ns, best_ns = -1;
+    os_int round, i;
+    os_char buf[128], nbuf[OSAL_NBUF_SZ];
+
+    for (round = 0; round < PINSBENCH_ROUNDS; round++)
+    {
+        clock_gettime(CLOCK_MONOTONIC, &t0);
+        for (i = 0; i < loops; i++) {
+            bench_loops = i;
+            func();
+        }
+        clock_gettime(CLOCK_MONOTONIC, &t1);
+
+        ns = (os_int64)(t1.tv_sec - t0.tv_sec) * 1000000000 + (t1.tv_nsec - t0.tv_nsec);
+        if (ns < best_ns || best_ns < 0) best_ns = ns;
+    }
+
+    ns = best_ns / loops;
+    os_strncpy(buf, "pinsbench ", sizeof(buf));
+    os_strncat(buf, BENCH_CONFIG_NAME, sizeof(buf));
+    os_strncat(buf, " ", sizeof(buf));
+    os_strncat(buf, name, sizeof(buf));
+    os_strncat(buf, " ", sizeof(buf));
+    osal_int_to_str(nbuf, sizeof(nbuf), ns);
+    os_strncat(buf, nbuf, sizeof(buf));
+    os_strncat(buf, " ", sizeof(buf));
+    osal_double_to_str(nbuf, sizeof(nbuf), (os_double)ns / bench_n_pins, 2, OSAL_FLOAT_DEFAULT);
+    os_strncat(buf, nbuf, sizeof(buf));
+    os_strncat(buf, "\n", sizeof(buf));
+    osal_console_write(buf);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Set up IOCOM memory block and signals for the generated pins.
+  @anchor bench_setup_iocom
+
+  In IOCOM application signals_to_c.py generates the signal structure. Here all signals are
+  "int" in one "exp" memory block, laid out one after another, and set up at run time.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+static void bench_setup_iocom(void)
+{
+    iocMemoryBlockParams blockprm;
+    iocSignal *sig;
+    os_int i;
+
+    ioc_initialize_root(&bench_root, IOC_CREATE_OWN_MUTEX);
+
+    os_memclear(&blockprm, sizeof(blockprm));
+    blockprm.device_name = "bench";
+    blockprm.device_nr = 1;
+    blockprm.mblk_name = "exp";
+    blockprm.nbytes = BENCH_N_SIGNALS * (sizeof(os_int) + 1);
+    blockprm.flags = IOC_MBLK_UP;
+    ioc_initialize_memory_block(&bench_exp, OS_NULL, &bench_root, &blockprm);
+
+    sig = (iocSignal*)&bench.exp;
+    for (i = 0; i < BENCH_N_SIGNALS; i++, sig++)
+    {
+        sig->addr = i * (os_int)(sizeof(os_int) + 1);
+        sig->n = 1;
+        sig->flags = OS_INT;
+        sig->handle = &bench_exp;
+    }
+
+    pins_connect_iocom_library(&pins_hdr);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Measured operations.
+
+  bench_setup: Set up all pins, including simulated bus devices.
+  bench_read_all: Read all inputs, IOCOM not connected.
+  bench_read_per_pin: Read all inputs one by one with pin_get_ext(), without GPIO bank
+      snapshot. Baseline for read_all as with PINS_BANK_IO 0.
+  bench_set_ext: Write every output, analog output and PWM pin.
+  bench_get_prm: Get "max" parameter of every pin.
+  bench_get_prm_slot: Get last parameters of pins with 10 - 20 parameters, trough slot map.
+  bench_get_prm_linear: Same as bench_get_prm_slot, but by searching the parameter array.
+  bench_to_iocom: Read all pins and forward every value to IOCOM (PINS_RESET_IOCOM).
+  bench_edge_capture: Simulate PINSBENCH_EDGES interrupts on pin with capture ring and
+      move captured edges from the ring.
+
+****************************************************************************************************
+*/
+static void bench_setup(void)
+{
+    pins_setup(&pins_hdr, PINS_DEFAULT);
+}
+
+static void bench_read_all(void)
+{
+    pins_read_all(&pins_hdr, PINS_DEFAULT);
+}
+
+static void bench_read_per_pin(void)
+{
+    const PinGroupHdr *group;
+    const Pin *pin;
+    os_short i, j;
+    os_char type, state_bits;
+
+    for (i = 0; i < pins_hdr.n_groups; i++)
+    {
+        group = pins_hdr.group[i];
+        pin = group->pin;
+        type = pin->type;
+        if (type != PIN_INPUT && type != PIN_ANALOG_INPUT) continue;
+
+        for (j = 0; j < group->n_pins; j++, pin++) {
+            pin_get_ext(pin, &state_bits);
+        }
+    }
+}
+
+static void bench_set_ext(void)
+{
+    const PinGroupHdr *group;
+    const Pin *pin;
+    os_short i, j;
+    os_char type;
+
+    for (i = 0; i < pins_hdr.n_groups; i++)
+    {
+        group = pins_hdr.group[i];
+        pin = group->pin;
+        type = pin->type;
+        if (type != PIN_OUTPUT && type != PIN_ANALOG_OUTPUT && type != PIN_PWM) continue;
+
+        for (j = 0; j < group->n_pins; j++, pin++) {
+            pin_set_ext(pin, (bench_loops + j) & 0xFFF, PINS_DEFAULT);
+        }
+    }
+}
+
+static void bench_get_prm(void)
+{
+    const PinGroupHdr *group;
+    const Pin *pin;
+    os_short i, j;
+    os_int sum = 0;
+
+    for (i = 0; i < pins_hdr.n_groups; i++)
+    {
+        group = pins_hdr.group[i];
+        pin = group->pin;
+        for (j = 0; j < group->n_pins; j++, pin++) {
+            sum += pin_get_prm(pin, PIN_MAX);
+        }
+    }
+
+    bench_sink = sum;
+}
+
+static void bench_to_iocom(void)
+{
+    pins_read_all(&pins_hdr, PINS_RESET_IOCOM);
+}
+
+#if PINS_PRM_SLOT_MAP && !PINS_COMPACT
+static void bench_get_prm_slot(void)
+{
+    const Pin *pin;
+    os_int i, k, sum = 0;
+
+    for (i = 0; i < bench_n_prm_pins; i++)
+    {
+        pin = bench_prm_pin[i];
+        for (k = 1; k <= PINSBENCH_PRM_LOOKUPS; k++) {
+            sum += pin_get_prm(pin, (pinPrm)pin->prm[pin->prm_n - k].ix);
+        }
+    }
+
+    bench_sink = sum;
+}
+
+static void bench_get_prm_linear(void)
+{
+    const Pin *pin;
+    os_int i, k, sum = 0;
+
+    for (i = 0; i < bench_n_prm_pins; i++)
+    {
+        pin = bench_prm_linear_pin + i;
+        for (k = 1; k <= PINSBENCH_PRM_LOOKUPS; k++) {
+            sum += pin_get_prm(pin, (pinPrm)pin->prm[pin->prm_n - k].ix);
+        }
+    }
+
+    bench_sink = sum;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Collect pins with many parameters for get_prm_slot and get_prm_linear.
+  @anchor bench_setup_prm_pins
+
+  Pins with at least 10 parameters and a slot map are collected, and a copy of each with
+  slot map cleared is made for linear search. Parameters looked up are the last ones in
+  pin's parameter array, worst case for linear search.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+static void bench_setup_prm_pins(void)
+{
+    const PinGroupHdr *group;
+    const Pin *pin;
+    os_short i, j;
+
+    bench_n_prm_pins = 0;
+    for (i = 0; i < pins_hdr.n_groups; i++)
+    {
+        group = pins_hdr.group[i];
+        pin = group->pin;
+        for (j = 0; j < group->n_pins; j++, pin++)
+        {
+            if (pin->prm_n < 10 || pin->prm_slot == OS_NULL) continue;
+            if (bench_n_prm_pins >= PINSBENCH_MAX_PRM_PINS) return;
+
+            bench_prm_pin[bench_n_prm_pins] = pin;
+            bench_prm_linear_pin[bench_n_prm_pins] = *pin;
+            bench_prm_linear_pin[bench_n_prm_pins].prm_slot = OS_NULL;
+            bench_n_prm_pins++;
+        }
+    }
+}
+#endif
+
+#if PINS_EDGE_CAPTURE && PINS_SIMULATED_INTERRUPTS && PINS_NAME_INDEX
+static void bench_edge_capture(void)
+{
+    os_int i;
+
+    for (i = 0; i < PINSBENCH_EDGES; i++) {
+        pin_gpio_simulate_interrupt(bench_edge_pin, i & 1);
+    }
+
+    bench_sink = pins_get_edges(&bench_edge_ring, bench_edges, PINSBENCH_EDGES);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Attach capture ring to "edgedi" input for edge_capture measurement.
+  @anchor bench_setup_edge_capture
+
+  @return  OS_TRUE if configuration has "edgedi" pin and capture ring was attached.
+
+****************************************************************************************************
+*/
+static os_boolean bench_setup_edge_capture(void)
+{
+    pinInterruptParams prm;
+
+    bench_edge_pin = pins_find_by_name(&pins_hdr, "inputs.edgedi");
+    if (bench_edge_pin == OS_NULL) return OS_FALSE;
+
+    bench_edge_ring.buf = bench_edge_buf;
+    bench_edge_ring.buf_sz = PINSBENCH_EDGES + 1;
+    os_memclear(&prm, sizeof(prm));
+    prm.flags = PINS_INT_CHANGE;
+    prm.capture = &bench_edge_ring;
+    pin_gpio_attach_interrupt(bench_edge_pin, &prm);
+    return OS_TRUE;
+}
+#endif
@@ -0,0 +1,32 @@
+/**
+
+  @file    pins/examples/pinsbench/code/pinsbench.h
+  @brief   Benchmark for the core pins layer with large synthetic configurations.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#ifndef PINSBENCH_INCLUDED
+#define PINSBENCH_INCLUDED
+
+/* Include header for the pins library. This includes also eosalx.h
+ */
+#include "pinsx.h"
+
+/* Include generated signal structure and io definitions for "bench<n>" hardware.
+ */
+#include "bench_signals.h"
+#include "pins_io.h"
+
+/* Run functional checks, pinsbench_checks.c.
+ */
+osalStatus bench_run_checks(void);
+
+#endif
@@ -0,0 +1,670 @@
+/**
+
+  @file    pins/examples/pinsbench/code/pinsbench_checks.c
+  @brief   Functional checks run by pinsbench.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Checks which need the simulation backend and a configuration with many pins, so they are
+  run by pinsbench against the generated bench configuration. Each check prints one line:
+  "pinsbench <config> <name> ok" or "pinsbench <config> <name> FAILED". Checks which need
+  pins missing from the configuration, like in "in1000" configuration, are skipped.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pinsbench.h"
+
+/* Checks find pins by name, so these need generated name index.
+ */
+#define PINSBENCH_CHECK_SAMPLING (PINS_SAMPLING && PINS_NAME_INDEX)
+
+#define PINSBENCH_CHECK_EDGES (PINS_EDGE_CAPTURE && PINS_SIMULATED_INTERRUPTS && PINS_NAME_INDEX)
+#define PINSBENCH_CHECK_DEVICEBUS (OSAL_MULTITHREAD_SUPPORT && (PINS_SPI || PINS_I2C))
+#define PINSBENCH_CHECK_JSON_CONFIG (PINS_JSON_CONFIG && OSAL_JSON_TEXT_SUPPORT && PINS_SPI)
+#define PINSBENCH_CHECK_RECONFIGURE (PINS_JSON_CONFIG && OSAL_JSON_TEXT_SUPPORT)
+
+/* How long to run time based checks, ms.
+ */
+#define PINSBENCH_CHECK_MS 300
+
+/* Set to OS_FALSE by bench_report_check() if any check fails.
+ */
+static os_boolean bench_checks_ok;
+
+/* Forward referred static functions.
+ */
+static void bench_report_check(
+    const os_char *name,
+    os_boolean ok);
+
+#if PINSBENCH_CHECK_SAMPLING
+static void bench_check_sampling(void);
+#endif
+
+#if PINSBENCH_CHECK_EDGES
+static void bench_check_edge_capture(void);
+#endif
+
+#if PINSBENCH_CHECK_DEVICEBUS
+/* Value pair published by writer thread trough device sequence lock, b is always ~a.
+ */
+typedef struct BenchSeqPair
+{
+    PinsBusDevice device;
+    volatile os_int a;
+    volatile os_int b;
+    volatile os_int n_writes;
+    volatile os_boolean stop;
+}
+BenchSeqPair;
+
+static void bench_check_devicebus(void);
+
+static void bench_seq_writer_thread(
+    void *prm,
+    osalEvent done);
+#endif
+
+#if PINSBENCH_CHECK_JSON_CONFIG
+static void bench_check_json_config(void);
+#endif
+
+#if PINSBENCH_CHECK_RECONFIGURE
+static void bench_check_reconfigure(void);
+
+static const PinRV *bench_json_rv(
+    const PinsJsonConfig *config,
+    const os_char *name,
+    os_boolean *reinit);
+
+#if PINS_SIMULATED_INTERRUPTS
+static void bench_reconf_int_handler(void);
+#endif
+#endif
+
+
+/**
+****************************************************************************************************
+
+  @brief Run all functional checks.
+  @anchor bench_run_checks
+
+  The bench_run_checks() function runs checks supported by the build and the configuration.
+  Called by osal_main() after measurements, before IOCOM is connected.
+
+  @return  OSAL_SUCCESS if all checks passed, OSAL_STATUS_FAILED if any check failed.
+
+****************************************************************************************************
+*/
+osalStatus bench_run_checks(void)
+{
+    bench_checks_ok = OS_TRUE;
+
+#if PINSBENCH_CHECK_SAMPLING
+    bench_check_sampling();
+#endif
+#if PINSBENCH_CHECK_EDGES
+    bench_check_edge_capture();
+#endif
+#if PINSBENCH_CHECK_DEVICEBUS
+    bench_check_devicebus();
+#endif
+#if PINSBENCH_CHECK_JSON_CONFIG
+    bench_check_json_config();
+#endif
+#if PINSBENCH_CHECK_RECONFIGURE
+    bench_check_reconfigure();
+#endif
+
+    return bench_checks_ok ? OSAL_SUCCESS : OSAL_STATUS_FAILED;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Print result of a check.
+  @anchor bench_report_check
+
+  @param   name Check name to print.
+  @param   ok OS_TRUE if check passed.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void bench_report_check(
+    const os_char *name,
+    os_boolean ok)
+{
+    os_char buf[128];
+
+    os_strncpy(buf, "pinsbench ", sizeof(buf));
+    os_strncat(buf, BENCH_CONFIG_NAME, sizeof(buf));
+    os_strncat(buf, " ", sizeof(buf));
+    os_strncat(buf, name, sizeof(buf));
+    os_strncat(buf, ok ? " ok\n" : " FAILED\n", sizeof(buf));
+    osal_console_write(buf);
+
+    if (!ok) bench_checks_ok = OS_FALSE;
+}
+
+
+#if PINSBENCH_CHECK_SAMPLING
+/**
+****************************************************************************************************
+
+  @brief Check timer driven sampling into ring buffers.
+  @anchor bench_check_sampling
+
+  The "sampleai" analog input returns constant 1234 and "sampletim" timer runs at 1 kHz,
+  simulated timer interrupts are triggered by pins_read_all(). Two channels sample the
+  same input, one storing every sample and one averaging 4 samples into one (boxcar
+  decimation). While the consumer keeps up, no samples may be lost, the decimated channel
+  must get exactly one sample for every 4 samples of the other, and all sample values must
+  be 1234. Then the consumer stops reading: Samples are dropped and counted, and the ring
+  buffer holds buf_sz - 1 samples. Channel without pin must be rejected.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+static void bench_check_sampling(void)
+{
+    PinsSampler sampler;
+    PinsSampleChannel channel[2];
+    os_int buf0[64], buf1[16], samples[64];
+    os_int n, i, count[2];
+    os_timer start_t;
+    os_short ch;
+    os_boolean ok;
+
+    os_memclear(&sampler, sizeof(sampler));
+    os_memclear(channel, sizeof(channel));
+    sampler.timer_pin = pins_find_by_name(&pins_hdr, "timers.sampletim");
+    channel[0].pin = pins_find_by_name(&pins_hdr, "analog_inputs.sampleai");
+    if (sampler.timer_pin == OS_NULL || channel[0].pin == OS_NULL) return;
+
+    channel[0].buf = buf0;
+    channel[0].buf_sz = sizeof(buf0) / sizeof(os_int);
+    channel[1].buf = buf1;
+    channel[1].buf_sz = sizeof(buf1) / sizeof(os_int);
+    channel[1].decimation = 4;
+    sampler.channel = channel;
+    sampler.n_channels = 2;
+
+    /* Unconfigured channel must be rejected, not crash.
+     */
+    ok = (os_boolean)(pins_start_sampling(&sampler) == OSAL_STATUS_FAILED);
+    channel[1].pin = channel[0].pin;
+
+    /* Consumer keeps up.
+     */
+    count[0] = count[1] = 0;
+    if (pins_start_sampling(&sampler)) ok = OS_FALSE;
+    os_get_timer(&start_t);
+    while (!os_has_elapsed(&start_t, PINSBENCH_CHECK_MS))
+    {
+        pins_read_all(&pins_hdr, PINS_DEFAULT);
+        for (ch = 0; ch < 2; ch++)
+        {
+            n = pins_get_samples(channel + ch, samples, sizeof(samples) / sizeof(os_int));
+            for (i = 0; i < n; i++) {
+                if (samples[i] != 1234) ok = OS_FALSE;
+            }
+            count[ch] += n;
+        }
+    }
+    pins_stop_sampling(&sampler);
+
+    for (ch = 0; ch < 2; ch++) {
+        count[ch] += pins_get_samples(channel + ch, samples, sizeof(samples) / sizeof(os_int));
+        if (channel[ch].overflow_count) ok = OS_FALSE;
+    }
+    if (count[0] < 4 || count[1] != count[0] / 4) ok = OS_FALSE;
+
+    /* Consumer doesn't read, ring buffer fills up.
+     */
+    if (pins_start_sampling(&sampler)) ok = OS_FALSE;
+    os_get_timer(&start_t);
+    while (channel[0].overflow_count == 0 && !os_has_elapsed(&start_t, 10 * PINSBENCH_CHECK_MS)) {
+        pins_read_all(&pins_hdr, PINS_DEFAULT);
+    }
+    pins_stop_sampling(&sampler);
+
+    if (channel[0].overflow_count == 0 ||
+        pins_get_sample_count(channel) != channel[0].buf_sz - 1)
+    {
+        ok = OS_FALSE;
+    }
+
+    bench_report_check("sampling", ok);
+}
+#endif
+
+
+#if PINSBENCH_CHECK_EDGES
+/**
+****************************************************************************************************
+
+  @brief Check edge capture ring with simulated GPIO interrupts.
+  @anchor bench_check_edge_capture
+
+  The bench_check_edge_capture() function simulates 10000 alternating edges on "edgedi"
+  input, emptying the capture ring every 8 edges. Every edge must be captured in order,
+  with correct pin, state and non decreasing timestamps. Without emptying, the ring must
+  hold buf_sz - 1 edges and count the dropped ones. With PINS_INT_RISING only every
+  other edge is captured.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+static void bench_check_edge_capture(void)
+{
+    const Pin *pin;
+    pinInterruptParams prm;
+    PinEdgeRing ring;
+    PinEdgeEvent buf[16], events[16];
+    os_int64 prev_t;
+    os_int i, j, n, count;
+    os_boolean ok;
+
+    pin = pins_find_by_name(&pins_hdr, "inputs.edgedi");
+    if (pin == OS_NULL) return;
+
+    os_memclear(&ring, sizeof(ring));
+    ring.buf = buf;
+    ring.buf_sz = sizeof(buf) / sizeof(PinEdgeEvent);
+    os_memclear(&prm, sizeof(prm));
+    prm.flags = PINS_INT_CHANGE;
+    prm.capture = &ring;
+    pin_gpio_attach_interrupt(pin, &prm);
+
+    /* Consumer keeps up.
+     */
+    ok = OS_TRUE;
+    count = 0;
+    prev_t = 0;
+    for (i = 0; i < 10000; i++)
+    {
+        pin_gpio_simulate_interrupt(pin, i & 1);
+        if ((i & 7) != 7) continue;
+
+        n = pins_get_edges(&ring, events, sizeof(events) / sizeof(PinEdgeEvent));
+        for (j = 0; j < n; j++, count++)
+        {
+            if (events[j].pin != pin || events[j].x != (count & 1) ||
+                events[j].timestamp < prev_t)
+            {
+                ok = OS_FALSE;
+            }
+            prev_t = events[j].timestamp;
+        }
+    }
+    if (count != 10000 || ring.overflow_count) ok = OS_FALSE;
+
+    /* Consumer doesn't read.
+     */
+    for (i = 0; i < 20; i++) {
+        pin_gpio_simulate_interrupt(pin, i & 1);
+    }
+    if (pins_get_edge_count(&ring) != ring.buf_sz - 1 ||
+        ring.overflow_count != 20 - (ring.buf_sz - 1))
+    {
+        ok = OS_FALSE;
+    }
+    pin_gpio_detach_interrupt(pin);
+
+    /* Rising edges only.
+     */
+    prm.flags = PINS_INT_RISING;
+    pin_gpio_attach_interrupt(pin, &prm);
+    for (i = 0; i < 10; i++) {
+        pin_gpio_simulate_interrupt(pin, i & 1);
+    }
+    if (pins_get_edge_count(&ring) != 5) ok = OS_FALSE;
+    pin_gpio_detach_interrupt(pin);
+
+    bench_report_check("edge_capture", ok);
+}
+#endif
+
+
+#if PINSBENCH_CHECK_DEVICEBUS
+/**
+****************************************************************************************************
+
+  @brief Stress sequence lock between devicebus threads and the main loop.
+  @anchor bench_check_devicebus
+
+  The bench_check_devicebus() function starts simulated multithread devicebus, so SPI and I2C
+  drivers publish values from their own threads while main loop reads them by
+  pins_read_all(). Meanwhile writer thread publishes value pair a, ~a trough a device
+  sequence lock as fast as it can, and the main loop reads the pair like drivers' get
+  functions do. Any pair where b is not ~a is a torn read and fails the check.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+static void bench_check_devicebus(void)
+{
+    static BenchSeqPair pair;
+    osalThread *writer;
+    os_timer start_t;
+    os_int a, b, n_reads, n_torn;
+    os_uint seq;
+
+    os_memclear(&pair, sizeof(pair));
+    pair.b = ~0;
+    pins_start_multithread_devicebus(0);
+    writer = osal_thread_create(bench_seq_writer_thread, &pair, OS_NULL, OSAL_THREAD_ATTACHED);
+
+    n_reads = n_torn = 0;
+    os_get_timer(&start_t);
+    while (!os_has_elapsed(&start_t, PINSBENCH_CHECK_MS))
+    {
+        do {
+            seq = PINS_DEVICE_READ_BEGIN(&pair.device);
+            a = pair.a;
+            b = pair.b;
+        }
+        while (PINS_DEVICE_READ_RETRY(&pair.device, seq));
+
+        if (b != ~a) n_torn++;
+        if ((++n_reads & 1023) == 0) {
+            pins_read_all(&pins_hdr, PINS_DEFAULT);
+        }
+    }
+
+    pair.stop = OS_TRUE;
+    osal_thread_join(writer);
+    pins_stop_multithread_devicebus();
+
+    bench_report_check("devicebus_seqlock", (os_boolean)(n_torn == 0 &&
+        n_reads > 0 && pair.n_writes > 0));
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Writer thread for bench_check_devicebus().
+  @anchor bench_seq_writer_thread
+
+  Publishes value pair a, ~a with increasing a until stopped, like a devicebus driver
+  publishes values it has received.
+
+  @param   prm Pointer to BenchSeqPair.
+  @param   done Event to set when the thread has started.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void bench_seq_writer_thread(
+    void *prm,
+    osalEvent done)
+{
+    BenchSeqPair *pair;
+    os_int x;
+
+    pair = (BenchSeqPair*)prm;
+    osal_event_set(done);
+
+    x = 0;
+    while (!pair->stop)
+    {
+        x++;
+        PINS_DEVICE_WRITE_BEGIN(&pair->device);
+        pair->a = x;
+        pair->b = ~x;
+        PINS_DEVICE_WRITE_END(&pair->device);
+        pair->n_writes = x;
+    }
+}
+#endif
+
+
+#if PINSBENCH_CHECK_JSON_CONFIG
+/* SPI ADC with long name and three analog inputs bound to it by "device" attribute.
+ */
+#define BENCH_JSON_ADC "spi.adc_with_long_name_to_use_up_string_space"
+
+PINS_BUS_DRIVER_DECL(mcp3208)
+
+static const os_char bench_json_config[] =
+    "{\"io\": [{\"name\": \"jsonchk\", \"groups\": ["
+    "{\"name\": \"spi\", \"pins\": [{\"name\": \"adc_with_long_name_to_use_up_string_space\", "
+    "\"driver\": \"mcp3208\", \"bank\": 0, \"addr\": 0, \"miso\": 9, \"mosi\": 10, "
+    "\"sclk\": 11, \"cs\": 8}]}, "
+    "{\"name\": \"analog_inputs\", \"pins\": ["
+    "{\"name\": \"jsonai0\", \"device\": \"" BENCH_JSON_ADC "\", \"addr\": 0}, "
+    "{\"name\": \"jsonai1\", \"device\": \"" BENCH_JSON_ADC "\", \"addr\": 1}, "
+    "{\"name\": \"jsonai2\", \"device\": \"" BENCH_JSON_ADC "\", \"addr\": 2}]}]}]}";
+
+/**
+****************************************************************************************************
+
+  @brief Check loading pin configuration with device bound pins from JSON.
+  @anchor bench_check_json_config
+
+  Loads configuration where analog inputs are bound to SPI device by "device" attribute.
+  Device references are copied into the loader's string space, so the load must succeed
+  and every input must be linked to the device. Configuration is not set up, only loaded.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+static void bench_check_json_config(void)
+{
+    static const PinsBusDriver drivers[] = {PINS_BUS_DRIVER(mcp3208)};
+    static const os_char *names[] = {"analog_inputs.jsonai0", "analog_inputs.jsonai1",
+        "analog_inputs.jsonai2"};
+    PinsJsonConfig *config;
+    const Pin *adc, *pin;
+    os_int i;
+    os_boolean ok;
+
+    if (pins_load_json_config_text(&config, bench_json_config, OS_NULL, drivers, 1))
+    {
+        bench_report_check("json_config", OS_FALSE);
+        return;
+    }
+
+    adc = pins_find_json_pin(config, BENCH_JSON_ADC);
+    ok = (os_boolean)(adc != OS_NULL && config->n_devices == 1 && config->n_pins == 4 &&
+        config->device->device_pin == adc);
+    for (i = 0; i < 3 && ok; i++)
+    {
+        pin = pins_find_json_pin(config, names[i]);
+        if (pin == OS_NULL || PIN_BUS_DEVICE(pin) != config->device) {
+            ok = OS_FALSE;
+        }
+    }
+
+    pins_free_json_config(config);
+    bench_report_check("json_config", ok);
+}
+#endif
+
+
+#if PINSBENCH_CHECK_RECONFIGURE
+/* Running configuration and modified one to switch to: "keep" is unchanged, "moved" gets
+   new address, "soft" changes only parameters used by software, "gone" is removed, "retyped"
+   moves from outputs to inputs and "added" is new. "intkeep" is unchanged input with
+   interrupt.
+ */
+#if PINS_SIMULATED_INTERRUPTS
+/* Number of calls to bench_reconf_int_handler().
+ */
+static volatile os_int bench_reconf_int_count;
+#endif
+
+static const os_char bench_reconf_old[] =
+    "{\"io\": [{\"name\": \"reconf\", \"groups\": ["
+    "{\"name\": \"inputs\", \"pins\": [{\"name\": \"keep\", \"addr\": 1}, "
+    "{\"name\": \"gone\", \"addr\": 2}, {\"name\": \"moved\", \"addr\": 3}, "
+    "{\"name\": \"intkeep\", \"addr\": 7, \"interrupt\": 1}]}, "
+    "{\"name\": \"analog_inputs\", \"pins\": [{\"name\": \"soft\", \"addr\": 0, "
+    "\"max\": 100, \"iir\": 2}]}, "
+    "{\"name\": \"outputs\", \"pins\": [{\"name\": \"retyped\", \"addr\": 5}]}]}]}";
+
+static const os_char bench_reconf_new[] =
+    "{\"io\": [{\"name\": \"reconf\", \"groups\": ["
+    "{\"name\": \"inputs\", \"pins\": [{\"name\": \"keep\", \"addr\": 1}, "
+    "{\"name\": \"moved\", \"addr\": 4}, {\"name\": \"retyped\", \"addr\": 5}, "
+    "{\"name\": \"added\", \"addr\": 6}, "
+    "{\"name\": \"intkeep\", \"addr\": 7, \"interrupt\": 1}]}, "
+    "{\"name\": \"analog_inputs\", \"pins\": [{\"name\": \"soft\", \"addr\": 0, "
+    "\"max\": 200, \"smin\": 0, \"smax\": 1000, \"iir\": 3, \"avg\": 4, "
+    "\"debounce-ms\": 10}]}]}]}";
+
+/**
+****************************************************************************************************
+
+  @brief Check switching to modified JSON configuration.
+  @anchor bench_check_reconfigure
+
+  Pins are matched by name, so values of "keep", "moved" and "soft" must be carried over.
+  Only "moved", "retyped" and "added" may be flagged as set up again: Parameters from
+  PIN_MIN to PIN_DEBOUNCE are used only by software and pin which changed type is removed
+  and added. Interrupt handler attached to "intkeep" must still be called after the switch.
+  Statistics, history and device bus are pointed back to bench configuration afterwards.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+static void bench_check_reconfigure(void)
+{
+    PinsJsonConfig *running, *next;
+    const PinRV *rv;
+    os_boolean ok, reinit;
+#if PINS_SIMULATED_INTERRUPTS
+    pinInterruptParams prm;
+    const Pin *pin;
+#endif
+#if PINS_SPI || PINS_I2C
+    PinsBus *first_bus, *current_bus;
+#endif
+
+    if (pins_load_json_config_text(&running, bench_reconf_old, OS_NULL, OS_NULL, 0))
+    {
+        bench_report_check("reconfigure", OS_FALSE);
+        return;
+    }
+    if (pins_load_json_config_text(&next, bench_reconf_new, OS_NULL, OS_NULL, 0))
+    {
+        pins_free_json_config(running);
+        bench_report_check("reconfigure", OS_FALSE);
+        return;
+    }
+
+    PIN_RV(pins_find_json_pin(running, "inputs.keep"))->value = 1;
+    PIN_RV(pins_find_json_pin(running, "inputs.moved"))->value = 1;
+    PIN_RV(pins_find_json_pin(running, "analog_inputs.soft"))->value = 77;
+    PIN_RV(pins_find_json_pin(running, "outputs.retyped"))->value = 1;
+
+#if PINS_SIMULATED_INTERRUPTS
+    os_memclear(&prm, sizeof(prm));
+    prm.int_handler_func = bench_reconf_int_handler;
+    prm.flags = PINS_INT_CHANGE;
+    pin_gpio_attach_interrupt(pins_find_json_pin(running, "inputs.intkeep"), &prm);
+    bench_reconf_int_count = 0;
+#endif
+
+#if PINS_SPI || PINS_I2C
+    first_bus = pins_devicebus.first_bus;
+    current_bus = pins_devicebus.current_bus;
+#endif
+    ok = (os_boolean)(pins_reconfigure_json_config(running, next) == OSAL_SUCCESS);
+#if PINS_SPI || PINS_I2C
+    pins_devicebus.first_bus = first_bus;
+    pins_devicebus.current_bus = current_bus;
+#endif
+#if PINS_STATISTICS
+    pins_setup_stats(&pins_hdr);
+#endif
+#if PINS_HISTORY
+    pins_setup_history(&pins_hdr);
+#endif
+
+    rv = bench_json_rv(next, "inputs.keep", &reinit);
+    if (rv == OS_NULL || rv->value != 1 || reinit) ok = OS_FALSE;
+    rv = bench_json_rv(next, "inputs.moved", &reinit);
+    if (rv == OS_NULL || rv->value != 1 || !reinit) ok = OS_FALSE;
+    rv = bench_json_rv(next, "analog_inputs.soft", &reinit);
+    if (rv == OS_NULL || rv->value != 77 || reinit) ok = OS_FALSE;
+    rv = bench_json_rv(next, "inputs.retyped", &reinit);
+    if (rv == OS_NULL || rv->value != 0 || !reinit) ok = OS_FALSE;
+    rv = bench_json_rv(next, "inputs.added", &reinit);
+    if (rv == OS_NULL || !reinit) ok = OS_FALSE;
+    rv = bench_json_rv(next, "inputs.intkeep", &reinit);
+    if (rv == OS_NULL || reinit) ok = OS_FALSE;
+
+#if PINS_SIMULATED_INTERRUPTS
+    pin = pins_find_json_pin(next, "inputs.intkeep");
+    if (pin) {
+        pin_gpio_simulate_interrupt(pin, 1);
+    }
+    if (bench_reconf_int_count != 1) ok = OS_FALSE;
+#endif
+
+    pins_free_json_config(running);
+    pins_free_json_config(next);
+    bench_report_check("reconfigure", ok);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get pin value and reinit flag of loaded JSON configuration's pin.
+  @anchor bench_json_rv
+
+  @param   config Loaded configuration.
+  @param   name Pin name, "group.pin".
+  @param   reinit Where to store OS_TRUE if pin was flagged as set up again.
+  @return  Pointer to pin value and state bits, OS_NULL if pin was not found.
+
+****************************************************************************************************
+*/
+static const PinRV *bench_json_rv(
+    const PinsJsonConfig *config,
+    const os_char *name,
+    os_boolean *reinit)
+{
+    const Pin *pin;
+
+    *reinit = OS_FALSE;
+    pin = pins_find_json_pin(config, name);
+    if (pin == OS_NULL) return OS_NULL;
+    *reinit = (os_boolean)(config->reinit[pin - config->pin] != 0);
+    return PIN_RV(pin);
+}
+
+
+#if PINS_SIMULATED_INTERRUPTS
+/**
+****************************************************************************************************
+
+  @brief Interrupt handler attached to "intkeep" pin by reconfigure check.
+  @anchor bench_reconf_int_handler
+
+  @return  None.
+
+****************************************************************************************************
+*/
+static void bench_reconf_int_handler(void)
+{
+    bench_reconf_int_count++;
+}
+#endif
+#endif
@@ -0,0 +1,147 @@
+#!/usr/bin/env python3
+# make_bench_config.py 26.4.2021/pekka
+# Generates synthetic pins and signals JSON configurations for pinsbench, with given number of
+# pins spread over all pin types, and runs pins_to_c.py to convert these to C code. Size
+# prefixed with "in", like in1000, generates configuration with only digital inputs.
+# Usage: make_bench_config.py <n_pins> [<n_pins> ...] [-o <config root>]
+import json
+import os
+import subprocess
+import sys
+
+def bench_pins(n_pins):
+    # Fixed set of simulated bus devices: two 8 channel SPI ADCs and one 16 channel I2C PWM.
+    spi = [{"name": "adc" + str(d), "driver": "mcp3208", "bank": 0, "addr": d,
+        "miso": 9, "mosi": 10, "sclk": 11, "cs": 8 - d, "frequency-kHz": 1000, "flags": 3}
+        for d in range(2)]
+    i2c = [{"name": "pwmdev", "driver": "pca9685", "bank": 0, "addr": 64,
+        "sda": 2, "scl": 3, "frequency": 50}]
+
+    groups = {"inputs": [], "outputs": [], "analog_inputs": [], "analog_outputs": [],
+        "pwm": [], "timers": []}
+
+    for ch in range(16):
+        groups["analog_inputs"].append({"name": "busai" + str(ch),
+            "device": "spi.adc" + str(ch // 8), "addr": ch % 8, "max": 4095})
+        groups["pwm"].append({"name": "buspwm" + str(ch),
+            "device": "i2c.pwmdev", "addr": ch, "init": 0})
+
+    # Analog outputs with 10 to 20 parameters each, for comparing parameter lookup trough
+    # slot map to linear search of the parameter array.
+    many_prms = ["min", "max", "resolution", "frequency", "hpoint", "speed", "flags",
+        "pin-a", "pin-b", "pin-c", "pin-d", "pin-e", "bank-a", "bank-b", "bank-c", "bank-d",
+        "bank-e", "timer", "tgroup", "init"]
+    for i in range(16):
+        pin = {"name": "prmao" + str(i), "addr": i}
+        for prm in many_prms[:10 + i % 11]:
+            pin[prm] = 1
+        groups["analog_outputs"].append(pin)
+
+    # Constant simulated analog input and fast timer for the sampling check.
+    groups["analog_inputs"].append({"name": "sampleai", "addr": 0, "sim": "const",
+        "init": 1234, "max": 4095})
+    groups["timers"].append({"name": "sampletim", "frequency": 1000})
+
+    # Digital input with interrupt for edge capture measurement and check.
+    groups["inputs"].append({"name": "edgedi", "addr": 1, "interrupt": 1})
+
+    # Remaining pins in fixed proportions: 30% digital inputs, 25% outputs, 20% analog
+    # inputs (every other one scaled, every fourth one averaged), 5% analog outputs,
+    # 15% PWM and rest timers.
+    n = max(n_pins - 51, 0)
+    counts = [("inputs", n * 30 // 100), ("outputs", n * 25 // 100),
+        ("analog_inputs", n * 20 // 100), ("analog_outputs", n * 5 // 100),
+        ("pwm", n * 15 // 100)]
+    counts.append(("timers", n - sum(c for _, c in counts)))
+    name_prefix = {"inputs": "di", "outputs": "do", "analog_inputs": "ai",
+        "analog_outputs": "ao", "pwm": "pwm", "timers": "tim"}
+
+    for group_name, count in counts:
+        for i in range(count):
+            name = name_prefix[group_name] + str(i)
+            pin = {"name": name, "addr": i % 64}
+            if group_name == "inputs" and i % 3 == 0:
+                pin["pull-up"] = 1
+            if group_name == "analog_inputs":
+                pin["max"] = 4095
+                if i % 2 == 0:
+                    pin.update({"smin": 0, "smax": 1000, "digs": 1})
+                if i % 4 == 0:
+                    pin["avg"] = 4
+            if group_name == "pwm":
+                pin.update({"frequency": 5000, "resolution": 12, "max": 4095})
+            if group_name == "timers":
+                pin = {"name": name, "frequency": 100}
+            groups[group_name].append(pin)
+
+    pins = {"io": [{"name": "bench", "groups":
+        [{"name": g, "pins": p} for g, p in groups.items() if len(p)] +
+        [{"name": "spi", "pins": spi}, {"name": "i2c", "pins": i2c}]}]}
+
+    names = [p["name"] for g in groups.values() for p in g]
+    return pins, names
+
+# Digital inputs only, spread over all GPIO banks, to compare reading inputs by bank to
+# reading them pin by pin.
+def bench_input_pins(n_pins):
+    inputs = [{"name": "di" + str(i), "addr": i % 64} for i in range(n_pins)]
+    pins = {"io": [{"name": "bench", "groups": [{"name": "inputs", "pins": inputs}]}]}
+    return pins, [p["name"] for p in inputs]
+
+def bench_signals(names):
+    signals = [{"name": s, "type": "int"} for s in names]
+    return {"name": "bench", "mblk": [{"name": "exp", "groups": [{"name": "pins", "signals": signals}]}]}
+
+# Signal structure for the generated pins code to point to. In IOCOM application this comes
+# from signals_to_c.py, pinsbench sets up the signals by itself at run time.
+def write_signals_header(path, names, config_name):
+    f = open(path, "w")
+    f.write("/* This file is generated by make_bench_config.py, do not edit */\n")
+    f.write("typedef struct\n{\n  struct\n  {\n")
+    for s in names:
+        f.write("    iocSignal " + s + ";\n")
+    f.write("  }\n  exp;\n}\nbench_signals_t;\n\n")
+    f.write("#define BENCH_N_SIGNALS " + str(len(names)) + "\n")
+    f.write("#define BENCH_CONFIG_NAME \"" + config_name + "\"\n")
+    f.write("extern bench_signals_t bench;\n")
+    f.close()
+
+def mymain():
+    root = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "config")
+    pins_to_c = os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "..", "..",
+        "scripts", "pins_to_c.py")
+    sizes = []
+    args = sys.argv[1:]
+    i = 0
+    while i < len(args):
+        if args[i] == "-o":
+            root = args[i + 1]
+            i += 1
+        else:
+            sizes.append(args[i])
+        i += 1
+
+    if len(sizes) == 0:
+        sizes = ["100", "1000", "10000", "in1000"]
+
+    for size in sizes:
+        hw = "bench" + size
+        pins_dir = os.path.join(root, "pins", hw)
+        include_dir = os.path.join(root, "include", hw)
+        os.makedirs(pins_dir, exist_ok=True)
+        os.makedirs(include_dir, exist_ok=True)
+
+        if size.startswith("in"):
+            pins, names = bench_input_pins(int(size[2:]))
+        else:
+            pins, names = bench_pins(int(size))
+        pins_path = os.path.join(pins_dir, "pins_io.json")
+        signals_path = os.path.join(pins_dir, "bench_signals.json")
+        json.dump(pins, open(pins_path, "w"), indent=1)
+        json.dump(bench_signals(names), open(signals_path, "w"), indent=1)
+        write_signals_header(os.path.join(include_dir, "bench_signals.h"), names, size)
+
+        subprocess.check_call([sys.executable, pins_to_c, pins_path, "-s", signals_path,
+            "-o", os.path.join(include_dir, "pins_io.c")])
+
+mymain()
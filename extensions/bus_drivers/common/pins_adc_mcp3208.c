@@ -212,9 +212,11 @@ osalStatus mcp3208_proc_resp(struct PinsBusDevice *device)
     current_ch = ext->current_ch;
 
     x = (os_short)(((os_ushort)(buf[1] & 0x0F) << 8) | (os_ushort)buf[2]);
+    PINS_DEVICE_WRITE_BEGIN(device);
     ext->adc_value[current_ch] = x;
     ext->state_bits[current_ch] = (x >= 1 && x <= 4094) ? OSAL_STATE_CONNECTED
         : (OSAL_STATE_CONNECTED|OSAL_STATE_ORANGE);
+    PINS_DEVICE_WRITE_END(device);
 
     if (++current_ch < MCP3208_NRO_ADC_CHANNELS) {
         ext->current_ch = current_ch;
@@ -225,8 +227,10 @@ osalStatus mcp3208_proc_resp(struct PinsBusDevice *device)
     {
         if (ext->adc_value[current_ch]) break;
     }
+    PINS_DEVICE_WRITE_BEGIN(device);
     ext->common_state_bits = (current_ch < MCP3208_NRO_ADC_CHANNELS)
         ? OSAL_STATE_CONNECTED : (OSAL_STATE_UNCONNECTED|OSAL_STATE_RED);
+    PINS_DEVICE_WRITE_END(device);
 
     ext->current_ch = 0;
     return OSAL_COMPLETED;
@@ -264,7 +268,9 @@ osalStatus mcp3208_set(struct PinsBusDevice *device, os_short addr, os_int value
   @brief Get SPI device data
   @anchor mcp3208_get
 
-  The mcp3208_get() function reads ASC channel value received from the device.
+  The mcp3208_get() function reads ASC channel value received from the device. Value and state
+  bits are read under device sequence lock, so these are consistent even if devicebus thread
+  is updating them at the same time.
 
   @param   device Structure representing SPI device.
   @param   addr ADC channel 0 ... 7.
@@ -277,9 +283,10 @@ osalStatus mcp3208_set(struct PinsBusDevice *device, os_short addr, os_int value
 */
 os_int mcp3208_get(struct PinsBusDevice *device, os_short addr, os_char *state_bits)
 {
-    os_short *adc_value;
     PinsMcp3208Ext *ext;
     os_int v;
+    os_uint seq;
+    os_char sb, common_sb;
 
     ext = (PinsMcp3208Ext*)device->ext;
 
@@ -288,19 +295,24 @@ os_int mcp3208_get(struct PinsBusDevice *device, os_short addr, os_char *state_b
         return -1;
     }
 
-    adc_value = ext->adc_value;
-    v = adc_value[addr];
+    do {
+        seq = PINS_DEVICE_READ_BEGIN(device);
+        v = ext->adc_value[addr];
+        sb = ext->state_bits[addr];
+        common_sb = (os_char)ext->common_state_bits;
+    }
+    while (PINS_DEVICE_READ_RETRY(device, seq));
 
     if (v == -1) {
         *state_bits = OSAL_STATE_UNCONNECTED|OSAL_STATE_RED;
     }
-    else if (ext->common_state_bits != OSAL_STATE_CONNECTED)
+    else if (common_sb != OSAL_STATE_CONNECTED)
     {
-        *state_bits = ext->common_state_bits;
+        *state_bits = common_sb;
     }
     else
     {
-        *state_bits = ext->state_bits[addr];
+        *state_bits = sb;
     }
     return v;
 }
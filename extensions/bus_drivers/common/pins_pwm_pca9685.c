@@ -193,7 +193,7 @@ void pca9685_initialize_pin(const struct Pin *pin)
     os_short addr;
     os_int value;
 
-    device = pin->bus_device;
+    device = PIN_BUS_DEVICE(pin);
     osal_debug_assert(device != OS_NULL);
 
     addr = pin->addr;
@@ -204,8 +204,8 @@ void pca9685_initialize_pin(const struct Pin *pin)
 
     value = pin_get_prm(pin, PIN_INIT);
     ext->pwm_value[addr] = (os_short)value;
-    ((PinRV*)pin->prm)->value = value;
-    ((PinRV*)pin->prm)->state_bits = OSAL_STATE_YELLOW;
+    PIN_RV(pin)->value = value;
+    PIN_RV(pin)->state_bits = OSAL_STATE_YELLOW;
 
     value = pin_get_prm(pin, PIN_FREQENCY);
     if (value) {
@@ -17,6 +17,9 @@
 #include "pinsx.h"
 #ifdef OSAL_ESP32
 #if PINS_CAMERA == PINS_TCD1304_CAMERA
+#if PINS_COMPACT
+#error "TCD1304 line camera sets up Pin structures at run time, not supported with PINS_COMPACT"
+#endif
 
 #define TDC1304_TIMING_CLOCK_HZ 200000.0
 // #define TDC1304_DATA_SZ (3694/2)
@@ -652,7 +655,6 @@ static void tcd1304_setup_camera_io_pins(
     /* Integration time (electronic shutter) signal SH.
      */
     camext.sh_prm_count = 0;
-    tcd1304_append_pin_parameter(camext.sh_pin_prm, &camext.sh_prm_count, PIN_RV, PIN_RV);
     tcd1304_append_pin_parameter(camext.sh_pin_prm, &camext.sh_prm_count, PIN_TIMER_SELECT, timer_nr);
     tcd1304_append_pin_parameter(camext.sh_pin_prm, &camext.sh_prm_count, PIN_FREQENCY, sh_frequency_hz);
     tcd1304_append_pin_parameter(camext.sh_pin_prm, &camext.sh_prm_count, PIN_RESOLUTION, bits);
@@ -669,7 +671,6 @@ static void tcd1304_setup_camera_io_pins(
     /* IGC parameters
      */
     camext.igc_prm_count = 0;
-    tcd1304_append_pin_parameter(camext.igc_pin_prm, &camext.igc_prm_count, PIN_RV, PIN_RV);
     tcd1304_append_pin_parameter(camext.igc_pin_prm, &camext.igc_prm_count, PIN_TIMER_SELECT, timer_nr);
     tcd1304_append_pin_parameter(camext.igc_pin_prm, &camext.igc_prm_count, PIN_FREQENCY, sh_frequency_hz);
     tcd1304_append_pin_parameter(camext.igc_pin_prm, &camext.igc_prm_count, PIN_RESOLUTION, bits);
@@ -688,7 +689,6 @@ static void tcd1304_setup_camera_io_pins(
     /* IGC loop back parameters
      */
     camext.igc_loopback_prm_count = 0;
-    tcd1304_append_pin_parameter(camext.igc_loopback_pin_prm, &camext.igc_loopback_prm_count, PIN_RV, PIN_RV);
     tcd1304_append_pin_parameter(camext.igc_loopback_pin_prm, &camext.igc_loopback_prm_count, PIN_INTERRUPT_ENABLED, 1);
 
     /* Integration clear (new photo) signal IGC.
@@ -0,0 +1,694 @@
+/**
+
+  @file    config_blob/common/pins_config_blob.c
+  @brief   Bind compact pin configuration from binary image.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  The image is checked once when binding: Header must match this build and every index
+  in Pin structures, parameter slot maps, groups, devices, scan plan and names must be
+  within it's table, so that a damaged or mismatched image is rejected instead of crashing
+  later. After that the image is only read trough pins_compact.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pinsx.h"
+#if PINS_CONFIG_BLOB
+
+/* Writable block items are aligned to 8 bytes, for os_double in PinScaling.
+ */
+#define PINS_BLOB_ALIGN(n) (((n) + 7) & ~(os_memsz)7)
+
+/* Compact mode tables, set by pins_bind_config_blob().
+ */
+PinsCompactTables pins_compact;
+
+#if PINS_SPI || PINS_I2C
+/* Device bus main structure, normally in generated code.
+ */
+PinsDeviceBus pins_devicebus;
+#endif
+
+/* Currently bound configuration.
+ */
+static PinsConfigBlob *pins_blob_current;
+
+/** Pointers into writable block, set up by pins_blob_layout().
+ */
+typedef struct PinsBlobRam
+{
+    PinsConfigBlob *blob;
+    PinGroupHdr *group;
+    const PinGroupHdr **group_list;
+    const struct iocSignal **signal;
+#if PINS_SIMULATED_INTERRUPTS
+    PinInterruptConf *int_conf;
+#endif
+#if PINS_SCALING_CACHE
+    PinScaling *scaling;
+#endif
+#if PINS_INPUT_FILTERS
+    PinFilter *filter;
+#endif
+#if PINS_SCAN_SCHEDULER
+    PinGroupScan *scan;
+#endif
+#if PINS_SCAN_PLAN
+    PinsScanPlan *scan_plan;
+    const Pin **scan_pin;
+#endif
+#if PINS_SPI || PINS_I2C
+    PinsBusDevice **bus_device;
+    PinsBus *bus;
+#endif
+}
+PinsBlobRam;
+
+/* Forward referred static functions.
+ */
+static osalStatus pins_blob_check(
+    const PinsBlobHeader *h,
+    os_memsz image_sz);
+
+static os_boolean pins_blob_indices_ok(
+    const PinsBlobHeader *h);
+
+static os_boolean pins_blob_section_ok(
+    const PinsBlobHeader *h,
+    os_uint ofs,
+    os_memsz n,
+    os_memsz item_sz);
+
+static os_memsz pins_blob_layout(
+    const PinsBlobHeader *h,
+    PinsBlobRam *r,
+    os_char *ram);
+
+static void pins_blob_fill(
+    PinsBlobRam *r,
+    pinsBlobSignalResolver *resolve_signal,
+    void *context);
+
+#if PINS_SPI || PINS_I2C
+static osalStatus pins_blob_link_devices(
+    PinsBlobRam *r,
+    const struct PinsBusDriver *drivers,
+    os_int n_drivers);
+#endif
+
+/* Get pointer to image section.
+ */
+#define PINS_BLOB_AT(h, ofs, type) ((const type*)((const os_char*)(h) + (ofs)))
+#define PINS_BLOB_STR(h, ofs) PINS_BLOB_AT(h, (h)->str_ofs + (ofs), os_char)
+
+
+/**
+****************************************************************************************************
+
+  @brief Bind binary image as current pin configuration.
+  @anchor pins_bind_config_blob
+
+  The pins_bind_config_blob() function checks binary image written by "pins_to_c.py -b",
+  allocates writable block for runtime data and sets pins_compact to refer to tables in the
+  image. The image must stay in memory, unchanged, until the configuration is released.
+  Pass &blob->hdr to pins_setup().
+
+  @param   blob Where to store pointer to bound configuration. Set to OS_NULL if the
+           function fails.
+  @param   image The binary image, aligned to 8 bytes.
+  @param   image_sz Image size in bytes.
+  @param   drivers SPI and I2C driver table, like {PINS_BUS_DRIVER(pins_adc_mcp3208)}.
+           OS_NULL if there are no SPI or I2C devices.
+  @param   n_drivers Number of drivers in table.
+  @param   resolve_signal Function to find IOCOM signal by name, OS_NULL if pins are not
+           mapped to signals.
+  @param   context Passed to resolve_signal.
+  @return  OSAL_SUCCESS if configuration was bound. OSAL_STATUS_MEMORY_ALLOCATION_FAILED
+           if out of memory, other values indicate that image is damaged or does not
+           match this build.
+
+****************************************************************************************************
+*/
+osalStatus pins_bind_config_blob(
+    PinsConfigBlob **blob,
+    const void *image,
+    os_memsz image_sz,
+    const struct PinsBusDriver *drivers,
+    os_int n_drivers,
+    pinsBlobSignalResolver *resolve_signal,
+    void *context)
+{
+    const PinsBlobHeader *h;
+    PinsBlobRam r;
+    PinsConfigBlob *b;
+    os_char *ram;
+    os_memsz ram_sz;
+    osalStatus s;
+
+    *blob = OS_NULL;
+    h = (const PinsBlobHeader*)image;
+    s = pins_blob_check(h, image_sz);
+    if (s) return s;
+
+    ram_sz = pins_blob_layout(h, &r, OS_NULL);
+    ram = (os_char*)os_malloc(ram_sz, OS_NULL);
+    if (ram == OS_NULL) return OSAL_STATUS_MEMORY_ALLOCATION_FAILED;
+    os_memclear(ram, ram_sz);
+    pins_blob_layout(h, &r, ram);
+    b = r.blob;
+    b->image = h;
+    b->image_sz = image_sz;
+    b->ram_sz = ram_sz;
+
+#if PINS_SPI || PINS_I2C
+    s = pins_blob_link_devices(&r, drivers, n_drivers);
+    if (s) {
+        os_free(ram, ram_sz);
+        return s;
+    }
+#endif
+
+    pins_blob_fill(&r, resolve_signal, context);
+    pins_blob_current = b;
+    *blob = b;
+    return OSAL_SUCCESS;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Release bound configuration.
+  @anchor pins_release_config_blob
+
+  The pins_release_config_blob() function frees the writable block. Pins must not be in use:
+  Call pins_shutdown() and stop device bus first, if these were started. The image itself
+  is not released, use pins_unmap_config_blob() for mapped image.
+
+  @param   blob Configuration bound by pins_bind_config_blob(), OS_NULL is ignored.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_release_config_blob(
+    PinsConfigBlob *blob)
+{
+    if (blob == OS_NULL) return;
+    if (pins_blob_current == blob) {
+        pins_blob_current = OS_NULL;
+        os_memclear(&pins_compact, sizeof(pins_compact));
+    }
+    os_free(blob, blob->ram_sz);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Find pin by name.
+  @anchor pins_find_blob_pin
+
+  The pins_find_blob_pin() function looks up a pin of bound configuration by "group.pin"
+  name, like "inputs.dip_switch_3", or first pin of application pin group by group name.
+  Names are compared one by one, look pins up once after binding and keep the pointers.
+
+  @param   blob Bound configuration.
+  @param   name Name to look for.
+  @return  Pointer to pin structure, OS_NULL if not found.
+
+****************************************************************************************************
+*/
+const Pin *pins_find_blob_pin(
+    const PinsConfigBlob *blob,
+    const os_char *name)
+{
+    const PinsBlobHeader *h;
+    const PinsBlobName *n;
+    os_int i;
+
+    h = blob->image;
+    n = PINS_BLOB_AT(h, h->name_ofs, PinsBlobName);
+    for (i = 0; i < h->n_names; i++, n++) {
+        if (!os_strcmp(PINS_BLOB_STR(h, n->name), name)) return blob->pin + n->pin;
+    }
+    return OS_NULL;
+}
+
+
+#if PINS_SPI || PINS_I2C
+/**
+****************************************************************************************************
+
+  @brief Initialize SPI and I2C bus devices, called by pins_setup().
+  @anchor pins_initialize_bus_devices
+
+  Replaces the generated function, which is not linked with binary configuration. Makes
+  buses of currently bound configuration the ones pins_devicebus runs, and initializes
+  buses, drivers, devices and pins on devices.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_initialize_bus_devices(void)
+{
+    PinsConfigBlob *b;
+    PinsBus *bus;
+    const Pin *pin;
+    os_int i, j;
+
+    b = pins_blob_current;
+    if (b == OS_NULL) return;
+
+    pins_devicebus.first_bus = b->first_bus;
+    for (bus = b->first_bus; bus; bus = bus->next_bus) {
+        pins_init_bus(bus);
+    }
+
+    for (i = 0; i < b->n_devices; i++)
+    {
+        for (j = 0; j < i; j++) {
+            if (b->device_driver[j] == b->device_driver[i]) break;
+        }
+        if (j == i) {
+            b->device_driver[i]->initialize_driver();
+        }
+    }
+
+    for (i = 0; i < b->n_devices; i++) {
+        b->device_driver[i]->initialize_device(b->device + i);
+    }
+
+    for (i = 0, pin = b->pin; i < b->n_pins; i++, pin++) {
+        if (pin->bus_device) {
+            PIN_BUS_DEVICE(pin)->initialize_pin_func(pin);
+        }
+    }
+}
+#endif
+
+
+/**
+****************************************************************************************************
+
+  @brief Check that image matches this build and is not damaged.
+  @anchor pins_blob_check
+
+  @param   h Image header, beginning of image.
+  @param   image_sz Image size in bytes.
+  @return  OSAL_SUCCESS if image can be used, OSAL_STATUS_FAILED if not.
+
+****************************************************************************************************
+*/
+static osalStatus pins_blob_check(
+    const PinsBlobHeader *h,
+    os_memsz image_sz)
+{
+    if (image_sz < sizeof(PinsBlobHeader) || os_memcmp(h->magic, "PINB", 4)) {
+        osal_debug_error("pins_bind_config_blob: Not a pin configuration image");
+        return OSAL_STATUS_FAILED;
+    }
+    if (h->endian != PINS_BLOB_ENDIAN_MARK || h->version != PINS_BLOB_VERSION ||
+        h->pin_sz != sizeof(Pin) || h->nro_prms != PIN_NRO_PRMS)
+    {
+        osal_debug_error_int("pins_bind_config_blob: Image does not match build, version ",
+            h->version);
+        return OSAL_STATUS_FAILED;
+    }
+    if (h->image_sz > image_sz || !pins_blob_indices_ok(h)) {
+        osal_debug_error("pins_bind_config_blob: Damaged image");
+        return OSAL_STATUS_FAILED;
+    }
+    return OSAL_SUCCESS;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Check that sections are within image and indices within their tables.
+  @anchor pins_blob_indices_ok
+
+  @param   h Image header, image_sz in it is already checked.
+  @return  OS_TRUE if image is consistent.
+
+****************************************************************************************************
+*/
+static os_boolean pins_blob_indices_ok(
+    const PinsBlobHeader *h)
+{
+    const Pin *pin;
+    const PinsBlobGroup *g;
+    const PinsBlobDevice *d;
+    const PinsBlobName *n;
+    const os_uint *sig;
+    const os_ushort *scan;
+    const os_uchar *slot;
+    os_memsz str_sz;
+    os_int i, j, n_scan;
+
+    n_scan = 0;
+    for (i = 0; i < 5; i++) n_scan += h->n_scan[i];
+    if (h->str_ofs >= h->image_sz ||
+        ((const os_char*)h)[h->image_sz - 1] != '\0' ||
+        !pins_blob_section_ok(h, h->pin_ofs, h->n_pins, sizeof(Pin)) ||
+        !pins_blob_section_ok(h, h->prm_ofs, h->n_prm, sizeof(PinPrmValue)) ||
+        !pins_blob_section_ok(h, h->group_ofs, h->n_groups, sizeof(PinsBlobGroup)) ||
+        !pins_blob_section_ok(h, h->slot_ofs, h->n_slot_maps, PIN_NRO_PRMS) ||
+        !pins_blob_section_ok(h, h->signal_ofs, h->n_signals, sizeof(os_uint)) ||
+        !pins_blob_section_ok(h, h->device_ofs, h->n_devices, sizeof(PinsBlobDevice)) ||
+        !pins_blob_section_ok(h, h->scan_ofs, n_scan, sizeof(os_ushort)) ||
+        !pins_blob_section_ok(h, h->name_ofs, h->n_names, sizeof(PinsBlobName)))
+    {
+        return OS_FALSE;
+    }
+    str_sz = h->image_sz - h->str_ofs;
+
+    pin = PINS_BLOB_AT(h, h->pin_ofs, Pin);
+    for (i = 0; i < h->n_pins; i++, pin++) {
+        if (pin->rv >= h->n_pins || pin->prm_n < 0 ||
+            pin->prm + (os_uint)pin->prm_n > h->n_prm || pin->next > h->n_pins ||
+            pin->signal > h->n_signals || pin->bus_device > h->n_devices ||
+            pin->prm_slot > h->n_slot_maps || pin->int_conf > h->n_int_conf ||
+            pin->scaling > h->n_scaling || pin->filter > h->n_filters)
+        {
+            return OS_FALSE;
+        }
+
+        /* Slot map gives 1 + parameter's position within the pin's parameters.
+         */
+        if (pin->prm_slot) {
+            slot = PINS_BLOB_AT(h, h->slot_ofs, os_uchar) + PIN_NRO_PRMS * (pin->prm_slot - 1);
+            for (j = 0; j < PIN_NRO_PRMS; j++) {
+                if (slot[j] > pin->prm_n) return OS_FALSE;
+            }
+        }
+    }
+
+    g = PINS_BLOB_AT(h, h->group_ofs, PinsBlobGroup);
+    for (i = 0; i < h->n_groups; i++, g++) {
+        if (g->first_pin + (os_uint)g->n_pins > h->n_pins) return OS_FALSE;
+    }
+
+    sig = PINS_BLOB_AT(h, h->signal_ofs, os_uint);
+    for (i = 0; i < h->n_signals; i++) {
+        if (sig[i] >= str_sz) return OS_FALSE;
+    }
+
+    d = PINS_BLOB_AT(h, h->device_ofs, PinsBlobDevice);
+    for (i = 0; i < h->n_devices; i++, d++) {
+        if (d->pin >= h->n_pins || d->bus_nr >= h->n_buses || d->driver_name >= str_sz) {
+            return OS_FALSE;
+        }
+    }
+
+    scan = PINS_BLOB_AT(h, h->scan_ofs, os_ushort);
+    for (i = 0; i < n_scan; i++) {
+        if (scan[i] >= h->n_pins) return OS_FALSE;
+    }
+
+    n = PINS_BLOB_AT(h, h->name_ofs, PinsBlobName);
+    for (i = 0; i < h->n_names; i++, n++) {
+        if (n->pin >= h->n_pins || n->name >= str_sz) return OS_FALSE;
+    }
+    return OS_TRUE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Check that image section is within the image.
+  @anchor pins_blob_section_ok
+
+  @param   h Image header.
+  @param   ofs Section offset from beginning of image.
+  @param   n Number of items in section.
+  @param   item_sz Item size in bytes.
+  @return  OS_TRUE if section fits.
+
+****************************************************************************************************
+*/
+static os_boolean pins_blob_section_ok(
+    const PinsBlobHeader *h,
+    os_uint ofs,
+    os_memsz n,
+    os_memsz item_sz)
+{
+    if (ofs & 7) return OS_FALSE;
+    return (os_boolean)(ofs <= h->image_sz && n * item_sz <= h->image_sz - ofs);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Lay out the writable block.
+  @anchor pins_blob_layout
+
+  Called first with OS_NULL to calculate size, then to set pointers into allocated block.
+
+  @param   h Image header.
+  @param   r Where to store pointers.
+  @param   ram Pointer to writable block, OS_NULL to only calculate size.
+  @return  Block size in bytes.
+
+****************************************************************************************************
+*/
+static os_memsz pins_blob_layout(
+    const PinsBlobHeader *h,
+    PinsBlobRam *r,
+    os_char *ram)
+{
+    PinsConfigBlob *b;
+    os_memsz pos;
+#if PINS_SCAN_PLAN
+    os_int i, n_scan;
+#endif
+
+#define PINS_BLOB_TAKE(p, type, n) \
+    if (ram) p = (type*)(ram + pos); \
+    pos += PINS_BLOB_ALIGN((os_memsz)(n) * sizeof(type));
+
+    pos = 0;
+    b = OS_NULL;
+    PINS_BLOB_TAKE(b, PinsConfigBlob, 1)
+    r->blob = b;
+    PINS_BLOB_TAKE(r->group, PinGroupHdr, h->n_groups)
+    PINS_BLOB_TAKE(r->group_list, const PinGroupHdr*, h->n_groups)
+    PINS_BLOB_TAKE(b->hdr.rv, PinRV, h->n_pins)
+#if PINS_STATISTICS
+    PINS_BLOB_TAKE(b->hdr.stats, PinStats, h->n_pins)
+#endif
+    PINS_BLOB_TAKE(r->signal, const struct iocSignal*, h->n_signals + 1)
+#if PINS_SIMULATED_INTERRUPTS
+    PINS_BLOB_TAKE(r->int_conf, PinInterruptConf, h->n_int_conf)
+#endif
+#if PINS_SCALING_CACHE
+    PINS_BLOB_TAKE(r->scaling, PinScaling, h->n_scaling)
+#endif
+#if PINS_INPUT_FILTERS
+    PINS_BLOB_TAKE(r->filter, PinFilter, h->n_filters)
+#endif
+#if PINS_SCAN_SCHEDULER
+    PINS_BLOB_TAKE(r->scan, PinGroupScan, h->n_groups)
+#endif
+#if PINS_SCAN_PLAN
+    n_scan = 0;
+    for (i = 0; i < 5; i++) n_scan += h->n_scan[i];
+    PINS_BLOB_TAKE(r->scan_plan, PinsScanPlan, 1)
+    PINS_BLOB_TAKE(r->scan_pin, const Pin*, n_scan)
+#endif
+#if PINS_SPI || PINS_I2C
+    PINS_BLOB_TAKE(r->bus_device, PinsBusDevice*, h->n_devices + 1)
+    PINS_BLOB_TAKE(b->device, PinsBusDevice, h->n_devices)
+    PINS_BLOB_TAKE(b->device_driver, const PinsBusDriver*, h->n_devices)
+    PINS_BLOB_TAKE(r->bus, PinsBus, h->n_buses)
+#endif
+
+#undef PINS_BLOB_TAKE
+    return pos;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Set up group headers, signals, scan plan and pins_compact.
+  @anchor pins_blob_fill
+
+  @param   r Pointers into writable block.
+  @param   resolve_signal Function to find IOCOM signal by name, OS_NULL if none.
+  @param   context Passed to resolve_signal.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_blob_fill(
+    PinsBlobRam *r,
+    pinsBlobSignalResolver *resolve_signal,
+    void *context)
+{
+    PinsConfigBlob *b;
+    const PinsBlobHeader *h;
+    const PinsBlobGroup *g;
+    const os_uint *sig;
+    os_int i;
+#if PINS_SCAN_PLAN
+    const os_ushort *scan;
+    const Pin **p;
+#endif
+
+    b = r->blob;
+    h = b->image;
+    b->pin = PINS_BLOB_AT(h, h->pin_ofs, Pin);
+    b->n_pins = (os_short)h->n_pins;
+
+    g = PINS_BLOB_AT(h, h->group_ofs, PinsBlobGroup);
+    for (i = 0; i < h->n_groups; i++, g++) {
+        r->group[i].n_pins = (os_short)g->n_pins;
+        r->group[i].pin = b->pin + g->first_pin;
+#if PINS_SCAN_SCHEDULER
+        if (g->scan_ms) {
+            r->scan[i].period_ms = g->scan_ms;
+            r->group[i].scan = r->scan + i;
+        }
+#endif
+        r->group_list[i] = r->group + i;
+    }
+
+    b->hdr.group = r->group_list;
+    b->hdr.n_groups = (os_short)h->n_groups;
+    b->hdr.n_rv = (os_short)h->n_pins;
+
+    if (resolve_signal) {
+        sig = PINS_BLOB_AT(h, h->signal_ofs, os_uint);
+        for (i = 0; i < h->n_signals; i++) {
+            r->signal[i + 1] = resolve_signal(PINS_BLOB_STR(h, sig[i]), context);
+        }
+    }
+
+#if PINS_SCAN_PLAN
+    if (h->scan_plan_ok)
+    {
+        scan = PINS_BLOB_AT(h, h->scan_ofs, os_ushort);
+        p = r->scan_pin;
+
+#define PINS_BLOB_SCAN_CLASS(name, n) \
+        r->scan_plan->name = p; \
+        r->scan_plan->n_##name = (os_short)(n); \
+        for (i = 0; i < (n); i++) *(p++) = b->pin + *(scan++);
+
+        PINS_BLOB_SCAN_CLASS(gpio_in, h->n_scan[0])
+        PINS_BLOB_SCAN_CLASS(direct_in, h->n_scan[1])
+        PINS_BLOB_SCAN_CLASS(bus_in, h->n_scan[2])
+        PINS_BLOB_SCAN_CLASS(int_in, h->n_scan[3])
+        PINS_BLOB_SCAN_CLASS(timer, h->n_scan[4])
+#undef PINS_BLOB_SCAN_CLASS
+
+        b->hdr.scan_plan = r->scan_plan;
+    }
+#endif
+
+    pins_compact.pin = b->pin;
+    pins_compact.rv = b->hdr.rv;
+    pins_compact.prm = PINS_BLOB_AT(h, h->prm_ofs, PinPrmValue);
+    pins_compact.signal = r->signal;
+#if PINS_SPI || PINS_I2C
+    pins_compact.bus_device = r->bus_device;
+#endif
+#if PINS_PRM_SLOT_MAP
+    pins_compact.prm_slot = PINS_BLOB_AT(h, h->slot_ofs, os_uchar);
+#endif
+#if PINS_SIMULATED_INTERRUPTS
+    pins_compact.int_conf = r->int_conf;
+#endif
+#if PINS_SCALING_CACHE
+    pins_compact.scaling = r->scaling;
+#endif
+#if PINS_INPUT_FILTERS
+    pins_compact.filter = r->filter;
+#endif
+}
+
+
+#if PINS_SPI || PINS_I2C
+/**
+****************************************************************************************************
+
+  @brief Set up SPI and I2C buses and devices.
+  @anchor pins_blob_link_devices
+
+  Finds driver of each device by name and links devices into buses by bus number in image.
+
+  @param   r Pointers into writable block.
+  @param   drivers SPI and I2C driver table.
+  @param   n_drivers Number of drivers in table.
+  @return  OSAL_SUCCESS if all drivers were found, OSAL_STATUS_FAILED if not.
+
+****************************************************************************************************
+*/
+static osalStatus pins_blob_link_devices(
+    PinsBlobRam *r,
+    const struct PinsBusDriver *drivers,
+    os_int n_drivers)
+{
+    PinsConfigBlob *b;
+    const PinsBlobHeader *h;
+    const PinsBlobDevice *d;
+    const PinsBusDriver *driver;
+    const os_char *driver_name;
+    PinsBusDevice *device;
+    PinsBus *bus;
+    const Pin *pin;
+    os_int i, j;
+
+    b = r->blob;
+    h = b->image;
+    pin = PINS_BLOB_AT(h, h->pin_ofs, Pin);
+    d = PINS_BLOB_AT(h, h->device_ofs, PinsBlobDevice);
+    for (i = 0; i < h->n_devices; i++, d++)
+    {
+        driver_name = PINS_BLOB_STR(h, d->driver_name);
+        for (j = 0; j < n_drivers; j++) {
+            if (!os_strcmp(drivers[j].name, driver_name)) break;
+        }
+        if (j == n_drivers) {
+            osal_debug_error_str("pins_bind_config_blob: Unknown driver ", driver_name);
+            return OSAL_STATUS_FAILED;
+        }
+        driver = drivers + j;
+
+        device = b->device + i;
+        device->device_pin = pin + d->pin;
+        device->initialize_pin_func = driver->initialize_pin;
+        device->gen_req_func = driver->gen_req;
+        device->proc_resp_func = driver->proc_resp;
+        device->set_func = driver->set;
+        device->get_func = driver->get;
+        b->device_driver[i] = driver;
+        r->bus_device[i + 1] = device;
+
+        bus = r->bus + d->bus_nr;
+        if (bus->bus_type == 0) {
+            bus->bus_type = device->device_pin->type == PIN_I2C ? PINS_I2C_BUS : PINS_SPI_BUS;
+            bus->next_bus = b->first_bus;
+            b->first_bus = bus;
+        }
+        device->bus = bus;
+        device->next_device = bus->first_bus_device;
+        bus->first_bus_device = device;
+    }
+
+    b->n_devices = (os_short)h->n_devices;
+    return OSAL_SUCCESS;
+}
+#endif
+
+#endif
@@ -0,0 +1,202 @@
+/**
+
+  @file    config_blob/common/pins_config_blob.h
+  @brief   Bind compact pin configuration from binary image.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  "pins_to_c.py -b pins_io.bin pins_io.json" writes compact mode tables (Pin structures,
+  parameters, group headers, parameter slot maps, scan plan...) as one position independent
+  binary image, items refer to each other by index or offset instead of pointer. The image
+  is used in place: It can be memory mapped read only, pins_map_config_blob() on Linux, so
+  startup costs nothing and processes using the same image share the constant part.
+
+  Everything which is written at run time or holds pointers, runtime values (PinRV),
+  interrupt configuration, scaling, filter state, SPI and I2C buses and devices, IoPinsHdr,
+  etc. is placed in one small writable block allocated by os_malloc(). The block starts
+  with PinsConfigBlob structure.
+
+  Build with PINS_COMPACT=1 and PINS_CONFIG_BLOB=1. Generated C configuration is not linked,
+  this extension defines pins_compact, and pins_devicebus and pins_initialize_bus_devices()
+  for SPI and I2C. IOCOM signals are resolved by name trough callback when binding. Only one
+  image can be bound at a time, since pins_compact is global.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#pragma once
+#ifndef PINS_CONFIG_BLOB_H_
+#define PINS_CONFIG_BLOB_H_
+#include "pinsx.h"
+
+#if PINS_CONFIG_BLOB
+#if PINS_COMPACT == 0
+#error Binary pin configuration image needs PINS_COMPACT
+#endif
+#if OSAL_MINIMALISTIC
+#error Binary pin configuration image cannot be used with OSAL_MINIMALISTIC
+#endif
+
+/** Binary image version, blob_version in pins_to_c.py. Changed whenever image layout,
+    compact Pin structure or pinPrm enumeration changes.
+ */
+#define PINS_BLOB_VERSION 1
+
+/** Byte order marker, image is written in little endian byte order.
+ */
+#define PINS_BLOB_ENDIAN_MARK 0x01020304
+
+struct PinsBusDriver;
+
+/** Binary image header. Section offsets are from beginning of the image, each section is
+    aligned to 8 bytes. Must match write_blob() in pins_to_c.py.
+ */
+typedef struct PinsBlobHeader
+{
+    os_char magic[4];           /* "PINB" */
+    os_uint endian;             /* PINS_BLOB_ENDIAN_MARK */
+    os_ushort version;          /* PINS_BLOB_VERSION */
+    os_ushort pin_sz;           /* sizeof(Pin) */
+    os_ushort nro_prms;         /* PIN_NRO_PRMS */
+    os_ushort scan_plan_ok;     /* Nonzero if scan plan is written */
+    os_uint image_sz;           /* Total image size in bytes */
+
+    os_ushort n_pins, n_groups, n_prm, n_signals, n_devices, n_buses, n_slot_maps;
+    os_ushort n_int_conf, n_scaling, n_filters;
+    os_ushort n_scan[5];        /* Pins in each scan plan class, PinsScanPlan order */
+    os_ushort n_names;
+
+    os_uint pin_ofs;            /* Pin[n_pins] */
+    os_uint prm_ofs;            /* PinPrmValue[n_prm] */
+    os_uint group_ofs;          /* PinsBlobGroup[n_groups] */
+    os_uint slot_ofs;           /* os_uchar[n_slot_maps * PIN_NRO_PRMS] */
+    os_uint signal_ofs;         /* os_uint[n_signals], signal name offsets in string area */
+    os_uint device_ofs;         /* PinsBlobDevice[n_devices] */
+    os_uint scan_ofs;           /* os_ushort pin index for each scan plan entry */
+    os_uint name_ofs;           /* PinsBlobName[n_names] */
+    os_uint str_ofs;            /* '\0' terminated UTF-8 strings */
+}
+PinsBlobHeader;
+
+/** Pin group header in image.
+ */
+typedef struct PinsBlobGroup
+{
+    os_ushort n_pins;
+    os_ushort first_pin;
+    os_int scan_ms;
+}
+PinsBlobGroup;
+
+/** SPI or I2C device in image. Devices referred to by Pin.bus_device come first, in same
+    order. Bus number tells which devices share a bus, bus type is device pin's type.
+ */
+typedef struct PinsBlobDevice
+{
+    os_ushort pin;
+    os_ushort bus_nr;
+    os_uint driver_name;
+}
+PinsBlobDevice;
+
+/** Name of pin ("group.pin") or application pin group (first pin of linked list) in image.
+ */
+typedef struct PinsBlobName
+{
+    os_ushort pin;
+    os_ushort reserved;
+    os_uint name;
+}
+PinsBlobName;
+
+/** Callback to resolve IOCOM signal by name, like "gina.exp.dip_switch_3". Returns
+    OS_NULL if not found, pin is then not mapped to a signal.
+ */
+typedef const struct iocSignal *pinsBlobSignalResolver(
+    const os_char *signal_name,
+    void *context);
+
+/** Bound configuration. This is the beginning of the writable block, everything else
+    which is written at run time follows it in the same memory block.
+ */
+typedef struct PinsConfigBlob
+{
+    /** Top level structure to pass to pins_setup(), pins_read_all(), etc.
+     */
+    IoPinsHdr hdr;
+
+    /** All pins as one array in JSON order, within the image.
+     */
+    const Pin *pin;
+    os_short n_pins;
+
+    /** The image.
+     */
+    const PinsBlobHeader *image;
+    os_memsz image_sz;
+
+#if PINS_SPI || PINS_I2C
+    /** SPI and I2C buses and devices.
+     */
+    PinsBus *first_bus;
+    PinsBusDevice *device;
+    const PinsBusDriver **device_driver;
+    os_short n_devices;
+#endif
+
+    /** Writable block size in bytes, for os_free().
+     */
+    os_memsz ram_sz;
+
+    /** Image was mapped by pins_map_config_blob().
+     */
+    os_boolean mapped;
+}
+PinsConfigBlob;
+
+/* Bind binary image as current pin configuration.
+ */
+osalStatus pins_bind_config_blob(
+    PinsConfigBlob **blob,
+    const void *image,
+    os_memsz image_sz,
+    const struct PinsBusDriver *drivers,
+    os_int n_drivers,
+    pinsBlobSignalResolver *resolve_signal,
+    void *context);
+
+/* Release configuration bound by pins_bind_config_blob(). The image is not released.
+ */
+void pins_release_config_blob(
+    PinsConfigBlob *blob);
+
+/* Find pin by "group.pin" name or first pin of application group by group name.
+ */
+const Pin *pins_find_blob_pin(
+    const PinsConfigBlob *blob,
+    const os_char *name);
+
+#ifdef OSAL_LINUX
+/* Memory map binary image file read only and bind it.
+ */
+osalStatus pins_map_config_blob(
+    PinsConfigBlob **blob,
+    const os_char *path,
+    const struct PinsBusDriver *drivers,
+    os_int n_drivers,
+    pinsBlobSignalResolver *resolve_signal,
+    void *context);
+
+/* Release configuration and unmap image mapped by pins_map_config_blob().
+ */
+void pins_unmap_config_blob(
+    PinsConfigBlob *blob);
+#endif
+
+#endif
+#endif
@@ -0,0 +1,128 @@
+/**
+
+  @file    config_blob/linux/pins_linux_config_blob.c
+  @brief   Memory map binary pin configuration image.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  The image file is mapped read only and shared, so pages are loaded on demand and processes
+  mapping the same file use the same physical memory.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pinsx.h"
+#ifdef OSAL_LINUX
+#if PINS_CONFIG_BLOB
+
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+
+/**
+****************************************************************************************************
+
+  @brief Memory map binary image file read only and bind it.
+  @anchor pins_map_config_blob
+
+  The pins_map_config_blob() function maps image file written by "pins_to_c.py -b" and binds
+  it by pins_bind_config_blob(). Release by pins_unmap_config_blob().
+
+  @param   blob Where to store pointer to bound configuration. Set to OS_NULL if the
+           function fails.
+  @param   path Path to image file.
+  @param   drivers SPI and I2C driver table, OS_NULL if none.
+  @param   n_drivers Number of drivers in table.
+  @param   resolve_signal Function to find IOCOM signal by name, OS_NULL if none.
+  @param   context Passed to resolve_signal.
+  @return  OSAL_SUCCESS if configuration was bound. OSAL_STATUS_FAILED if file cannot be
+           mapped, other values as pins_bind_config_blob().
+
+****************************************************************************************************
+*/
+osalStatus pins_map_config_blob(
+    PinsConfigBlob **blob,
+    const os_char *path,
+    const struct PinsBusDriver *drivers,
+    os_int n_drivers,
+    pinsBlobSignalResolver *resolve_signal,
+    void *context)
+{
+    struct stat st;
+    void *image;
+    int fd;
+    osalStatus s;
+
+    *blob = OS_NULL;
+    fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        osal_debug_error_str("pins_map_config_blob: Cannot open ", path);
+        return OSAL_STATUS_FAILED;
+    }
+
+    if (fstat(fd, &st) || st.st_size <= 0) {
+        close(fd);
+        osal_debug_error_str("pins_map_config_blob: Cannot get size of ", path);
+        return OSAL_STATUS_FAILED;
+    }
+
+    image = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (image == MAP_FAILED) {
+        osal_debug_error_str("pins_map_config_blob: mmap failed ", path);
+        return OSAL_STATUS_FAILED;
+    }
+
+    s = pins_bind_config_blob(blob, image, (os_memsz)st.st_size, drivers, n_drivers,
+        resolve_signal, context);
+    if (s) {
+        munmap(image, (size_t)st.st_size);
+        return s;
+    }
+
+    (*blob)->mapped = OS_TRUE;
+    return OSAL_SUCCESS;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Release configuration and unmap image.
+  @anchor pins_unmap_config_blob
+
+  The pins_unmap_config_blob() function releases configuration bound by
+  pins_map_config_blob() and unmaps the image file. Pins must not be in use.
+
+  @param   blob Mapped configuration, OS_NULL is ignored.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_unmap_config_blob(
+    PinsConfigBlob *blob)
+{
+    const void *image;
+    os_memsz image_sz;
+    os_boolean mapped;
+
+    if (blob == OS_NULL) return;
+    image = blob->image;
+    image_sz = blob->image_sz;
+    mapped = blob->mapped;
+
+    pins_release_config_blob(blob);
+    if (mapped) {
+        munmap((void*)image, (size_t)image_sz);
+    }
+}
+
+#endif
+#endif
@@ -0,0 +1,78 @@
+/**
+
+  @file    extensions/devicebus/common/pins_devicebus.c
+  @brief   SPI and I2C device bus, code common to all platforms.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pinsx.h"
+#if PINS_SPI || PINS_I2C
+
+
+/**
+****************************************************************************************************
+
+  @brief Start reading device values protected by sequence lock.
+  @anchor pins_device_read_begin
+
+  The pins_device_read_begin() function waits until devicebus thread is not in middle of
+  updating the values and returns the sequence number. After copying the values the reader
+  checks with PINS_DEVICE_READ_RETRY() that sequence number has not changed.
+
+  @param   device Structure representing SPI or I2C device.
+  @return  Sequence number, always even.
+
+****************************************************************************************************
+*/
+os_uint pins_device_read_begin(
+    PinsBusDevice *device)
+{
+    os_uint seq;
+
+    while ((seq = device->seq) & 1) {
+        os_timeslice();
+    }
+    PINS_MEMORY_BARRIER();
+    return seq;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get number of devices which are still waiting for initialization.
+  @anchor pins_devicebus_pending
+
+  When pins_setup() is called with PINS_DEFER_DEVICE_INIT flag, the slow platform
+  initialization (opening SPI or I2C device, etc) is done by devicebus, in devicebus thread
+  of the bus or in pins_run_devicebus(). Application can poll this function to know when
+  all devices are ready. Readiness of an individual device is in PinsBusDevice.init_state.
+
+  @return  Number of devices with PINS_DEVICE_INIT_PENDING state, 0 if all devices
+           have been initialized (successfully or not).
+
+****************************************************************************************************
+*/
+os_int pins_devicebus_pending(void)
+{
+    PinsBus *bus;
+    PinsBusDevice *device;
+    os_int n = 0;
+
+    for (bus = pins_devicebus.first_bus; bus; bus = bus->next_bus) {
+        for (device = bus->first_bus_device; device; device = device->next_device) {
+            if (device->init_state == PINS_DEVICE_INIT_PENDING) n++;
+        }
+    }
+    return n;
+}
+
+#endif
@@ -175,9 +175,62 @@ typedef struct PinsBusDevice
 
     /* Extended device data structure */
     void *ext;
+
+    /** Sequence lock counter for values in ext, odd while writer is updating them.
+        See PINS_DEVICE_WRITE_BEGIN() and PINS_DEVICE_READ_BEGIN().
+     */
+    volatile os_uint seq;
+
+    /** Platform initialization state of the device, see pinsDeviceInitState. Set by
+        pins_init_device(), or later by devicebus when device initialization is deferred.
+     */
+    volatile os_char init_state;
 }
 PinsBusDevice;
 
+/** SPI or I2C device initialization state (PinsBusDevice.init_state).
+ */
+typedef enum pinsDeviceInitState
+{
+    /** Device has not been opened yet, pins_setup() was called with PINS_DEFER_DEVICE_INIT
+        flag. Devicebus opens the device when the device gets it's first turn.
+     */
+    PINS_DEVICE_INIT_PENDING = 0,
+
+    /** Device is open and in use.
+     */
+    PINS_DEVICE_READY = 1,
+
+    /** Opening the device failed, devicebus skips it.
+     */
+    PINS_DEVICE_INIT_FAILED = 2
+}
+pinsDeviceInitState;
+
+/* Sequence lock to publish driver values between devicebus thread and the main loop without
+   mutex. There must be only one writer for a device. Reader copies the values and retries
+   if the writer was updating them at the same time:
+
+        PINS_DEVICE_WRITE_BEGIN(device);
+        ext->value[ch] = x; ext->state_bits[ch] = s;
+        PINS_DEVICE_WRITE_END(device);
+
+        do {
+            seq = PINS_DEVICE_READ_BEGIN(device);
+            x = ext->value[ch]; s = ext->state_bits[ch];
+        }
+        while (PINS_DEVICE_READ_RETRY(device, seq));
+ */
+#define PINS_DEVICE_WRITE_BEGIN(d) do {(d)->seq++; PINS_MEMORY_BARRIER();} while (0)
+#define PINS_DEVICE_WRITE_END(d) do {PINS_MEMORY_BARRIER(); (d)->seq++;} while (0)
+#define PINS_DEVICE_READ_BEGIN(d) pins_device_read_begin(d)
+#define PINS_DEVICE_READ_RETRY(d, s) (PINS_MEMORY_BARRIER(), (d)->seq != (s))
+
+/* Wait until device values are not being written and get sequence number.
+ */
+os_uint pins_device_read_begin(
+    PinsBusDevice *device);
+
 
 /** SPI message buffer size, bytes.
  */
@@ -279,6 +332,11 @@ typedef struct PinsDeviceBus
      */
     PinsBus *current_bus;
 
+    /** Open devices when devicebus gives them the first turn, not in pins_init_device().
+        Set by pins_setup() from PINS_DEFER_DEVICE_INIT flag.
+     */
+    os_boolean defer_device_init;
+
 #if OSAL_MULTITHREAD_SUPPORT
     /** Number of threads running.
      */
@@ -299,6 +357,38 @@ typedef struct PinsBusDeviceParams
 }
 PinsBusDeviceParams;
 
+/** SPI or I2C device driver, for configurations loaded at run time which name drivers by
+    "driver" attribute, see pins_json_config.h and pins_config_blob.h. These are the functions
+    which pins_to_c.py would refer to in generated code.
+ */
+typedef struct PinsBusDriver
+{
+    const os_char *name;
+    void (*initialize_driver)(void);
+    void (*initialize_device)(struct PinsBusDevice *device);
+    pinsBusInitializePin *initialize_pin;
+    pinsGenerateDeviceRequest *gen_req;
+    pinsProcessDeviceResponce *proc_resp;
+    pinsBusSet *set;
+    pinsBusGet *get;
+}
+PinsBusDriver;
+
+/** Declare driver functions and driver table entry by driver name, like
+    PINS_BUS_DRIVER(pins_adc_mcp3208).
+ */
+#define PINS_BUS_DRIVER_DECL(d) \
+    void d##_initialize_driver(void); \
+    void d##_initialize_device(struct PinsBusDevice *device); \
+    void d##_initialize_pin(const struct Pin *pin); \
+    osalStatus d##_gen_req(struct PinsBusDevice *device); \
+    osalStatus d##_proc_resp(struct PinsBusDevice *device); \
+    osalStatus d##_set(struct PinsBusDevice *device, os_short addr, os_int value); \
+    os_int d##_get(struct PinsBusDevice *device, os_short addr, os_char *state_bits);
+
+#define PINS_BUS_DRIVER(d) {#d, d##_initialize_driver, d##_initialize_device, \
+    d##_initialize_pin, d##_gen_req, d##_proc_resp, d##_set, d##_get}
+
 /* Global device bus main structure.
  */
 extern PinsDeviceBus pins_devicebus;
@@ -313,6 +403,10 @@ void pins_init_device(
 void pins_close_device(
     struct PinsBusDevice *device);
 
+/* Number of SPI and I2C devices which have not yet been initialized (0 = all ready).
+ */
+os_int pins_devicebus_pending(void);
+
 
 /* Single threaded use. Call from main loop to run device bus.
  */
@@ -93,6 +93,9 @@
 
 /* Forward referred static functions.
  */
+static void pins_open_device(
+    struct PinsBusDevice *device);
+
 static osalStatus pins_spi_transfer(
     PinsBusDevice *device);
 
@@ -231,7 +234,6 @@ void pins_init_device(
     struct PinsBusDeviceParams *prm)
 {
     PinsBus *bus;
-    os_int rval;
 #if OSAL_DEBUG
     os_char buf[128], nbuf[OSAL_NBUF_SZ];
 #endif
@@ -242,6 +244,7 @@ void pins_init_device(
     /* Clear bus type specific variables for the device.
      */
     os_memclear(&device->spec, sizeof (PinsDeviceVariables));
+    device->init_state = PINS_DEVICE_INIT_PENDING;
 
 #if PINS_SPI
     if (bus->bus_type == PINS_SPI_BUS)
@@ -290,6 +293,102 @@ void pins_init_device(
 
         osal_info("pins", OSAL_SUCCESS, buf);
 #endif
+    }
+#endif
+
+#if PINS_I2C
+    if (bus->bus_type == PINS_I2C_BUS)
+    {
+        /* Get flags and device number.
+         */
+        device->spec.i2c.flags = (os_ushort)pin_get_prm(device->device_pin, PIN_FLAGS);
+        device->spec.i2c.device_nr = device->device_pin->addr;
+
+#if OSAL_DEBUG
+        os_strncpy(buf, "I2C device init: ", sizeof(buf));
+
+        os_strncat(buf, "device_nr=", sizeof(buf));
+        osal_int_to_str(nbuf, sizeof(nbuf), device->spec.i2c.device_nr);
+        os_strncat(buf, nbuf, sizeof(buf));
+
+        os_strncat(buf, ", bus_nr=", sizeof(buf));
+        osal_int_to_str(nbuf, sizeof(nbuf), bus->spec.i2c.bus_nr);
+        os_strncat(buf, nbuf, sizeof(buf));
+
+        os_strncat(buf, ", sda=", sizeof(buf));
+        osal_int_to_str(nbuf, sizeof(nbuf), bus->spec.i2c.sda);
+        os_strncat(buf, nbuf, sizeof(buf));
+
+        os_strncat(buf, ", scl=", sizeof(buf));
+        osal_int_to_str(nbuf, sizeof(nbuf), bus->spec.i2c.scl);
+        os_strncat(buf, nbuf, sizeof(buf));
+
+        os_strncat(buf, ", flags=", sizeof(buf));
+        osal_int_to_str(nbuf, sizeof(nbuf), device->spec.i2c.flags);
+        os_strncat(buf, nbuf, sizeof(buf));
+
+        osal_info("pins", OSAL_SUCCESS, buf);
+
+        if (bus->spec.i2c.bus_nr != 1) {
+            osal_debug_error("Warning, other than I2C bus 1 selected. The bus 0 is reserved for camera, etc.");
+        }
+
+        if (bus->spec.i2c.bus_nr) {
+            if (bus->spec.i2c.sda != 2 ||
+                bus->spec.i2c.scl != 3)
+            {
+                osal_debug_error("Wrong I2C bus 1 pins.");
+                osal_debug_error("Must be: sda=2, scl=3.");
+            }
+        }
+        else {
+            if (bus->spec.i2c.sda != 0 ||
+                bus->spec.i2c.scl != 1)
+            {
+                osal_debug_error("Wrong I2C bus 0 pins.");
+                osal_debug_error("Must be: sda=0, scl=1.");
+            }
+        }
+#endif
+    }
+#endif
+
+    /* Open the device now, unless opening is left to devicebus.
+     */
+    if (!pins_devicebus.defer_device_init) {
+        pins_open_device(device);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Open SPI/I2C device.
+  @anchor pins_open_device
+
+  The pins_open_device() function opens a device set up by pins_init_device() and sets
+  device's init_state. This is the slow part of device initialization, called either from
+  pins_init_device() or, if device initialization is deferred, by devicebus when the
+  device gets its first turn.
+
+  @param   device Pointer to device structure.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_open_device(
+    struct PinsBusDevice *device)
+{
+    PinsBus *bus;
+    os_int rval;
+    os_boolean ok = OS_FALSE;
+
+    bus = device->bus;
+
+#if PINS_SPI
+    if (bus->bus_type == PINS_SPI_BUS)
+    {
         /* If re are using normal raspberry spi or bit banged version.
          */
         if (bus->spec.spi.bus_nr >= 10)
@@ -351,72 +450,25 @@ void pins_init_device(
                 osal_debug_error_int("spiOpen failed, rval=", rval);
             }
         }
+        ok = (os_boolean)(device->spec.spi.handle >= 0);
     }
 #endif
 
 #if PINS_I2C
     if (bus->bus_type == PINS_I2C_BUS)
     {
-        /* Get flags and device number.
-         */
-        device->spec.i2c.flags = (os_ushort)pin_get_prm(device->device_pin, PIN_FLAGS);
-        device->spec.i2c.device_nr = device->device_pin->addr;
-
-#if OSAL_DEBUG
-        os_strncpy(buf, "I2C device init: ", sizeof(buf));
-
-        os_strncat(buf, "device_nr=", sizeof(buf));
-        osal_int_to_str(nbuf, sizeof(nbuf), device->spec.i2c.device_nr);
-        os_strncat(buf, nbuf, sizeof(buf));
-
-        os_strncat(buf, ", bus_nr=", sizeof(buf));
-        osal_int_to_str(nbuf, sizeof(nbuf), bus->spec.i2c.bus_nr);
-        os_strncat(buf, nbuf, sizeof(buf));
-
-        os_strncat(buf, ", sda=", sizeof(buf));
-        osal_int_to_str(nbuf, sizeof(nbuf), bus->spec.i2c.sda);
-        os_strncat(buf, nbuf, sizeof(buf));
-
-        os_strncat(buf, ", scl=", sizeof(buf));
-        osal_int_to_str(nbuf, sizeof(nbuf), bus->spec.i2c.scl);
-        os_strncat(buf, nbuf, sizeof(buf));
-
-        os_strncat(buf, ", flags=", sizeof(buf));
-        osal_int_to_str(nbuf, sizeof(nbuf), device->spec.i2c.flags);
-        os_strncat(buf, nbuf, sizeof(buf));
-
-        osal_info("pins", OSAL_SUCCESS, buf);
-
-        if (bus->spec.i2c.bus_nr != 1) {
-            osal_debug_error("Warning, other than I2C bus 1 selected. The bus 0 is reserved for camera, etc.");
-        }
-
-        if (bus->spec.i2c.bus_nr) {
-            if (bus->spec.i2c.sda != 2 ||
-                bus->spec.i2c.scl != 3)
-            {
-                osal_debug_error("Wrong I2C bus 1 pins.");
-                osal_debug_error("Must be: sda=2, scl=3.");
-            }
-        }
-        else {
-            if (bus->spec.i2c.sda != 0 ||
-                bus->spec.i2c.scl != 1)
-            {
-                osal_debug_error("Wrong I2C bus 0 pins.");
-                osal_debug_error("Must be: sda=0, scl=1.");
-            }
-        }
-#endif
-
         rval = i2cOpen((unsigned)bus->spec.i2c.bus_nr,
             (unsigned)device->spec.i2c.device_nr, (unsigned)device->spec.i2c.flags);
         device->spec.i2c.handle = rval;
         if (rval < 0) {
             osal_debug_error_int("i2cOpen failed, rval=", rval);
         }
+        ok = (os_boolean)(rval >= 0);
     }
 #endif
+
+    PINS_MEMORY_BARRIER();
+    device->init_state = ok ? PINS_DEVICE_READY : PINS_DEVICE_INIT_FAILED;
 }
 
 
@@ -441,6 +493,9 @@ void pins_close_device(
     os_int rval;
 #endif
 
+    /* Nothing to close if device was never opened.
+     */
+    if (device->init_state != PINS_DEVICE_READY) return;
     bus = device->bus;
 
 #if PINS_SPI
@@ -511,6 +566,7 @@ void pins_run_devicebus(
     osalStatus s = OSAL_COMPLETED;
     OSAL_UNUSED(flags);
 
+    PINS_PROFILE_BEGIN(PINS_PROF_DEVICEBUS);
     bus = pins_devicebus.current_bus;
 
 #if PINS_SPI
@@ -531,6 +587,7 @@ void pins_run_devicebus(
         }
         pins_devicebus.current_bus = bus;
     }
+    PINS_PROFILE_END(PINS_PROF_DEVICEBUS);
 }
 
 
@@ -777,6 +834,12 @@ static osalStatus pins_bus_run_spi(
         }
     }
 
+    /* Open device on its first turn, if device initialization was deferred.
+     */
+    if (current_device->init_state == PINS_DEVICE_INIT_PENDING) {
+        pins_open_device(current_device);
+    }
+
     s = pins_spi_transfer(current_device);
 
     /* Move on to the next device ?
@@ -913,6 +976,12 @@ static osalStatus pins_bus_run_i2c(
         }
     }
 
+    /* Open device on its first turn, if device initialization was deferred.
+     */
+    if (current_device->init_state == PINS_DEVICE_INIT_PENDING) {
+        pins_open_device(current_device);
+    }
+
     s = pins_i2c_transfer(current_device);
 
     /* Move on to the next device ?
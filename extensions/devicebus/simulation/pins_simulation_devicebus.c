@@ -32,6 +32,9 @@
 
 /* Forward referred static functions.
  */
+static void pins_open_device(
+    struct PinsBusDevice *device);
+
 static osalStatus pins_spi_transfer(
     PinsBusDevice *device);
 
@@ -182,6 +185,7 @@ void pins_init_device(
     /* Clear bus type specific variables for the device.
      */
     os_memclear(&device->spec, sizeof (PinsDeviceVariables));
+    device->init_state = PINS_DEVICE_INIT_PENDING;
 
 #if PINS_SPI
     if (bus->bus_type == PINS_SPI_BUS)
@@ -287,6 +291,36 @@ void pins_init_device(
 #endif
     }
 #endif
+
+    /* Open the device now, unless opening is left to devicebus.
+     */
+    if (!pins_devicebus.defer_device_init) {
+        pins_open_device(device);
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Open SPI/I2C device.
+  @anchor pins_open_device
+
+  The pins_open_device() function opens a device set up by pins_init_device() and sets
+  device's init_state. Called either from pins_init_device() or, if device initialization
+  is deferred, by devicebus when the device gets its first turn. Simulated device is
+  always ready.
+
+  @param   device Pointer to device structure.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_open_device(
+    struct PinsBusDevice *device)
+{
+    PINS_MEMORY_BARRIER();
+    device->init_state = PINS_DEVICE_READY;
 }
 
 
@@ -328,6 +362,7 @@ void pins_run_devicebus(
     PinsBus *bus;
     osalStatus s = OSAL_STATUS_NOT_SUPPORTED;
 
+    PINS_PROFILE_BEGIN(PINS_PROF_DEVICEBUS);
     bus = pins_devicebus.current_bus;
 
 #if PINS_SPI
@@ -348,6 +383,7 @@ void pins_run_devicebus(
         }
         pins_devicebus.current_bus = bus;
     }
+    PINS_PROFILE_END(PINS_PROF_DEVICEBUS);
 }
 
 #if OSAL_MULTITHREAD_SUPPORT
@@ -539,7 +575,18 @@ static osalStatus pins_bus_run_spi(
 
     current_device = bus->current_device;
 
-    s = pins_spi_transfer(current_device);
+    /* Open device on its first turn, if device initialization was deferred. Skip devices
+       which could not be opened.
+     */
+    if (current_device->init_state == PINS_DEVICE_INIT_PENDING) {
+        pins_open_device(current_device);
+    }
+    if (current_device->init_state == PINS_DEVICE_READY) {
+        s = pins_spi_transfer(current_device);
+    }
+    else {
+        s = OSAL_PENDING;
+    }
 
     /* Move on to the next device ?
      */
@@ -613,7 +660,18 @@ static osalStatus pins_bus_run_i2c(
 
     current_device = bus->current_device;
 
-    s = pins_i2c_transfer(current_device);
+    /* Open device on its first turn, if device initialization was deferred. Skip devices
+       which could not be opened.
+     */
+    if (current_device->init_state == PINS_DEVICE_INIT_PENDING) {
+        pins_open_device(current_device);
+    }
+    if (current_device->init_state == PINS_DEVICE_READY) {
+        s = pins_i2c_transfer(current_device);
+    }
+    else {
+        s = OSAL_PENDING;
+    }
 
     /* Move on to the next device ?
      */
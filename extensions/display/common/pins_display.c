@@ -101,6 +101,7 @@ void run_display(
     os_timer localtimer;
     os_boolean led_on;
 
+    PINS_PROFILE_BEGIN(PINS_PROF_DISPLAY);
     if (timer == OS_NULL)
     {
         os_get_timer(&localtimer);
@@ -115,6 +116,7 @@ void run_display(
     }
 
     run_display_hw(display, timer);
+    PINS_PROFILE_END(PINS_PROF_DISPLAY);
 }
 
 
@@ -19,6 +19,14 @@
 static void pin_to_iocom(
     const Pin *pin);
 
+static void pins_to_iocom_flush(
+    const Pin **pins,
+    os_int n_pins);
+
+/* Maximum number of consecutive signals written with one ioc_moves() call.
+ */
+#define PINS_IOCOM_MOVE_BATCH 16
+
 
 /**
 ****************************************************************************************************
@@ -39,6 +47,7 @@ void pins_connect_iocom_library(
     /* Set function pointer to forward changes.
      */
     pin_to_iocom_func = pin_to_iocom;
+    pins_flush_iocom_func = pins_to_iocom_flush;
 
     pins_read_all(hdr, PINS_RESET_IOCOM);
 }
@@ -64,7 +73,7 @@ static void pin_to_iocom(
     os_int x;
     os_char state_bits;
 
-    s = pin->signal;
+    s = PIN_SIGNAL(pin);
 
     /* We cannot write to communication target memory nor change signals for it.
      */
@@ -79,13 +88,216 @@ static void pin_to_iocom(
     }
     else
     {
-        x = ((PinRV*)pin->prm)->value;
-        state_bits = ((PinRV*)pin->prm)->state_bits;
+        x = PIN_RV(pin)->value;
+        state_bits = PIN_RV(pin)->state_bits;
         ioc_set_ext(s, x, state_bits);
     }
 }
 
 
+/**
+****************************************************************************************************
+
+  @brief Write batch of changed pins as IOCOM signals (PIN -> IOCOM).
+
+  The pins_to_iocom_flush function is called by pins_flush_iocom() with journal of changed
+  pins. Pins are sorted by signal address, so pins of the same memory block are next to
+  each other. IOCOM root is locked once for all pins in the same root and signals
+  which follow each other in the signal structure and are in the same memory block are
+  written with one ioc_moves() call. The last signal of one memory block may be followed
+  directly by the first signal of the next one, so the batch is ended when handle changes.
+
+  @param   pins Array of changed pins. Sorted in place.
+  @param   n_pins Number of pins in array.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_to_iocom_flush(
+    const Pin **pins,
+    os_int n_pins)
+{
+    const Pin *pin;
+    const iocSignal *s, *first;
+    iocRoot *root;
+    iocValue values[PINS_IOCOM_MOVE_BATCH];
+    os_double d;
+    os_int i, j, n;
+    os_char state_bits, type_id;
+
+    /* Sort by signal pointer (insertion sort, journal is small and usually almost sorted).
+     */
+    for (i = 1; i < n_pins; i++)
+    {
+        pin = pins[i];
+        for (j = i; j > 0 && PIN_SIGNAL(pins[j - 1]) > PIN_SIGNAL(pin); j--) {
+            pins[j] = pins[j - 1];
+        }
+        pins[j] = pin;
+    }
+
+    root = OS_NULL;
+    first = OS_NULL;
+    n = 0;
+
+    for (i = 0; i < n_pins; i++)
+    {
+        pin = pins[i];
+        s = PIN_SIGNAL(pin);
+
+        /* Write pending signals if this one doesn't follow the previous one in the same
+           memory block.
+         */
+        if (n && (s != first + n || s->handle != first->handle ||
+            n >= PINS_IOCOM_MOVE_BATCH))
+        {
+            ioc_moves(first, values, n, IOC_SIGNAL_WRITE|IOC_SIGNAL_NO_THREAD_SYNC);
+            n = 0;
+        }
+
+        /* We cannot write to communication target memory nor change signals for it.
+         */
+        if (s->handle->flags & IOC_MBLK_DOWN) continue;
+
+        if (s->handle->root != root)
+        {
+            if (n) {
+                ioc_moves(first, values, n, IOC_SIGNAL_WRITE|IOC_SIGNAL_NO_THREAD_SYNC);
+                n = 0;
+            }
+            if (root) ioc_unlock(root);
+            root = s->handle->root;
+            ioc_lock(root);
+        }
+
+        if (n == 0) first = s;
+        os_memclear(values + n, sizeof(iocValue));
+
+        if (pin->flags & PIN_SCALING_SET)
+        {
+            d = pin_value_scaled(pin, &state_bits);
+            type_id = (os_char)(s->flags & OSAL_TYPEID_MASK);
+            if (type_id == OS_FLOAT || type_id == OS_DOUBLE) {
+                values[n].value.d = d;
+            }
+            else {
+                values[n].value.l = os_round_int(d);
+            }
+        }
+        else
+        {
+            values[n].value.l = PIN_RV(pin)->value;
+            state_bits = PIN_RV(pin)->state_bits;
+        }
+        values[n++].state_bits = state_bits;
+    }
+
+    if (n) {
+        ioc_moves(first, values, n, IOC_SIGNAL_WRITE|IOC_SIGNAL_NO_THREAD_SYNC);
+    }
+    if (root) {
+        ioc_unlock(root);
+    }
+}
+
+
+#if PINS_SAMPLING
+/**
+****************************************************************************************************
+
+  @brief Write block of samples to IOCOM array signal.
+
+  The pins_samples_to_iocom function moves one block of samples from sample channel's ring
+  buffer to IOCOM array signal. Block size is the signal's array size, and nothing is written
+  until whole block is available. The signal must be "int" array.
+
+  @param   channel Pointer to sample channel.
+  @param   signal IOCOM array signal to write to.
+  @return  Number of samples written, either 0 or signal->n.
+
+****************************************************************************************************
+*/
+os_int pins_samples_to_iocom(
+    PinsSampleChannel *channel,
+    const iocSignal *signal)
+{
+    os_int buf[PINS_IOCOM_MOVE_BATCH * 4];
+    os_int offset, n;
+
+    if (signal->handle->flags & IOC_MBLK_DOWN) return 0;
+    if (pins_get_sample_count(channel) < signal->n) return 0;
+
+    ioc_lock(signal->handle->root);
+    for (offset = 0; offset < signal->n; offset += n)
+    {
+        n = signal->n - offset;
+        if (n > (os_int)(sizeof(buf) / sizeof(os_int))) n = sizeof(buf) / sizeof(os_int);
+        n = pins_get_samples(channel, buf, n);
+        ioc_moves_array(signal, offset, buf, n, OSAL_STATE_CONNECTED,
+            IOC_SIGNAL_WRITE|IOC_SIGNAL_NO_THREAD_SYNC);
+    }
+    ioc_unlock(signal->handle->root);
+    return signal->n;
+}
+#endif
+
+
+#if PINS_STATISTICS
+/**
+****************************************************************************************************
+
+  @brief Publish pin statistics summary as IOCOM array signal.
+
+  The pins_stats_to_iocom function writes summary of pin's statistics to "int" array signal:
+  n_reads, n_writes, n_changes, median, 99th percentile and maximum read latency, median,
+  99th percentile and maximum write latency. If pin is OS_NULL, the summary is of
+  pins_read_all() calls: number of calls, median, 99th percentile and maximum duration.
+  Latencies are in microseconds. If signal array is shorter, the summary is truncated.
+
+  @param   pin Pointer to pin configuration structure, OS_NULL for pins_read_all() summary.
+  @param   signal IOCOM array signal to write to.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_stats_to_iocom(
+    const Pin *pin,
+    const iocSignal *signal)
+{
+    PinStats stats;
+    PinsLatencyHist hist;
+    os_int buf[9], n;
+
+    if (pin)
+    {
+        if (pins_get_pin_stats(pin, &stats)) return;
+        buf[0] = (os_int)stats.n_reads;
+        buf[1] = (os_int)stats.n_writes;
+        buf[2] = (os_int)stats.n_changes;
+        buf[3] = (os_int)pins_latency_percentile(&stats.read_latency, 500);
+        buf[4] = (os_int)pins_latency_percentile(&stats.read_latency, 990);
+        buf[5] = (os_int)stats.read_latency.max_ticks;
+        buf[6] = (os_int)pins_latency_percentile(&stats.write_latency, 500);
+        buf[7] = (os_int)pins_latency_percentile(&stats.write_latency, 990);
+        buf[8] = (os_int)stats.write_latency.max_ticks;
+        n = 9;
+    }
+    else
+    {
+        pins_get_read_all_stats(&hist);
+        buf[0] = (os_int)hist.count;
+        buf[1] = (os_int)pins_latency_percentile(&hist, 500);
+        buf[2] = (os_int)pins_latency_percentile(&hist, 990);
+        buf[3] = (os_int)hist.max_ticks;
+        n = 4;
+    }
+
+    if (n > signal->n) n = signal->n;
+    ioc_moves_array(signal, 0, buf, n, OSAL_STATE_CONNECTED, IOC_SIGNAL_WRITE);
+}
+#endif
+
+
 /**
 ****************************************************************************************************
 
@@ -165,7 +377,7 @@ osal_debug_error("planning to OBSOLETE this function, replaced by more efficient
                 if (state_bits & OSAL_STATE_CONNECTED)
                 {
                     pin_ll_set(pin, x);
-                    ((PinRV*)pin->prm)->value = x;
+                    PIN_RV(pin)->value = x;
                 }
             }
         }
@@ -47,6 +47,22 @@ void forward_signal_change_to_io_pin(
     const iocSignal *sig,
     os_short flags);
 
+#if PINS_SAMPLING
+/* Write block of samples to IOCOM array signal.
+ */
+os_int pins_samples_to_iocom(
+    PinsSampleChannel *channel,
+    const iocSignal *signal);
+#endif
+
+#if PINS_STATISTICS
+/* Publish pin or pins_read_all() statistics summary as IOCOM array signal.
+ */
+void pins_stats_to_iocom(
+    const Pin *pin,
+    const iocSignal *signal);
+#endif
+
 /* Forward data data received from communication to IO pins.
  */
 void pins_default_iocom_callback(
@@ -0,0 +1,1348 @@
+/**
+
+  @file    json_config/common/pins_json_config.c
+  @brief   Load pin configuration from JSON at run time.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  JSON is walked twice with eosal's JSON indexer. First pass counts pins, parameters, etc.
+  to size the arena, second pass fills it in. Pin group blocks and IO devices can have their
+  "name" after "pins" or "groups", so names found on first pass are used on second one.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pinsx.h"
+#if PINS_JSON_CONFIG
+
+/* Maximum JSON nesting depth.
+ */
+#define PINS_JSON_MAX_DEPTH 16
+
+/* Arena items are aligned to 8 bytes, for os_double in PinScaling.
+ */
+#define PINS_JSON_ALIGN(n) (((n) + 7) & ~(os_memsz)7)
+
+/* Reserve for group name in "group.pin" names on first pass, longest is "analog_outputs".
+ */
+#define PINS_JSON_TYPE_NAME_SZ 16
+
+/** Where we are in JSON.
+ */
+typedef enum
+{
+    PINS_JCTX_OTHER,
+    PINS_JCTX_ROOT,
+    PINS_JCTX_IO,
+    PINS_JCTX_DEVICE,
+    PINS_JCTX_GROUPS,
+    PINS_JCTX_GROUP,
+    PINS_JCTX_PINS,
+    PINS_JCTX_PIN
+}
+pinsJsonCtx;
+
+/** Name to number, for pin types, parameters and simulated input sources.
+ */
+typedef struct PinsJsonName
+{
+    const os_char *name;
+    os_char id;
+}
+PinsJsonName;
+
+/* Pin group names, same as pin_types in pins_to_c.py.
+ */
+static OS_CONST PinsJsonName pins_json_types[] = {
+    {"inputs", PIN_INPUT},
+    {"outputs", PIN_OUTPUT},
+    {"analog_inputs", PIN_ANALOG_INPUT},
+    {"analog_outputs", PIN_ANALOG_OUTPUT},
+    {"pwm", PIN_PWM},
+    {"spi", PIN_SPI},
+    {"i2c", PIN_I2C},
+    {"timers", PIN_TIMER},
+    {"cameras", PIN_CAMERA},
+    {"uart", PIN_UART}};
+
+/* Pin attributes which are parameters, same as prm_type_list in pins_to_c.py.
+ */
+static OS_CONST PinsJsonName pins_json_prms[] = {
+    {"pull-up", PIN_PULL_UP},
+    {"pull-down", PIN_PULL_DOWN},
+    {"touch", PIN_TOUCH},
+    {"frequency", PIN_FREQENCY},
+    {"frequency-kHz", PIN_FREQENCY_KHZ},
+    {"frequency-MHz", PIN_FREQENCY_MHZ},
+    {"resolution", PIN_RESOLUTION},
+    {"init", PIN_INIT},
+    {"hpoint", PIN_HPOINT},
+    {"interrupt", PIN_INTERRUPT_ENABLED},
+    {"timer", PIN_TIMER_SELECT},
+    {"tgroup", PIN_TIMER_GROUP_SELECT},
+    {"miso", PIN_MISO},
+    {"mosi", PIN_MOSI},
+    {"sclk", PIN_SCLK},
+    {"sda", PIN_SDA},
+    {"scl", PIN_SCL},
+    {"cs", PIN_CS},
+    {"dc", PIN_DC},
+    {"rx", PIN_RX},
+    {"tx", PIN_TX},
+    {"tc", PIN_TRANSMITTER_CTRL},
+    {"speed", PIN_SPEED},
+    {"speed-kbps", PIN_SPEED_KBPS},
+    {"flags", PIN_FLAGS},
+    {"pin-a", PIN_A},
+    {"pin-b", PIN_B},
+    {"pin-c", PIN_C},
+    {"pin-d", PIN_D},
+    {"pin-e", PIN_E},
+    {"bank-a", PIN_A_BANK},
+    {"bank-b", PIN_B_BANK},
+    {"bank-c", PIN_C_BANK},
+    {"bank-d", PIN_D_BANK},
+    {"bank-e", PIN_E_BANK},
+    {"min", PIN_MIN},
+    {"max", PIN_MAX},
+    {"smin", PIN_SMIN},
+    {"smax", PIN_SMAX},
+    {"digs", PIN_DIGS},
+    {"avg", PIN_AVG},
+    {"iir", PIN_IIR},
+    {"deadband", PIN_DEADBAND},
+    {"deadband-rel", PIN_DEADBAND_REL},
+    {"debounce-ms", PIN_DEBOUNCE},
+    {"sim", PIN_SIM},
+    {"sim-period-ms", PIN_SIM_PERIOD},
+    {"sim-min", PIN_SIM_MIN},
+    {"sim-max", PIN_SIM_MAX},
+    {"sim-seed", PIN_SIM_SEED},
+    {"sim-column", PIN_SIM_COLUMN}};
+
+/* Values of "sim" attribute.
+ */
+static OS_CONST PinsJsonName pins_json_sim_sources[] = {
+    {"random", PIN_SIM_RANDOM},
+    {"const", PIN_SIM_CONST},
+    {"square", PIN_SIM_SQUARE},
+    {"sine", PIN_SIM_SINE},
+    {"ramp", PIN_SIM_RAMP},
+    {"noise", PIN_SIM_NOISE},
+    {"replay", PIN_SIM_REPLAY}};
+
+#define PINS_JSON_NAMES(t) ((os_int)(sizeof(t) / sizeof(PinsJsonName)))
+
+/** Attributes of pin being parsed.
+ */
+typedef struct PinsJsonPin
+{
+    const os_char *name;
+    const os_char *group;
+    const os_char *device;
+    const os_char *driver;
+    os_int addr, bank;
+    os_int history;
+    PinPrmValue prm[PIN_NRO_PRMS];
+    os_int prm_n;
+    os_boolean has_interrupt;
+    os_boolean has_scaling;
+    os_boolean has_filter;
+}
+PinsJsonPin;
+
+/** Loader state.
+ */
+typedef struct PinsJsonLoader
+{
+    /** Configuration being filled, OS_NULL on first pass which only counts.
+     */
+    PinsJsonConfig *config;
+
+    /** IO device to load, OS_NULL for first one, and driver table from application.
+     */
+    const os_char *device_name;
+    const struct PinsBusDriver *drivers;
+    os_int n_drivers;
+
+    /** Context stack.
+     */
+    pinsJsonCtx ctx[PINS_JSON_MAX_DEPTH];
+    os_int depth;
+
+    /** IO device and group block numbers in JSON, selected IO device found on first
+        pass and pin type of each group block, -1 if not a pin group.
+     */
+    os_int device_nr, device_select;
+    os_int group_nr;
+    os_char group_type[PINS_JSON_MAX_GROUPS];
+
+    /** Group block being parsed: First pin and scan period.
+     */
+    os_int group_pin0;
+    os_int scan_ms;
+
+    /** Pin being parsed.
+     */
+    PinsJsonPin pin;
+
+    /** Counts, on second pass also number of items filled in.
+     */
+    os_int n_groups;
+    os_int n_pins;
+    os_int n_prm;
+    os_int n_int_conf;
+    os_int n_scaling;
+    os_int n_filter;
+    os_int n_history;
+    os_int n_history_entries;
+    os_int n_scan;
+    os_int n_app_groups;
+    os_int n_devices;
+    os_int n_device_refs;
+    os_memsz str_sz;
+
+    /** Arena items filled on second pass.
+     */
+    PinGroupHdr *group;
+    const PinGroupHdr **group_list;
+    PinPrmValue *prm;
+#if PINS_SIMULATED_INTERRUPTS
+    PinInterruptConf *int_conf;
+#endif
+#if PINS_SCALING_CACHE
+    PinScaling *scaling;
+#endif
+#if PINS_INPUT_FILTERS
+    PinFilter *filter;
+#endif
+#if PINS_SCAN_SCHEDULER
+    PinGroupScan *scan;
+#endif
+#if PINS_HISTORY
+    PinHistory *history;
+    PinHistoryEntry *history_entry;
+#endif
+    os_char *str;
+    os_memsz str_pos;
+
+#if PINS_SPI || PINS_I2C
+    /** Buses and "device" attribute of each pin, temporary table.
+     */
+    PinsBus *bus;
+    const os_char **device_ref;
+#endif
+
+    osalStatus status;
+}
+PinsJsonLoader;
+
+#if PINS_JSON_CONFIG_ONLY && (PINS_SPI || PINS_I2C)
+/* Device bus main structure, normally in generated code.
+ */
+PinsDeviceBus pins_devicebus;
+
+/* Most recently loaded configuration, bus devices of which pins_initialize_bus_devices()
+   initializes.
+ */
+static PinsJsonConfig *pins_json_bus_config;
+#endif
+
+/* Forward referred static functions.
+ */
+static osalStatus pins_json_walk(
+    PinsJsonLoader *ld,
+    const os_char *json,
+    os_memsz json_sz);
+
+static pinsJsonCtx pins_json_enter(
+    PinsJsonLoader *ld,
+    pinsJsonCtx parent,
+    osalJsonItem *item);
+
+static void pins_json_value(
+    PinsJsonLoader *ld,
+    pinsJsonCtx ctx,
+    osalJsonItem *item);
+
+static void pins_json_pin_attr(
+    PinsJsonLoader *ld,
+    osalJsonItem *item);
+
+static void pins_json_add_pin(
+    PinsJsonLoader *ld);
+
+static void pins_json_add_group(
+    PinsJsonLoader *ld);
+
+static os_memsz pins_json_layout(
+    PinsJsonLoader *ld,
+    os_char *arena);
+
+#if PINS_SPI || PINS_I2C
+static void pins_json_link_devices(
+    PinsJsonLoader *ld);
+#endif
+
+static os_int pins_json_lookup(
+    const PinsJsonName *table,
+    os_int n,
+    const os_char *name);
+
+static os_int pins_json_int(
+    osalJsonItem *item);
+
+static const os_char *pins_json_copy_str(
+    PinsJsonLoader *ld,
+    const os_char *a,
+    const os_char *b);
+
+
+/**
+****************************************************************************************************
+
+  @brief Load pin configuration from compressed JSON.
+  @anchor pins_load_json_config
+
+  The pins_load_json_config() function builds pin configuration from packed JSON, which has
+  the same content as pins_io.json given to pins_to_c.py. Everything is placed in one memory
+  block, which is released by pins_free_json_config(). JSON data is not referred to after
+  the function returns. Pass &config->hdr to pins_setup().
+
+  @param   config Where to store pointer to loaded configuration. Set to OS_NULL if the
+           function fails.
+  @param   json Compressed JSON, see osal_compress_json().
+  @param   json_sz JSON size in bytes.
+  @param   device_name Name of IO device to load, OS_NULL to load the first one.
+  @param   drivers SPI and I2C driver table, like {PINS_BUS_DRIVER(pins_adc_mcp3208)}.
+           OS_NULL if JSON has no SPI or I2C devices.
+  @param   n_drivers Number of drivers in table.
+  @return  OSAL_SUCCESS if configuration was loaded. OSAL_STATUS_MEMORY_ALLOCATION_FAILED
+           if out of memory, other values indicate an error in JSON.
+
+****************************************************************************************************
+*/
+osalStatus pins_load_json_config(
+    PinsJsonConfig **config,
+    const os_char *json,
+    os_memsz json_sz,
+    const os_char *device_name,
+    const struct PinsBusDriver *drivers,
+    os_int n_drivers)
+{
+    PinsJsonLoader ld;
+    PinsJsonConfig *c;
+    os_char *arena;
+    os_memsz arena_sz;
+    osalStatus s;
+
+    *config = OS_NULL;
+    os_memclear(&ld, sizeof(ld));
+    ld.device_name = device_name;
+    ld.drivers = drivers;
+    ld.n_drivers = n_drivers;
+
+    /* First pass, count items.
+     */
+    ld.device_select = -1;
+    s = pins_json_walk(&ld, json, json_sz);
+    if (s) return s;
+    if (ld.device_select < 0) {
+        osal_debug_error_str("pins_load_json_config: IO device not found ",
+            device_name ? device_name : "");
+        return OSAL_STATUS_FAILED;
+    }
+
+    arena_sz = pins_json_layout(&ld, OS_NULL);
+    arena = (os_char*)os_malloc(arena_sz, OS_NULL);
+    if (arena == OS_NULL) return OSAL_STATUS_MEMORY_ALLOCATION_FAILED;
+    os_memclear(arena, arena_sz);
+    pins_json_layout(&ld, arena);
+    c = ld.config;
+    c->arena_sz = arena_sz;
+
+#if PINS_SPI || PINS_I2C
+    if (ld.n_device_refs) {
+        ld.device_ref = (const os_char**)os_malloc(ld.n_pins * sizeof(os_char*), OS_NULL);
+        if (ld.device_ref == OS_NULL) {
+            os_free(arena, arena_sz);
+            return OSAL_STATUS_MEMORY_ALLOCATION_FAILED;
+        }
+        os_memclear((void*)ld.device_ref, ld.n_pins * sizeof(os_char*));
+    }
+#endif
+
+    /* Second pass, fill in.
+     */
+    s = pins_json_walk(&ld, json, json_sz);
+    if (s == OSAL_SUCCESS)
+    {
+        c->hdr.group = ld.group_list;
+        c->hdr.n_groups = (os_short)ld.n_groups;
+        c->hdr.n_rv = (os_short)ld.n_pins;
+        c->n_pins = (os_short)ld.n_pins;
+        c->n_app_groups = (os_short)ld.n_app_groups;
+#if PINS_SPI || PINS_I2C
+        c->n_devices = (os_short)ld.n_devices;
+        pins_json_link_devices(&ld);
+        s = ld.status;
+#endif
+    }
+
+#if PINS_SPI || PINS_I2C
+    if (ld.device_ref) {
+        os_free((void*)ld.device_ref, ld.n_pins * sizeof(os_char*));
+    }
+#endif
+
+    if (s) {
+        os_free(arena, arena_sz);
+        return s;
+    }
+
+#if PINS_JSON_CONFIG_ONLY && (PINS_SPI || PINS_I2C)
+    pins_json_bus_config = c;
+#endif
+    *config = c;
+    return OSAL_SUCCESS;
+}
+
+
+#if OSAL_JSON_TEXT_SUPPORT
+/**
+****************************************************************************************************
+
+  @brief Load pin configuration from JSON text.
+  @anchor pins_load_json_config_text
+
+  The pins_load_json_config_text() function compresses JSON text, like contents of
+  pins_io.json file, and loads configuration from it by pins_load_json_config().
+
+  @param   config Where to store pointer to loaded configuration.
+  @param   json_text JSON text, '\0' terminated.
+  @param   device_name Name of IO device to load, OS_NULL to load the first one.
+  @param   drivers SPI and I2C driver table, OS_NULL if none.
+  @param   n_drivers Number of drivers in table.
+  @return  OSAL_SUCCESS if configuration was loaded, other values indicate an error.
+
+****************************************************************************************************
+*/
+osalStatus pins_load_json_config_text(
+    PinsJsonConfig **config,
+    const os_char *json_text,
+    const os_char *device_name,
+    const struct PinsBusDriver *drivers,
+    os_int n_drivers)
+{
+    osalStream compressed;
+    os_char *data;
+    os_memsz data_sz;
+    osalStatus s;
+
+    *config = OS_NULL;
+    compressed = osal_stream_buffer_open(OS_NULL, OS_NULL, OS_NULL, OSAL_STREAM_DEFAULT);
+    if (compressed == OS_NULL) return OSAL_STATUS_MEMORY_ALLOCATION_FAILED;
+
+    s = osal_compress_json(compressed, json_text, OS_NULL, 0);
+    if (s == OSAL_SUCCESS)
+    {
+        data = osal_stream_buffer_content(compressed, &data_sz);
+        s = pins_load_json_config(config, data, data_sz, device_name, drivers, n_drivers);
+    }
+
+    osal_stream_close(compressed, OSAL_STREAM_DEFAULT);
+    return s;
+}
+#endif
+
+
+/**
+****************************************************************************************************
+
+  @brief Release loaded configuration.
+  @anchor pins_free_json_config
+
+  The pins_free_json_config() function frees the arena. Pins must not be in use: Call
+  pins_shutdown() and stop device bus first, if these were started.
+
+  @param   config Configuration loaded by pins_load_json_config(), OS_NULL is ignored.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_free_json_config(
+    PinsJsonConfig *config)
+{
+    if (config == OS_NULL) return;
+#if PINS_JSON_CONFIG_ONLY && (PINS_SPI || PINS_I2C)
+    if (pins_json_bus_config == config) {
+        pins_json_bus_config = OS_NULL;
+    }
+#endif
+    os_free(config, config->arena_sz);
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Find pin by name.
+  @anchor pins_find_json_pin
+
+  The pins_find_json_pin() function looks up a pin of loaded configuration by "group.pin"
+  name, like "inputs.dip_switch_3", or first pin of application pin group by group name.
+  Names are compared one by one, look pins up once after loading and keep the pointers.
+
+  @param   config Loaded configuration.
+  @param   name Name to look for.
+  @return  Pointer to pin structure, OS_NULL if not found.
+
+****************************************************************************************************
+*/
+const Pin *pins_find_json_pin(
+    const PinsJsonConfig *config,
+    const os_char *name)
+{
+    os_int i;
+
+    for (i = 0; i < config->n_pins; i++) {
+        if (!os_strcmp(config->pin_name[i], name)) return config->pin + i;
+    }
+    for (i = 0; i < config->n_app_groups; i++) {
+        if (!os_strcmp(config->app_group[i].name, name)) return config->app_group[i].pin;
+    }
+    return OS_NULL;
+}
+
+
+#if PINS_SPI || PINS_I2C
+/**
+****************************************************************************************************
+
+  @brief Initialize SPI and I2C buses and devices of loaded configuration.
+  @anchor pins_initialize_json_bus_devices
+
+  The pins_initialize_json_bus_devices() function does for loaded configuration what
+  generated pins_initialize_bus_devices() does: Makes the buses the ones pins_devicebus
+  runs, and initializes buses, drivers, devices and pins on devices.
+
+  @param   config Loaded configuration.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_initialize_json_bus_devices(
+    PinsJsonConfig *config)
+{
+    PinsBus *bus;
+    const Pin *pin;
+    os_int i, j;
+
+    pins_devicebus.first_bus = config->first_bus;
+    for (bus = config->first_bus; bus; bus = bus->next_bus) {
+        pins_init_bus(bus);
+    }
+
+    for (i = 0; i < config->n_devices; i++)
+    {
+        for (j = 0; j < i; j++) {
+            if (config->device_driver[j] == config->device_driver[i]) break;
+        }
+        if (j == i) {
+            config->device_driver[i]->initialize_driver();
+        }
+    }
+
+    for (i = 0; i < config->n_devices; i++) {
+        config->device_driver[i]->initialize_device(config->device + i);
+    }
+
+    for (i = 0, pin = config->pin; i < config->n_pins; i++, pin++) {
+        if (pin->bus_device) {
+            pin->bus_device->initialize_pin_func(pin);
+        }
+    }
+}
+#endif
+
+
+#if PINS_JSON_CONFIG_ONLY && (PINS_SPI || PINS_I2C)
+/**
+****************************************************************************************************
+
+  @brief Initialize SPI and I2C bus devices, called by pins_setup().
+  @anchor pins_initialize_bus_devices
+
+  Replaces the generated function when application has no generated configuration.
+  Initializes bus devices of most recently loaded configuration.
+
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_initialize_bus_devices(void)
+{
+    if (pins_json_bus_config) {
+        pins_initialize_json_bus_devices(pins_json_bus_config);
+    }
+}
+#endif
+
+
+/**
+****************************************************************************************************
+
+  @brief Walk trough JSON.
+  @anchor pins_json_walk
+
+  Counts items on first pass and fills in the arena on second pass.
+
+  @param   ld Loader state.
+  @param   json Compressed JSON.
+  @param   json_sz JSON size in bytes.
+  @return  OSAL_SUCCESS if all fine, other values indicate an error.
+
+****************************************************************************************************
+*/
+static osalStatus pins_json_walk(
+    PinsJsonLoader *ld,
+    const os_char *json,
+    os_memsz json_sz)
+{
+    osalJsonIndex jindex;
+    osalJsonItem item;
+    pinsJsonCtx ctx;
+    osalStatus s;
+
+    s = osal_create_json_indexer(&jindex, (os_char*)json, json_sz, 0);
+    if (s) return s;
+
+    ld->depth = 0;
+    ld->device_nr = ld->group_nr = 0;
+    ld->n_groups = ld->n_pins = ld->n_prm = ld->n_int_conf = ld->n_scaling = 0;
+    ld->n_filter = ld->n_scan = ld->n_app_groups = ld->n_devices = ld->n_device_refs = 0;
+    ld->n_history = ld->n_history_entries = 0;
+    ld->str_pos = 0;
+    ld->status = OSAL_SUCCESS;
+
+    while (osal_get_json_item(&jindex, &item) == OSAL_SUCCESS && ld->status == OSAL_SUCCESS)
+    {
+        switch (item.code)
+        {
+            case OSAL_JSON_START_BLOCK:
+            case OSAL_JSON_START_ARRAY:
+                if (ld->depth >= PINS_JSON_MAX_DEPTH) return OSAL_STATUS_FAILED;
+                ctx = pins_json_enter(ld, ld->depth ? ld->ctx[ld->depth - 1] : PINS_JCTX_OTHER,
+                    &item);
+                if (ld->depth == 0 && item.code == OSAL_JSON_START_BLOCK) {
+                    ctx = PINS_JCTX_ROOT;
+                }
+                ld->ctx[ld->depth++] = ctx;
+                break;
+
+            case OSAL_JSON_END_BLOCK:
+            case OSAL_JSON_END_ARRAY:
+                if (ld->depth == 0) return OSAL_STATUS_FAILED;
+                ctx = ld->ctx[--ld->depth];
+                if (ctx == PINS_JCTX_PIN) {
+                    pins_json_add_pin(ld);
+                }
+                else if (ctx == PINS_JCTX_GROUP) {
+                    pins_json_add_group(ld);
+                }
+                break;
+
+            default:
+                if (ld->depth) {
+                    pins_json_value(ld, ld->ctx[ld->depth - 1], &item);
+                }
+                break;
+        }
+    }
+
+    if (ld->status) return ld->status;
+    return ld->depth ? OSAL_STATUS_FAILED : OSAL_SUCCESS;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Start JSON block or array.
+  @anchor pins_json_enter
+
+  @param   ld Loader state.
+  @param   parent Context of enclosing block or array.
+  @param   item JSON item, start of block or array.
+  @return  Context for the new block or array.
+
+****************************************************************************************************
+*/
+static pinsJsonCtx pins_json_enter(
+    PinsJsonLoader *ld,
+    pinsJsonCtx parent,
+    osalJsonItem *item)
+{
+    os_boolean is_array;
+
+    is_array = (os_boolean)(item->code == OSAL_JSON_START_ARRAY);
+    switch (parent)
+    {
+        case PINS_JCTX_ROOT:
+            if (is_array && !os_strcmp(item->tag_name, "io")) return PINS_JCTX_IO;
+            break;
+
+        case PINS_JCTX_IO:
+            if (is_array) break;
+            if (ld->config == OS_NULL && ld->device_name == OS_NULL &&
+                ld->device_select < 0)
+            {
+                ld->device_select = ld->device_nr;
+            }
+            ld->device_nr++;
+            return PINS_JCTX_DEVICE;
+
+        case PINS_JCTX_DEVICE:
+            if (is_array && !os_strcmp(item->tag_name, "groups")) return PINS_JCTX_GROUPS;
+            break;
+
+        case PINS_JCTX_GROUPS:
+            if (is_array) break;
+            if (ld->group_nr >= PINS_JSON_MAX_GROUPS) {
+                osal_debug_error_int("pins_load_json_config: Too many groups, max ",
+                    PINS_JSON_MAX_GROUPS);
+                ld->status = OSAL_STATUS_FAILED;
+                break;
+            }
+
+            /* On first pass all groups are counted, name may be after the pins.
+             */
+            if (ld->config == OS_NULL) {
+                ld->group_type[ld->group_nr] = -1;
+            }
+            else if (ld->device_nr - 1 != ld->device_select ||
+                ld->group_type[ld->group_nr] < 0)
+            {
+                ld->group_nr++;
+                break;
+            }
+            ld->group_nr++;
+            ld->group_pin0 = ld->n_pins;
+            ld->scan_ms = 0;
+            return PINS_JCTX_GROUP;
+
+        case PINS_JCTX_GROUP:
+            if (is_array && !os_strcmp(item->tag_name, "pins")) return PINS_JCTX_PINS;
+            break;
+
+        case PINS_JCTX_PINS:
+            if (is_array) break;
+            os_memclear(&ld->pin, sizeof(PinsJsonPin));
+            return PINS_JCTX_PIN;
+
+        default:
+            break;
+    }
+
+    return PINS_JCTX_OTHER;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Process JSON value.
+  @anchor pins_json_value
+
+  @param   ld Loader state.
+  @param   ctx Context of the block containing the value.
+  @param   item JSON item.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_json_value(
+    PinsJsonLoader *ld,
+    pinsJsonCtx ctx,
+    osalJsonItem *item)
+{
+    switch (ctx)
+    {
+        case PINS_JCTX_DEVICE:
+            if (ld->config == OS_NULL && ld->device_name && ld->device_select < 0 &&
+                item->code == OSAL_JSON_VALUE_STRING && !os_strcmp(item->tag_name, "name") &&
+                !os_strcmp(item->value.s, ld->device_name))
+            {
+                ld->device_select = ld->device_nr - 1;
+            }
+            break;
+
+        case PINS_JCTX_GROUP:
+            if (!os_strcmp(item->tag_name, "name")) {
+                if (ld->config == OS_NULL && item->code == OSAL_JSON_VALUE_STRING) {
+                    ld->group_type[ld->group_nr - 1] = (os_char)pins_json_lookup(
+                        pins_json_types, PINS_JSON_NAMES(pins_json_types), item->value.s);
+                }
+            }
+            else if (!os_strcmp(item->tag_name, "scan-ms")) {
+                ld->scan_ms = pins_json_int(item);
+            }
+            break;
+
+        case PINS_JCTX_PIN:
+            pins_json_pin_attr(ld, item);
+            break;
+
+        default:
+            break;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Store pin attribute.
+  @anchor pins_json_pin_attr
+
+  @param   ld Loader state.
+  @param   item JSON item within pin block.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_json_pin_attr(
+    PinsJsonLoader *ld,
+    osalJsonItem *item)
+{
+    PinsJsonPin *p;
+    const os_char *tag;
+    os_int prm, value;
+
+    p = &ld->pin;
+    tag = item->tag_name;
+    if (item->code == OSAL_JSON_VALUE_STRING)
+    {
+        if (!os_strcmp(tag, "name")) { p->name = item->value.s; return; }
+        if (!os_strcmp(tag, "group")) { p->group = item->value.s; return; }
+        if (!os_strcmp(tag, "device")) { p->device = item->value.s; return; }
+        if (!os_strcmp(tag, "driver")) { p->driver = item->value.s; return; }
+    }
+    if (!os_strcmp(tag, "addr")) { p->addr = pins_json_int(item); return; }
+    if (!os_strcmp(tag, "bank")) { p->bank = pins_json_int(item); return; }
+    if (!os_strcmp(tag, "history")) { p->history = pins_json_int(item); return; }
+
+    prm = pins_json_lookup(pins_json_prms, PINS_JSON_NAMES(pins_json_prms), tag);
+    if (prm < 0 || p->prm_n >= PIN_NRO_PRMS) return;
+
+    switch (prm)
+    {
+        case PIN_SPEED:
+        case PIN_SPEED_KBPS:
+            value = pins_json_int(item) / 100;
+            break;
+
+        case PIN_SIM:
+            value = item->code == OSAL_JSON_VALUE_STRING ? pins_json_lookup(pins_json_sim_sources,
+                PINS_JSON_NAMES(pins_json_sim_sources), item->value.s) : -1;
+            if (value < 0) {
+                osal_debug_error_str("pins_load_json_config: Unknown \"sim\" source for ",
+                    p->name ? p->name : "");
+                ld->status = OSAL_STATUS_FAILED;
+                return;
+            }
+            break;
+
+        case PIN_DIGS:
+        case PIN_SMIN:
+        case PIN_SMAX:
+            p->has_scaling = OS_TRUE;
+            value = pins_json_int(item);
+            break;
+
+        case PIN_INTERRUPT_ENABLED:
+            p->has_interrupt = OS_TRUE;
+            value = pins_json_int(item);
+            break;
+
+        case PIN_AVG:
+        case PIN_IIR:
+        case PIN_DEADBAND:
+        case PIN_DEADBAND_REL:
+        case PIN_DEBOUNCE:
+            p->has_filter = OS_TRUE;
+            value = pins_json_int(item);
+            break;
+
+        default:
+            value = pins_json_int(item);
+            break;
+    }
+
+    p->prm[p->prm_n].ix = (pin_ix)prm;
+    p->prm[p->prm_n].value = (os_short)value;
+    p->prm_n++;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Add parsed pin.
+  @anchor pins_json_add_pin
+
+  Called at end of pin block. On first pass only counts, on second pass sets up Pin
+  structure and the items it refers to.
+
+  @param   ld Loader state.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_json_add_pin(
+    PinsJsonLoader *ld)
+{
+    PinsJsonPin *p;
+    PinsJsonConfig *c;
+    Pin *pin;
+    PinsJsonGroup *g;
+    os_int type, i;
+#if PINS_HISTORY
+    PinHistory *h;
+#endif
+#if PINS_SPI || PINS_I2C
+    PinsBusDevice *device;
+    const PinsBusDriver *driver;
+#endif
+
+    p = &ld->pin;
+    if (p->name == OS_NULL) {
+        osal_debug_error("pins_load_json_config: Pin without name");
+        ld->status = OSAL_STATUS_FAILED;
+        return;
+    }
+
+    /* Timers always have interrupt configuration, like pins_to_c.py sets up. Type may
+       not be known on first pass, count the parameter anyhow.
+     */
+    type = ld->group_type[ld->group_nr - 1];
+    if (!p->has_interrupt && (type == PIN_TIMER || type < 0) && p->prm_n < PIN_NRO_PRMS)
+    {
+        p->prm[p->prm_n].ix = PIN_INTERRUPT_ENABLED;
+        p->prm[p->prm_n].value = 1;
+        p->prm_n++;
+        p->has_interrupt = OS_TRUE;
+    }
+
+    c = ld->config;
+    if (c == OS_NULL)
+    {
+        ld->n_pins++;
+        ld->n_prm += p->prm_n;
+        if (p->has_interrupt) ld->n_int_conf++;
+        if (p->has_scaling) ld->n_scaling++;
+        if (p->has_filter) ld->n_filter++;
+        if (p->history > 0) {
+            ld->n_history++;
+            ld->n_history_entries += p->history;
+        }
+        if (p->group) {
+            ld->n_app_groups++;
+            ld->str_sz += os_strlen(p->group);
+        }
+        if (p->device) {
+            ld->n_device_refs++;
+            ld->str_sz += os_strlen(p->device);
+        }
+        if (p->driver) ld->n_devices++;
+        ld->str_sz += os_strlen(p->name) + PINS_JSON_TYPE_NAME_SZ;
+        return;
+    }
+
+    pin = c->pin + ld->n_pins;
+    pin->type = (os_char)type;
+    pin->bank = (os_char)p->bank;
+    pin->addr = (pin_addr)p->addr;
+    pin->rv = c->hdr.rv + ld->n_pins;
+    if (p->prm_n)
+    {
+        pin->prm = ld->prm + ld->n_prm;
+        os_memcpy(pin->prm, p->prm, p->prm_n * sizeof(PinPrmValue));
+        pin->prm_n = (os_char)p->prm_n;
+        ld->n_prm += p->prm_n;
+    }
+    if (p->has_scaling) {
+        pin->flags = PIN_SCALING_SET;
+    }
+
+    for (i = 0; i < PINS_JSON_NAMES(pins_json_types); i++) {
+        if (pins_json_types[i].id == type) break;
+    }
+    c->pin_name[ld->n_pins] = pins_json_copy_str(ld, pins_json_types[i].name, p->name);
+    if (ld->status) return;
+
+#if PINS_SIMULATED_INTERRUPTS
+    if (p->has_interrupt) {
+        pin->int_conf = ld->int_conf + ld->n_int_conf++;
+    }
+#endif
+#if PINS_SCALING_CACHE
+    if (p->has_scaling) {
+        pin->scaling = ld->scaling + ld->n_scaling++;
+    }
+#endif
+#if PINS_INPUT_FILTERS
+    if (p->has_filter) {
+        pin->filter = ld->filter + ld->n_filter++;
+    }
+#endif
+#if PINS_HISTORY
+    if (p->history > 0)
+    {
+        h = ld->history + ld->n_history++;
+        h->entry = ld->history_entry + ld->n_history_entries;
+        h->n = p->history;
+        ld->n_history_entries += p->history;
+        ((PinHistory**)c->hdr.history)[ld->n_pins] = h;
+    }
+#endif
+
+    /* Application pin group: New pin becomes head of linked list, as in generated code.
+     */
+    if (p->group)
+    {
+        for (i = 0; i < ld->n_app_groups; i++) {
+            if (!os_strcmp(c->app_group[i].name, p->group)) break;
+        }
+        g = c->app_group + i;
+        if (i == ld->n_app_groups) {
+            g->name = pins_json_copy_str(ld, p->group, OS_NULL);
+            if (ld->status) return;
+            ld->n_app_groups++;
+        }
+        pin->next = g->pin;
+        g->pin = pin;
+    }
+
+#if PINS_SPI || PINS_I2C
+    if (p->device) {
+        ld->device_ref[ld->n_pins] = pins_json_copy_str(ld, p->device, OS_NULL);
+        if (ld->status) return;
+        ld->n_device_refs++;
+    }
+
+    if (p->driver)
+    {
+        for (i = 0; i < ld->n_drivers; i++) {
+            if (!os_strcmp(ld->drivers[i].name, p->driver)) break;
+        }
+        if (i == ld->n_drivers) {
+            osal_debug_error_str("pins_load_json_config: Unknown driver ", p->driver);
+            ld->status = OSAL_STATUS_FAILED;
+            return;
+        }
+
+        driver = ld->drivers + i;
+        device = c->device + ld->n_devices;
+        device->device_pin = pin;
+        device->initialize_pin_func = driver->initialize_pin;
+        device->gen_req_func = driver->gen_req;
+        device->proc_resp_func = driver->proc_resp;
+        device->set_func = driver->set;
+        device->get_func = driver->get;
+        c->device_driver[ld->n_devices++] = driver;
+    }
+#endif
+
+    ld->n_pins++;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Add pin group.
+  @anchor pins_json_add_group
+
+  Called at end of pin group block.
+
+  @param   ld Loader state.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_json_add_group(
+    PinsJsonLoader *ld)
+{
+    PinGroupHdr *group;
+
+    if (ld->config == OS_NULL)
+    {
+        ld->n_groups++;
+        if (ld->scan_ms) ld->n_scan++;
+        return;
+    }
+
+    group = ld->group + ld->n_groups;
+    group->n_pins = (os_short)(ld->n_pins - ld->group_pin0);
+    group->pin = ld->config->pin + ld->group_pin0;
+#if PINS_SCAN_SCHEDULER
+    if (ld->scan_ms) {
+        group->scan = ld->scan + ld->n_scan++;
+        group->scan->period_ms = ld->scan_ms;
+    }
+#endif
+    ld->group_list[ld->n_groups++] = group;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Place items in arena.
+  @anchor pins_json_layout
+
+  Uses counts from the first pass. Called first with OS_NULL arena to get the size, and
+  then to set pointers into allocated arena. Pointers are only set when arena is given,
+  so configuration structure members are not touched on the first call.
+
+  @param   ld Loader state.
+  @param   arena Pointer to arena, OS_NULL to only calculate size.
+  @return  Arena size in bytes.
+
+****************************************************************************************************
+*/
+static os_memsz pins_json_layout(
+    PinsJsonLoader *ld,
+    os_char *arena)
+{
+    PinsJsonConfig *c;
+    os_memsz pos;
+
+#define PINS_JSON_TAKE(p, type, n) \
+    if (arena) p = (type*)(arena + pos); \
+    pos += PINS_JSON_ALIGN((os_memsz)(n) * sizeof(type));
+
+    pos = 0;
+    c = OS_NULL;
+    PINS_JSON_TAKE(c, PinsJsonConfig, 1)
+    ld->config = c;
+    PINS_JSON_TAKE(ld->group, PinGroupHdr, ld->n_groups)
+    PINS_JSON_TAKE(ld->group_list, const PinGroupHdr*, ld->n_groups)
+    PINS_JSON_TAKE(c->pin, Pin, ld->n_pins)
+    PINS_JSON_TAKE(c->pin_name, const os_char*, ld->n_pins)
+    PINS_JSON_TAKE(c->reinit, os_uchar, ld->n_pins)
+    PINS_JSON_TAKE(c->hdr.rv, PinRV, ld->n_pins)
+#if PINS_STATISTICS
+    PINS_JSON_TAKE(c->hdr.stats, PinStats, ld->n_pins)
+#endif
+    PINS_JSON_TAKE(c->app_group, PinsJsonGroup, ld->n_app_groups)
+#if PINS_SPI || PINS_I2C
+    PINS_JSON_TAKE(c->device, PinsBusDevice, ld->n_devices)
+    PINS_JSON_TAKE(c->device_driver, const PinsBusDriver*, ld->n_devices)
+    PINS_JSON_TAKE(ld->bus, PinsBus, ld->n_devices)
+#endif
+    PINS_JSON_TAKE(ld->prm, PinPrmValue, ld->n_prm)
+#if PINS_SIMULATED_INTERRUPTS
+    PINS_JSON_TAKE(ld->int_conf, PinInterruptConf, ld->n_int_conf)
+#endif
+#if PINS_SCALING_CACHE
+    PINS_JSON_TAKE(ld->scaling, PinScaling, ld->n_scaling)
+#endif
+#if PINS_INPUT_FILTERS
+    PINS_JSON_TAKE(ld->filter, PinFilter, ld->n_filter)
+#endif
+#if PINS_SCAN_SCHEDULER
+    PINS_JSON_TAKE(ld->scan, PinGroupScan, ld->n_scan)
+#endif
+#if PINS_HISTORY
+    PINS_JSON_TAKE(c->hdr.history, PinHistory*, ld->n_pins)
+    PINS_JSON_TAKE(ld->history, PinHistory, ld->n_history)
+    PINS_JSON_TAKE(ld->history_entry, PinHistoryEntry, ld->n_history_entries)
+#endif
+    PINS_JSON_TAKE(ld->str, os_char, ld->str_sz)
+
+#undef PINS_JSON_TAKE
+    return pos;
+}
+
+
+#if PINS_SPI || PINS_I2C
+/**
+****************************************************************************************************
+
+  @brief Set up SPI and I2C buses and resolve "device" attributes.
+  @anchor pins_json_link_devices
+
+  Devices are grouped to buses like pins_to_c.py does: SPI devices by "sclk" pin and I2C
+  devices by bank. Pin's "device" attribute is "group.pin" name of the device pin, like
+  "spi.mcp3208".
+
+  @param   ld Loader state.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_json_link_devices(
+    PinsJsonLoader *ld)
+{
+    PinsJsonConfig *c;
+    PinsBusDevice *device, *d;
+    PinsBus *bus;
+    const Pin *pin;
+    os_int i, j, n_buses, key;
+
+    c = ld->config;
+    n_buses = 0;
+    for (i = 0; i < c->n_devices; i++)
+    {
+        device = c->device + i;
+        pin = device->device_pin;
+        key = pin->type == PIN_I2C ? pin->bank : pin_get_prm(pin, PIN_SCLK);
+
+        bus = OS_NULL;
+        for (j = 0; j < i; j++) {
+            d = c->device + j;
+            if (d->device_pin->type == pin->type && key == (d->device_pin->type == PIN_I2C
+                ? d->device_pin->bank : pin_get_prm(d->device_pin, PIN_SCLK)))
+            {
+                bus = d->bus;
+                break;
+            }
+        }
+
+        if (bus == OS_NULL) {
+            bus = ld->bus + n_buses++;
+            bus->bus_type = pin->type == PIN_I2C ? PINS_I2C_BUS : PINS_SPI_BUS;
+            bus->next_bus = c->first_bus;
+            c->first_bus = bus;
+        }
+
+        device->bus = bus;
+        device->next_device = bus->first_bus_device;
+        bus->first_bus_device = device;
+    }
+
+    if (ld->device_ref == OS_NULL) return;
+    for (i = 0; i < c->n_pins; i++)
+    {
+        if (ld->device_ref[i] == OS_NULL) continue;
+        for (j = 0; j < c->n_devices; j++) {
+            if (!os_strcmp(c->pin_name[c->device[j].device_pin - c->pin], ld->device_ref[i])) break;
+        }
+        if (j == c->n_devices) {
+            osal_debug_error_str("pins_load_json_config: Unknown device ", ld->device_ref[i]);
+            ld->status = OSAL_STATUS_FAILED;
+            return;
+        }
+        c->pin[i].bus_device = c->device + j;
+    }
+}
+#endif
+
+
+/**
+****************************************************************************************************
+
+  @brief Find name in table.
+  @anchor pins_json_lookup
+
+  @param   table Name table.
+  @param   n Number of items in table.
+  @param   name Name to find, OS_NULL is not found.
+  @return  Number for the name, -1 if not found.
+
+****************************************************************************************************
+*/
+static os_int pins_json_lookup(
+    const PinsJsonName *table,
+    os_int n,
+    const os_char *name)
+{
+    os_int i;
+
+    if (name == OS_NULL) return -1;
+    for (i = 0; i < n; i++) {
+        if (!os_strcmp(table[i].name, name)) return table[i].id;
+    }
+    return -1;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get JSON value as integer.
+  @anchor pins_json_int
+
+  @param   item JSON item.
+  @return  Integer value. Strings are converted, true is 1 and anything else 0.
+
+****************************************************************************************************
+*/
+static os_int pins_json_int(
+    osalJsonItem *item)
+{
+    switch (item->code)
+    {
+        case OSAL_JSON_VALUE_INTEGER: return (os_int)item->value.l;
+        case OSAL_JSON_VALUE_FLOAT: return (os_int)item->value.d;
+        case OSAL_JSON_VALUE_STRING: return (os_int)osal_str_to_int(item->value.s, OS_NULL);
+        case OSAL_JSON_VALUE_TRUE: return 1;
+        default: return 0;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Copy string into arena.
+  @anchor pins_json_copy_str
+
+  If the string doesn't fit into space reserved by the first pass, nothing is written,
+  ld->status is set to OSAL_STATUS_FAILED and the load fails.
+
+  @param   ld Loader state.
+  @param   a String to copy.
+  @param   b If not OS_NULL, appended to a with '.' in between.
+  @return  Pointer to copy, OS_NULL if out of space.
+
+****************************************************************************************************
+*/
+static const os_char *pins_json_copy_str(
+    PinsJsonLoader *ld,
+    const os_char *a,
+    const os_char *b)
+{
+    os_char *s;
+    os_memsz n, m, pos;
+
+    n = os_strlen(a) - 1;
+    m = b ? os_strlen(b) : 0;
+    if (ld->str_pos + n + m + 1 > ld->str_sz)
+    {
+        osal_debug_error("pins_load_json_config: String space exhausted");
+        ld->status = OSAL_STATUS_FAILED;
+        return OS_NULL;
+    }
+
+    s = ld->str + ld->str_pos;
+    os_memcpy(s, a, n);
+    pos = n;
+    if (b) {
+        s[pos++] = '.';
+        os_memcpy(s + pos, b, m - 1);
+        pos += m - 1;
+    }
+    s[pos++] = '\0';
+    ld->str_pos += pos;
+    return s;
+}
+
+#endif
@@ -0,0 +1,152 @@
+/**
+
+  @file    json_config/common/pins_json_config.h
+  @brief   Load pin configuration from JSON at run time.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Normally IO pin configuration is C code generated from JSON by pins_to_c.py, so changing
+  board's IO needs rebuild. This extension loads the same JSON (IO device's "groups" with
+  "pins") at run time into one arena allocated by os_malloc(). The arena holds IoPinsHdr,
+  group headers, Pin structures, PinRV array, parameters, interrupt configurations, scaling,
+  filter state and SPI/I2C bus devices, laid out as pins_setup() expects. Releasing the
+  configuration is one os_free() call.
+
+  Pin attributes are the same as pins_to_c.py accepts. Differences to generated code: Pins
+  are not mapped to IOCOM signals, parameter lookup is linear (no slot maps), and there is
+  no scan plan or name index, use pins_find_json_pin() to find pins by name. SPI and I2C
+  drivers named by "driver" attribute must be listed in driver table given by application.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#pragma once
+#ifndef PINS_JSON_CONFIG_H_
+#define PINS_JSON_CONFIG_H_
+#include "pinsx.h"
+
+/* Run time JSON configuration is compiled out unless enabled for the build. Set
+   PINS_JSON_CONFIG_ONLY if application has no generated configuration, the extension then
+   defines pins_devicebus and pins_initialize_bus_devices().
+ */
+#ifndef PINS_JSON_CONFIG
+#define PINS_JSON_CONFIG 0
+#endif
+#ifndef PINS_JSON_CONFIG_ONLY
+#define PINS_JSON_CONFIG_ONLY 0
+#endif
+
+#if PINS_JSON_CONFIG
+#if PINS_COMPACT
+#error Run time JSON configuration cannot be used with PINS_COMPACT
+#endif
+
+/** Maximum number of pin group blocks ("inputs", "outputs"...) in IO device.
+ */
+#ifndef PINS_JSON_MAX_GROUPS
+#define PINS_JSON_MAX_GROUPS 32
+#endif
+
+struct PinsBusDriver;
+
+/** Application pin group (linked list of pins set by "group" attribute).
+ */
+typedef struct PinsJsonGroup
+{
+    const os_char *name;
+    const Pin *pin;
+}
+PinsJsonGroup;
+
+/** Pin configuration loaded from JSON. This is the beginning of the arena, everything
+    else follows it in the same memory block.
+ */
+typedef struct PinsJsonConfig
+{
+    /** Top level structure to pass to pins_setup(), pins_read_all(), etc.
+     */
+    IoPinsHdr hdr;
+
+    /** All pins as one array in JSON order, and "group.pin" name of each pin.
+     */
+    Pin *pin;
+    const os_char **pin_name;
+    os_short n_pins;
+
+    /** For each pin: Set to OS_TRUE by pins_reconfigure_json_config() if the pin was
+        added or set up again. Interrupts need to be attached again to these pins.
+     */
+    os_uchar *reinit;
+
+    /** Application pin groups.
+     */
+    PinsJsonGroup *app_group;
+    os_short n_app_groups;
+
+#if PINS_SPI || PINS_I2C
+    /** SPI and I2C buses and devices.
+     */
+    PinsBus *first_bus;
+    PinsBusDevice *device;
+    const PinsBusDriver **device_driver;
+    os_short n_devices;
+#endif
+
+    /** Arena size in bytes, for os_free().
+     */
+    os_memsz arena_sz;
+}
+PinsJsonConfig;
+
+/* Load pin configuration from compressed JSON (see osal_compress_json).
+ */
+osalStatus pins_load_json_config(
+    PinsJsonConfig **config,
+    const os_char *json,
+    os_memsz json_sz,
+    const os_char *device_name,
+    const struct PinsBusDriver *drivers,
+    os_int n_drivers);
+
+#if OSAL_JSON_TEXT_SUPPORT
+/* Load pin configuration from JSON text, like contents of pins_io.json.
+ */
+osalStatus pins_load_json_config_text(
+    PinsJsonConfig **config,
+    const os_char *json_text,
+    const os_char *device_name,
+    const struct PinsBusDriver *drivers,
+    os_int n_drivers);
+#endif
+
+/* Release loaded configuration.
+ */
+void pins_free_json_config(
+    PinsJsonConfig *config);
+
+/* Find pin by "group.pin" name or first pin of application group by group name.
+ */
+const Pin *pins_find_json_pin(
+    const PinsJsonConfig *config,
+    const os_char *name);
+
+/* Hand over running pins to new configuration, set up only pins and devices which changed.
+ */
+osalStatus pins_reconfigure_json_config(
+    PinsJsonConfig *running,
+    PinsJsonConfig *next);
+
+#if PINS_SPI || PINS_I2C
+/* Link loaded SPI and I2C buses to pins_devicebus and initialize drivers and devices.
+ */
+void pins_initialize_json_bus_devices(
+    PinsJsonConfig *config);
+#endif
+
+#endif
+#endif
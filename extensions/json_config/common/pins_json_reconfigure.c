@@ -0,0 +1,594 @@
+/**
+
+  @file    json_config/common/pins_json_reconfigure.c
+  @brief   Switch running pins to new JSON configuration without full setup.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Changing pin parameters or adding and removing pins used to need pins_shutdown() and
+  pins_setup() for the whole configuration, which drops all outputs and reinitializes every
+  bus. Here the application loads the modified JSON as new configuration and hands over from
+  the running one. The delta is found by comparing the two: Pins are matched by "group.pin"
+  name, and only pins which were added, removed or whose hardware parameters changed are
+  touched by pin_ll_shutdown() and pin_ll_setup(). SPI and I2C devices are taken over as
+  they are, unless the device, its pins or driver changed.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#include "pinsx.h"
+#if PINS_JSON_CONFIG
+
+/* What happens to a pin of new configuration.
+ */
+#define PINS_RECONF_NEW 0
+#define PINS_RECONF_SAME 1
+#define PINS_RECONF_CHANGED 2
+
+/* Pin is set up by pin_ll_setup(), not by SPI or I2C device driver.
+ */
+#if PINS_SPI || PINS_I2C
+#define PINS_RECONF_DIRECT(p) (PIN_BUS_DEVICE(p) == OS_NULL)
+#else
+#define PINS_RECONF_DIRECT(p) OS_TRUE
+#endif
+
+/** Working tables, allocated for duration of pins_reconfigure_json_config().
+ */
+typedef struct PinsReconf
+{
+    /** For each pin of new configuration: Index of the same pin in running configuration,
+        -1 if none, and PINS_RECONF_NEW, PINS_RECONF_SAME or PINS_RECONF_CHANGED.
+     */
+    os_short *match;
+    os_uchar *state;
+
+    /** For each pin of running configuration: Nonzero if the pin is in new configuration.
+     */
+    os_uchar *kept;
+
+#if PINS_SPI || PINS_I2C
+    /** For each device of new configuration: Index of running device to take over, -1 if
+        device needs to be initialized. Number of pins on the device.
+     */
+    os_short *dev_match;
+    os_short *dev_n_pins;
+
+    /** For each running device: Number of pins on it and nonzero if taken over.
+     */
+    os_short *rdev_n_pins;
+    os_uchar *rdev_taken;
+#endif
+}
+PinsReconf;
+
+/* Forward referred static functions.
+ */
+static os_memsz pins_reconf_layout(
+    PinsReconf *r,
+    const PinsJsonConfig *running,
+    const PinsJsonConfig *next,
+    os_char *buf);
+
+static void pins_reconf_match(
+    const PinsJsonConfig *running,
+    const PinsJsonConfig *next,
+    PinsReconf *r);
+
+static os_boolean pins_reconf_differ(
+    const Pin *a,
+    const Pin *b);
+
+static os_boolean pins_reconf_soft_prm(
+    os_int prm);
+
+#if PINS_SPI || PINS_I2C
+static void pins_reconf_match_devices(
+    const PinsJsonConfig *running,
+    const PinsJsonConfig *next,
+    PinsReconf *r);
+
+static void pins_reconf_devices(
+    PinsJsonConfig *running,
+    PinsJsonConfig *next,
+    PinsReconf *r);
+
+static os_boolean pins_reconf_same_driver(
+    const PinsBusDriver *a,
+    const PinsBusDriver *b);
+#endif
+
+
+/**
+****************************************************************************************************
+
+  @brief Hand over running pins to new JSON configuration.
+  @anchor pins_reconfigure_json_config
+
+  The pins_reconfigure_json_config() function applies changes between running configuration
+  and new one loaded by pins_load_json_config(), and makes the new configuration running
+  instead of calling pins_shutdown() and pins_setup(). Pins are matched by "group.pin" name.
+
+  - Pin only in running configuration: pin_ll_shutdown().
+  - Pin only in new configuration: pin_ll_setup() and initial value, as pins_setup() does.
+  - Same pin, hardware parameters, type, bank or address changed: pin_ll_shutdown() and
+    pin_ll_setup(), output is set back to its current value.
+  - Same pin, no changes or only "init", scaling or filter parameters changed: Hardware is
+    not touched and outputs keep running. Simulated interrupt handler and edge capture
+    attached to the pin are carried over.
+
+  Value and state bits of every matched pin are carried over. Scaling and filters are set up
+  for all pins of new configuration, filter state starts from scratch. SPI and I2C device
+  which has the same device pin parameters, driver and the same unchanged pins is taken over
+  open, with driver's state. Other devices are closed and initialized again. Since driver
+  state is per driver, this applies to all devices using the same driver.
+
+  Call from the main loop thread, not while pins_read_all() or other pin functions run. Device
+  bus must not be running: stop devicebus threads by pins_stop_multithread_devicebus() and
+  start them again afterwards. next->reinit flags pins which were added or set up again,
+  including pins on SPI and I2C devices which were initialized again. Interrupts attached to
+  these pins need to be attached again. After the call use &next->hdr, and release running
+  configuration by pins_free_json_config() without pins_shutdown().
+
+  @param   running Configuration pins are now set up for.
+  @param   next New configuration, loaded by pins_load_json_config() but not set up.
+  @return  OSAL_SUCCESS if new configuration is now running. OSAL_STATUS_MEMORY_ALLOCATION_FAILED
+           if out of memory, running configuration is then unchanged.
+
+****************************************************************************************************
+*/
+osalStatus pins_reconfigure_json_config(
+    PinsJsonConfig *running,
+    PinsJsonConfig *next)
+{
+    PinsReconf r;
+    const Pin *a, *b;
+    os_char *buf;
+    os_memsz buf_sz;
+    os_int i;
+
+    /* Allocate working tables.
+     */
+    os_memclear(&r, sizeof(r));
+    buf_sz = pins_reconf_layout(&r, running, next, OS_NULL);
+    buf = (os_char*)os_malloc(buf_sz, OS_NULL);
+    if (buf == OS_NULL) return OSAL_STATUS_MEMORY_ALLOCATION_FAILED;
+    os_memclear(buf, buf_sz);
+    pins_reconf_layout(&r, running, next, buf);
+
+    pins_reconf_match(running, next, &r);
+#if PINS_SPI || PINS_I2C
+    pins_reconf_match_devices(running, next, &r);
+#endif
+
+#if OSAL_PROCESS_CLEANUP_SUPPORT
+    /* Release removed and changed pins first, a GPIO may move from one pin to another.
+     */
+    for (i = 0; i < running->n_pins; i++) {
+        a = running->pin + i;
+        if (!r.kept[i] && PINS_RECONF_DIRECT(a)) {
+            pin_ll_shutdown(a);
+        }
+    }
+    for (i = 0; i < next->n_pins; i++) {
+        if (r.state[i] == PINS_RECONF_CHANGED && PINS_RECONF_DIRECT(next->pin + i)) {
+            pin_ll_shutdown(running->pin + r.match[i]);
+        }
+    }
+#endif
+
+    for (i = 0; i < next->n_pins; i++)
+    {
+        b = next->pin + i;
+        if (r.state[i] == PINS_RECONF_NEW) {
+            if (PINS_RECONF_DIRECT(b)) {
+                pin_ll_setup(b, PINS_DEFAULT);
+                next->reinit[i] = OS_TRUE;
+            }
+            PIN_RV(b)->value = pin_get_prm(b, PIN_INIT);
+            PIN_RV(b)->state_bits = OSAL_STATE_NO_READ_SUPPORT;
+        }
+        else {
+            a = running->pin + r.match[i];
+            PIN_RV(b)->value = PIN_RV(a)->value;
+            PIN_RV(b)->state_bits = PIN_RV(a)->state_bits;
+#if PINS_SIMULATED_INTERRUPTS
+            /* Unchanged pin keeps attached interrupt handler and edge capture.
+             */
+            if (r.state[i] == PINS_RECONF_SAME && PIN_INT_CONF(a) && PIN_INT_CONF(b)) {
+                *PIN_INT_CONF(b) = *PIN_INT_CONF(a);
+            }
+#endif
+            if (r.state[i] == PINS_RECONF_CHANGED && PINS_RECONF_DIRECT(b))
+            {
+                pin_ll_setup(b, PINS_DEFAULT);
+                next->reinit[i] = OS_TRUE;
+                if (b->type == PIN_OUTPUT || b->type == PIN_PWM || b->type == PIN_ANALOG_OUTPUT) {
+                    pin_ll_set(b, PIN_RV(b)->value);
+                }
+            }
+        }
+
+        if (b->flags & PIN_SCALING_SET) {
+            pin_setup_scaling(b);
+        }
+#if PINS_INPUT_FILTERS
+        if (PIN_FILTER(b)) {
+            pin_setup_filter(b);
+        }
+#endif
+    }
+
+#if PINS_SPI || PINS_I2C
+    pins_reconf_devices(running, next, &r);
+#endif
+
+#if PINS_STATISTICS
+    pins_setup_stats(&next->hdr);
+#endif
+#if PINS_HISTORY
+    /* Value history starts over with the new configuration's rings.
+     */
+    pins_setup_history(&next->hdr);
+#endif
+
+    os_free(buf, buf_sz);
+    return OSAL_SUCCESS;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Calculate size of working tables or set pointers to them.
+  @anchor pins_reconf_layout
+
+  @param   r Working tables, pointers are set only if buf is given.
+  @param   running Running configuration.
+  @param   next New configuration.
+  @param   buf Pointer to allocated memory, OS_NULL to only calculate size.
+  @return  Size of working tables in bytes.
+
+****************************************************************************************************
+*/
+static os_memsz pins_reconf_layout(
+    PinsReconf *r,
+    const PinsJsonConfig *running,
+    const PinsJsonConfig *next,
+    os_char *buf)
+{
+    os_memsz pos;
+
+#define PINS_RECONF_TAKE(p, type, n) \
+    if (buf) p = (type*)(buf + pos); \
+    pos += ((os_memsz)(n) * sizeof(type) + 7) & ~(os_memsz)7;
+
+    pos = 0;
+    PINS_RECONF_TAKE(r->match, os_short, next->n_pins)
+    PINS_RECONF_TAKE(r->state, os_uchar, next->n_pins)
+    PINS_RECONF_TAKE(r->kept, os_uchar, running->n_pins)
+#if PINS_SPI || PINS_I2C
+    PINS_RECONF_TAKE(r->dev_match, os_short, next->n_devices)
+    PINS_RECONF_TAKE(r->dev_n_pins, os_short, next->n_devices)
+    PINS_RECONF_TAKE(r->rdev_n_pins, os_short, running->n_devices)
+    PINS_RECONF_TAKE(r->rdev_taken, os_uchar, running->n_devices)
+#endif
+
+#undef PINS_RECONF_TAKE
+    return pos + 8;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Match pins of new configuration to running ones by name.
+  @anchor pins_reconf_match
+
+  Usually the configurations are mostly the same and in same order, so the pin following
+  the previous match is tried first. Pin which changed type is handled as removed and added.
+
+  @param   running Running configuration.
+  @param   next New configuration.
+  @param   r Working tables, match, state and kept are filled in.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_reconf_match(
+    const PinsJsonConfig *running,
+    const PinsJsonConfig *next,
+    PinsReconf *r)
+{
+    const os_char *name;
+    os_int i, j, k;
+
+    k = 0;
+    for (i = 0; i < next->n_pins; i++)
+    {
+        r->match[i] = -1;
+        r->state[i] = PINS_RECONF_NEW;
+        name = next->pin_name[i];
+
+        j = k;
+        if (j >= running->n_pins || os_strcmp(running->pin_name[j], name)) {
+            for (j = 0; j < running->n_pins; j++) {
+                if (!os_strcmp(running->pin_name[j], name)) break;
+            }
+        }
+        if (j >= running->n_pins) continue;
+        k = j + 1;
+
+        if (r->kept[j] || running->pin[j].type != next->pin[i].type) continue;
+        r->kept[j] = OS_TRUE;
+        r->match[i] = (os_short)j;
+        r->state[i] = pins_reconf_differ(running->pin + j, next->pin + i)
+            ? PINS_RECONF_CHANGED : PINS_RECONF_SAME;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Check if pin needs to be set up again.
+  @anchor pins_reconf_differ
+
+  The pins_reconf_differ() function compares bank, address and parameters, except ones which
+  are used only by software (see pins_reconf_soft_prm).
+
+  @param   a Pin in running configuration.
+  @param   b The same pin in new configuration.
+  @return  OS_TRUE if hardware setup differs.
+
+****************************************************************************************************
+*/
+static os_boolean pins_reconf_differ(
+    const Pin *a,
+    const Pin *b)
+{
+    const PinPrmValue *p;
+    os_int i;
+
+    if (a->bank != b->bank || a->addr != b->addr) return OS_TRUE;
+
+    for (i = 0, p = PIN_PRM(a); i < a->prm_n; i++, p++) {
+        if (!pins_reconf_soft_prm(p->ix) && pin_get_prm(b, p->ix) != p->value) return OS_TRUE;
+    }
+    for (i = 0, p = PIN_PRM(b); i < b->prm_n; i++, p++) {
+        if (!pins_reconf_soft_prm(p->ix) && pin_get_prm(a, p->ix) != p->value) return OS_TRUE;
+    }
+    return OS_FALSE;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Check if parameter is used only by software.
+  @anchor pins_reconf_soft_prm
+
+  Initial value is not applied to running pin, and scaling and filters are set up for
+  every pin of new configuration anyhow.
+
+  @param   prm Parameter number, see pinPrm enumeration.
+  @return  OS_TRUE if changing the parameter does not need pin_ll_setup().
+
+****************************************************************************************************
+*/
+static os_boolean pins_reconf_soft_prm(
+    os_int prm)
+{
+    return (os_boolean)(prm == PIN_INIT || (prm >= PIN_MIN && prm <= PIN_DEBOUNCE));
+}
+
+
+#if PINS_SPI || PINS_I2C
+/**
+****************************************************************************************************
+
+  @brief Decide which SPI and I2C devices can be taken over.
+  @anchor pins_reconf_match_devices
+
+  Device can be taken over if its device pin is unchanged, driver is the same and it has
+  the same pins, all unchanged. Drivers keep state of all their devices in one place and
+  pca9685_initialize_driver(), etc. resets it: If any device of a driver needs to be
+  initialized, or running device of the driver is dropped, all devices of the driver are
+  initialized.
+
+  @param   running Running configuration.
+  @param   next New configuration.
+  @param   r Working tables, device tables are filled in.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_reconf_match_devices(
+    const PinsJsonConfig *running,
+    const PinsJsonConfig *next,
+    PinsReconf *r)
+{
+    const PinsBusDevice *d;
+    const Pin *pin;
+    os_int i, j, k;
+
+    /* Take over device if its device pin is the same.
+     */
+    for (i = 0; i < next->n_devices; i++)
+    {
+        r->dev_match[i] = -1;
+        k = (os_int)(next->device[i].device_pin - next->pin);
+        if (r->state[k] != PINS_RECONF_SAME) continue;
+        pin = running->pin + r->match[k];
+
+        for (j = 0; j < running->n_devices; j++) {
+            if (running->device[j].device_pin == pin) break;
+        }
+        if (j < running->n_devices &&
+            pins_reconf_same_driver(running->device_driver[j], next->device_driver[i]))
+        {
+            r->dev_match[i] = (os_short)j;
+        }
+    }
+
+    /* Count pins on devices. Not if pin on the device is new or changed, or it was on some
+       other device.
+     */
+    for (i = 0; i < running->n_pins; i++) {
+        d = PIN_BUS_DEVICE(running->pin + i);
+        if (d) r->rdev_n_pins[d - running->device]++;
+    }
+    for (i = 0; i < next->n_pins; i++)
+    {
+        d = PIN_BUS_DEVICE(next->pin + i);
+        if (d == OS_NULL) continue;
+        k = (os_int)(d - next->device);
+        r->dev_n_pins[k]++;
+        if (r->dev_match[k] < 0) continue;
+
+        if (r->state[i] != PINS_RECONF_SAME ||
+            PIN_BUS_DEVICE(running->pin + r->match[i]) != running->device + r->dev_match[k])
+        {
+            r->dev_match[k] = -1;
+        }
+    }
+    for (i = 0; i < next->n_devices; i++) {
+        j = r->dev_match[i];
+        if (j >= 0 && r->dev_n_pins[i] != r->rdev_n_pins[j]) {
+            r->dev_match[i] = -1;
+        }
+    }
+
+    /* Running devices which are taken over.
+     */
+    for (i = 0; i < next->n_devices; i++) {
+        if (r->dev_match[i] >= 0) r->rdev_taken[r->dev_match[i]] = OS_TRUE;
+    }
+
+    /* Devices of a driver which has a device to initialize or drop.
+     */
+    for (i = 0; i < next->n_devices; i++)
+    {
+        j = r->dev_match[i];
+        if (j < 0) continue;
+        for (k = 0; k < next->n_devices; k++) {
+            if (r->dev_match[k] < 0 &&
+                pins_reconf_same_driver(next->device_driver[k], next->device_driver[i])) break;
+        }
+        if (k == next->n_devices) {
+            for (k = 0; k < running->n_devices; k++) {
+                if (!r->rdev_taken[k] &&
+                    pins_reconf_same_driver(running->device_driver[k], next->device_driver[i])) break;
+            }
+            if (k == running->n_devices) continue;
+        }
+        r->dev_match[i] = -1;
+        r->rdev_taken[j] = OS_FALSE;
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Take over or initialize SPI and I2C devices.
+  @anchor pins_reconf_devices
+
+  Closes running devices which are not taken over, makes buses of new configuration the
+  ones pins_devicebus runs, moves platform and driver state of taken over devices and
+  initializes the rest as pins_initialize_json_bus_devices() does.
+
+  @param   running Running configuration.
+  @param   next New configuration.
+  @param   r Working tables.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void pins_reconf_devices(
+    PinsJsonConfig *running,
+    PinsJsonConfig *next,
+    PinsReconf *r)
+{
+    PinsBusDevice *d, *rd;
+    PinsBus *bus;
+    const Pin *pin;
+    os_int i, j;
+
+    for (i = 0; i < running->n_devices; i++) {
+        if (!r->rdev_taken[i]) {
+            pins_close_device(running->device + i);
+        }
+    }
+
+    pins_devicebus.first_bus = next->first_bus;
+    pins_devicebus.current_bus = next->first_bus;
+    for (bus = next->first_bus; bus; bus = bus->next_bus) {
+        pins_init_bus(bus);
+    }
+
+    for (i = 0; i < next->n_devices; i++)
+    {
+        if (r->dev_match[i] < 0) continue;
+        d = next->device + i;
+        rd = running->device + r->dev_match[i];
+        d->spec = rd->spec;
+        d->ext = rd->ext;
+        d->seq = rd->seq;
+        d->init_state = rd->init_state;
+    }
+
+    for (i = 0; i < next->n_devices; i++)
+    {
+        if (r->dev_match[i] >= 0) continue;
+        for (j = 0; j < i; j++) {
+            if (r->dev_match[j] < 0 &&
+                pins_reconf_same_driver(next->device_driver[j], next->device_driver[i])) break;
+        }
+        if (j == i) {
+            next->device_driver[i]->initialize_driver();
+        }
+    }
+
+    for (i = 0; i < next->n_devices; i++) {
+        if (r->dev_match[i] < 0) {
+            next->device_driver[i]->initialize_device(next->device + i);
+        }
+    }
+
+    for (i = 0, pin = next->pin; i < next->n_pins; i++, pin++) {
+        d = PIN_BUS_DEVICE(pin);
+        if (d && r->dev_match[d - next->device] < 0) {
+            d->initialize_pin_func(pin);
+            next->reinit[i] = OS_TRUE;
+        }
+    }
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Check if two driver table entries are the same driver.
+  @anchor pins_reconf_same_driver
+
+  @param   a Driver table entry.
+  @param   b Driver table entry.
+  @return  OS_TRUE if same driver.
+
+****************************************************************************************************
+*/
+static os_boolean pins_reconf_same_driver(
+    const PinsBusDriver *a,
+    const PinsBusDriver *b)
+{
+    return (os_boolean)(a == b || !os_strcmp(a->name, b->name));
+}
+#endif
+
+#endif
@@ -244,6 +244,7 @@ os_boolean blink_morse_code(
     os_int pos;
     os_timer localtimer;
 
+    PINS_PROFILE_BEGIN(PINS_PROF_MORSE);
     if (morse->code != morse->prev_code)\
     {
         make_morse_recipe(morse);
@@ -275,6 +276,7 @@ os_boolean blink_morse_code(
         morse->pos = pos;
     }
 
+    PINS_PROFILE_END(PINS_PROF_MORSE);
     return morse->led_on;
 }
 
@@ -0,0 +1,270 @@
+/**
+
+  @file    sampling/common/pins_sampling.c
+  @brief   Timer driven analog sampling into ring buffers.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#define PINS_OS_INT_HANDLER_HDRS 1
+#include "pinsx.h"
+#if PINS_SAMPLING
+
+/* Sampler which is currently running, OS_NULL if none.
+ */
+static PinsSampler *pins_active_sampler;
+
+/* Forward referred static functions.
+ */
+TIMER_INTERRUPT_HANDLER_PROTO(pins_sampling_on_timer);
+
+static void OS_ISR_FUNC_ATTR pins_store_sample(
+    PinsSampleChannel *c,
+    os_int x);
+
+
+/**
+****************************************************************************************************
+
+  @brief Start sampling.
+  @anchor pins_start_sampling
+
+  The pins_start_sampling() function resets ring buffers of all channels and attaches timer
+  interrupt to sample the analog inputs. The sampler structure must remain valid until
+  sampling is stopped.
+
+  @param   sampler Pointer to sampler, set up by application.
+  @return  OSAL_SUCCESS if sampling was started. OSAL_STATUS_FAILED if other sampler is
+           already running or the sampler is not properly set up.
+
+****************************************************************************************************
+*/
+osalStatus pins_start_sampling(
+    PinsSampler *sampler)
+{
+    PinsSampleChannel *c;
+    pinTimerParams prm;
+    os_short i;
+
+    if (pins_active_sampler) {
+        osal_debug_error("pins_start_sampling: Sampler already running");
+        return OSAL_STATUS_FAILED;
+    }
+
+    if (sampler->timer_pin == OS_NULL) {
+        osal_debug_error("pins_start_sampling: No timer pin");
+        return OSAL_STATUS_FAILED;
+    }
+
+    for (i = 0; i < sampler->n_channels; i++)
+    {
+        c = sampler->channel + i;
+        if (c->pin == OS_NULL) {
+            osal_debug_error("pins_start_sampling: Channel has no pin");
+            return OSAL_STATUS_FAILED;
+        }
+        if (c->buf == OS_NULL || c->buf_sz < 2) {
+            osal_debug_error("pins_start_sampling: No ring buffer");
+            return OSAL_STATUS_FAILED;
+        }
+#if PINS_SPI || PINS_I2C
+        if (PIN_BUS_DEVICE(c->pin)) {
+            osal_debug_error("pins_start_sampling: Bus device pin cannot be sampled");
+            return OSAL_STATUS_FAILED;
+        }
+#endif
+        c->head = c->tail = 0;
+        c->acc = 0;
+        c->acc_n = 0;
+        c->overflow_count = 0;
+    }
+
+    pins_active_sampler = sampler;
+    PINS_MEMORY_BARRIER();
+
+    os_memclear(&prm, sizeof(prm));
+    prm.int_handler_func = pins_sampling_on_timer;
+    pin_timer_attach_interrupt(sampler->timer_pin, &prm);
+    return OSAL_SUCCESS;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Stop sampling.
+  @anchor pins_stop_sampling
+
+  The pins_stop_sampling() function detaches timer interrupt. Samples remaining in ring
+  buffers can still be read.
+
+  @param   sampler Pointer to sampler.
+  @return  None.
+
+****************************************************************************************************
+*/
+void pins_stop_sampling(
+    PinsSampler *sampler)
+{
+    if (pins_active_sampler != sampler) return;
+
+    pin_timer_detach_interrupt(sampler->timer_pin);
+    pins_active_sampler = OS_NULL;
+    PINS_MEMORY_BARRIER();
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Get number of samples in ring buffer.
+  @anchor pins_get_sample_count
+
+  The pins_get_sample_count() function returns how many samples can be read from the channel.
+
+  @param   channel Pointer to sample channel.
+  @return  Number of samples in ring buffer.
+
+****************************************************************************************************
+*/
+os_int pins_get_sample_count(
+    PinsSampleChannel *channel)
+{
+    os_int n;
+
+    n = channel->head - channel->tail;
+    if (n < 0) n += channel->buf_sz;
+    return n;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Move samples from ring buffer.
+  @anchor pins_get_samples
+
+  The pins_get_samples() function copies up to max_samples oldest samples from channel's ring
+  buffer and removes them from the ring buffer. This must be called from one thread only.
+
+  @param   channel Pointer to sample channel.
+  @param   samples Buffer where to store the samples.
+  @param   max_samples Maximum number of samples to get.
+  @return  Number of samples stored in samples buffer.
+
+****************************************************************************************************
+*/
+os_int pins_get_samples(
+    PinsSampleChannel *channel,
+    os_int *samples,
+    os_int max_samples)
+{
+    os_int head, tail, n, count;
+
+    head = channel->head;
+    PINS_MEMORY_BARRIER();
+    tail = channel->tail;
+
+    count = 0;
+    while (tail != head && count < max_samples)
+    {
+        n = (head > tail ? head : channel->buf_sz) - tail;
+        if (n > max_samples - count) n = max_samples - count;
+        os_memcpy(samples + count, channel->buf + tail, n * sizeof(os_int));
+        count += n;
+        tail += n;
+        if (tail >= channel->buf_sz) tail = 0;
+    }
+
+    PINS_MEMORY_BARRIER();
+    channel->tail = tail;
+    return count;
+}
+
+
+/**
+****************************************************************************************************
+
+  @brief Timer interrupt handler, read all channels.
+  @anchor pins_sampling_on_timer
+
+  The pins_sampling_on_timer() function is called at sampling rate. It reads all analog
+  inputs of the active sampler.
+
+****************************************************************************************************
+*/
+BEGIN_TIMER_INTERRUPT_HANDLER(pins_sampling_on_timer)
+    PinsSampler *sampler;
+    PinsSampleChannel *c;
+    os_int x;
+    os_short i;
+    os_char state_bits;
+
+    sampler = pins_active_sampler;
+    if (sampler)
+    {
+        for (i = 0; i < sampler->n_channels; i++)
+        {
+            c = sampler->channel + i;
+            x = pin_ll_get(c->pin, &state_bits);
+
+            /* Boxcar decimation: store average of "decimation" samples.
+             */
+            if (c->decimation > 1)
+            {
+                c->acc += x;
+                if (++(c->acc_n) < c->decimation) continue;
+                x = (c->acc + c->decimation / 2) / c->decimation;
+                c->acc = 0;
+                c->acc_n = 0;
+            }
+
+            pins_store_sample(c, x);
+        }
+    }
+END_TIMER_INTERRUPT_HANDLER(pins_sampling_on_timer)
+
+
+/**
+****************************************************************************************************
+
+  @brief Store sample in ring buffer.
+  @anchor pins_store_sample
+
+  The pins_store_sample() function is called from timer interrupt to store sample in ring
+  buffer. If the buffer is full, the sample is dropped and overflow_count incremented.
+
+  @param   c Pointer to sample channel.
+  @param   x Sample value.
+  @return  None.
+
+****************************************************************************************************
+*/
+static void OS_ISR_FUNC_ATTR pins_store_sample(
+    PinsSampleChannel *c,
+    os_int x)
+{
+    os_int head, next;
+
+    head = c->head;
+    next = head + 1;
+    if (next >= c->buf_sz) next = 0;
+
+    if (next == c->tail) {
+        c->overflow_count++;
+        return;
+    }
+
+    c->buf[head] = x;
+    PINS_MEMORY_BARRIER();
+    c->head = next;
+}
+
+#endif
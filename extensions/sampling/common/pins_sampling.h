@@ -0,0 +1,119 @@
+/**
+
+  @file    sampling/common/pins_sampling.h
+  @brief   Timer driven analog sampling into ring buffers.
+  @author  Pekka Lehtikoski
+  @version 1.0
+  @date    26.4.2021
+
+  A hardware timer pin reads a set of analog inputs at fixed rate. Each sample, or average
+  of "decimation" samples, is stored in a per pin single producer single consumer ring buffer.
+  The timer interrupt is the only producer and the application (or IOCOM forwarding) the only
+  consumer, so no locks are needed. The sampling rate is set by "frequency" of the timer pin.
+
+  Only pins read directly from GPIO (pin_ll_get) can be sampled, bus device pins cannot be
+  read from interrupt handler. Since interrupt handlers get no context argument, one sampler
+  can be running at a time.
+
+  Copyright 2020 Pekka Lehtikoski. This file is part of the eosal and shall only be used,
+  modified, and distributed under the terms of the project licensing. By continuing to use, modify,
+  or distribute this file you indicate that you have read the license and understand and accept
+  it fully.
+
+****************************************************************************************************
+*/
+#pragma once
+#ifndef PINS_SAMPLING_H_
+#define PINS_SAMPLING_H_
+#include "pinsx.h"
+
+/* If no sampling support defined for build, enable it on all but minimalistic builds.
+ */
+#ifndef PINS_SAMPLING
+#if OSAL_MINIMALISTIC
+#define PINS_SAMPLING 0
+#else
+#define PINS_SAMPLING 1
+#endif
+#endif
+
+#if PINS_SAMPLING
+
+/** Sampling state for one analog input. Application allocates the structure and the
+    ring buffer, typically as static variables.
+ */
+typedef struct PinsSampleChannel
+{
+    /** Analog input pin to sample.
+     */
+    const Pin *pin;
+
+    /** Ring buffer and it's size in samples. One slot is always kept free, so the buffer
+        holds buf_sz - 1 samples.
+     */
+    os_int *buf;
+    os_int buf_sz;
+
+    /** Number of timer samples to average into one stored sample (boxcar filter),
+        0 or 1 to store every sample.
+     */
+    os_short decimation;
+
+    /** Write position, modified only by the timer interrupt.
+     */
+    volatile os_int head;
+
+    /** Read position, modified only by the consumer.
+     */
+    volatile os_int tail;
+
+    /** Decimation state, used only by the timer interrupt.
+     */
+    os_int acc;
+    os_short acc_n;
+
+    /** Number of samples dropped because ring buffer was full.
+     */
+    volatile os_int overflow_count;
+}
+PinsSampleChannel;
+
+/** Sampler, a timer pin and analog input channels it samples.
+ */
+typedef struct PinsSampler
+{
+    /** Timer pin which sets the sampling rate.
+     */
+    const Pin *timer_pin;
+
+    /** Array of channels to sample.
+     */
+    PinsSampleChannel *channel;
+    os_short n_channels;
+}
+PinsSampler;
+
+/* Start sampling, attach timer interrupt.
+ */
+osalStatus pins_start_sampling(
+    PinsSampler *sampler);
+
+/* Stop sampling, detach timer interrupt.
+ */
+void pins_stop_sampling(
+    PinsSampler *sampler);
+
+/* Get number of samples in channel's ring buffer.
+ */
+os_int pins_get_sample_count(
+    PinsSampleChannel *channel);
+
+/* Move samples from channel's ring buffer.
+ */
+os_int pins_get_samples(
+    PinsSampleChannel *channel,
+    os_int *samples,
+    os_int max_samples);
+
+#endif
+#endif
@@ -80,6 +80,171 @@ OSAL_C_HEADER_BEGINS
   #define PINS_I2C 1
 #endif
 
+/* Generated parameter slot maps for constant time pin_get_prm(). Costs PIN_NRO_PRMS bytes
+   of flash per distinct parameter layout, so off by default on minimalistic builds.
+ */
+#ifndef PINS_PRM_SLOT_MAP
+  #if OSAL_MINIMALISTIC
+    #define PINS_PRM_SLOT_MAP 0
+  #else
+    #define PINS_PRM_SLOT_MAP 1
+  #endif
+#endif
+
+/* Backend can read (and write) a whole GPIO bank of 32 pins with one hardware access.
+   Set to 1 by the backend's pins_hw_defs.h if pin_ll_get_bank() is implemented.
+ */
+#ifndef PINS_BANK_IO
+  #define PINS_BANK_IO 0
+#endif
+
+/* Backend can record GPIO interrupt edges with timestamps into capture ring, see
+   pinInterruptParams. Set to 1 by the backend's pins_hw_defs.h if implemented.
+ */
+#ifndef PINS_EDGE_CAPTURE
+  #define PINS_EDGE_CAPTURE 0
+#endif
+
+/* Memory barrier for lock free data shared between interrupt handler or thread and the
+   main loop, like sampling ring buffers.
+ */
+#ifndef PINS_MEMORY_BARRIER
+  #if defined(__GNUC__) || defined(__clang__)
+    #define PINS_MEMORY_BARRIER() __sync_synchronize()
+  #elif defined(_MSC_VER)
+    #define PINS_MEMORY_BARRIER() MemoryBarrier()
+  #else
+    #define PINS_MEMORY_BARRIER()
+  #endif
+#endif
+
+/* Thread local storage class, used for state which belongs to calling thread, like IOCOM
+   batch depth. Empty if not multithreaded.
+ */
+#ifndef PINS_THREAD_LOCAL
+  #if OSAL_MULTITHREAD_SUPPORT == 0
+    #define PINS_THREAD_LOCAL
+  #elif defined(__GNUC__) || defined(__clang__)
+    #define PINS_THREAD_LOCAL __thread
+  #elif defined(_MSC_VER)
+    #define PINS_THREAD_LOCAL __declspec(thread)
+  #else
+    #define PINS_THREAD_LOCAL _Thread_local
+  #endif
+#endif
+
+/* Input conditioning filters (moving average, IIR, deadband and debounce) set in JSON.
+ */
+#ifndef PINS_INPUT_FILTERS
+  #if OSAL_MINIMALISTIC
+    #define PINS_INPUT_FILTERS 0
+  #else
+    #define PINS_INPUT_FILTERS 1
+  #endif
+#endif
+
+/* Support "scan-ms" group attribute, to read slowly changing input groups less often.
+ */
+#ifndef PINS_SCAN_SCHEDULER
+  #if OSAL_MINIMALISTIC
+    #define PINS_SCAN_SCHEDULER 0
+  #else
+    #define PINS_SCAN_SCHEDULER 1
+  #endif
+#endif
+
+/* Use scan plan generated by pins_to_c.py in pins_read_all(), instead of checking type of
+   every pin on every call.
+ */
+#ifndef PINS_SCAN_PLAN
+  #if OSAL_MINIMALISTIC
+    #define PINS_SCAN_PLAN 0
+  #else
+    #define PINS_SCAN_PLAN 1
+  #endif
+#endif
+
+/* Groups with "scan-ms" are not in the scan plan, pins_read_all() tells these apart by
+   the scan schedule. So scan plan cannot be used without scan scheduler.
+ */
+#if PINS_SCAN_PLAN && !PINS_SCAN_SCHEDULER
+  #undef PINS_SCAN_PLAN
+  #define PINS_SCAN_PLAN 0
+#endif
+
+/* Generated perfect hash index to find pins by "group.pin" name, see pins_find_by_name().
+   Costs a pointer, a string and two bytes of flash per pin.
+ */
+#ifndef PINS_NAME_INDEX
+  #if OSAL_MINIMALISTIC
+    #define PINS_NAME_INDEX 0
+  #else
+    #define PINS_NAME_INDEX 1
+  #endif
+#endif
+
+/* Compact pin configuration generated by "pins_to_c.py -c": Pin structures refer to runtime
+   values, parameters, signals, etc. by 16 bit index into generated tables instead of pointers.
+   Must match how the configuration was generated. Hand written Pin structures, like ones
+   built at run time by line camera code, cannot be used in compact mode.
+ */
+#ifndef PINS_COMPACT
+  #define PINS_COMPACT 0
+#endif
+
+/* Compact tables are bound at run time from binary image written by "pins_to_c.py -b", see
+   pins_config_blob.h. Compact Pin structure then has all optional members, so that image
+   layout does not depend on build options. Generated C configuration is not linked.
+ */
+#ifndef PINS_CONFIG_BLOB
+  #define PINS_CONFIG_BLOB 0
+#endif
+
+/* Maximum number of changed pins collected before forwarding to IOCOM, see
+   pins_begin_iocom_batch(). If more pins change, the journal is flushed early.
+ */
+#ifndef PINS_IOCOM_JOURNAL_SZ
+  #if OSAL_MINIMALISTIC
+    #define PINS_IOCOM_JOURNAL_SZ 16
+  #else
+    #define PINS_IOCOM_JOURNAL_SZ 128
+  #endif
+#endif
+
+/* Precompute gain and offset for scaled pins in pins_setup(). Costs RAM per scaled pin.
+ */
+#ifndef PINS_SCALING_CACHE
+  #if OSAL_MINIMALISTIC
+    #define PINS_SCALING_CACHE 0
+  #else
+    #define PINS_SCALING_CACHE 1
+  #endif
+#endif
+
+/* Pin IO statistics and latency histograms, compiled out unless enabled for the build.
+ */
+#ifndef PINS_STATISTICS
+  #define PINS_STATISTICS 0
+#endif
+
+/* Main loop phase profiler, compiled out unless enabled for the build.
+ */
+#ifndef PINS_PROFILER
+  #define PINS_PROFILER 0
+#endif
+
+/* Binary pin change trace recorder, compiled out unless enabled for the build.
+ */
+#ifndef PINS_TRACE
+  #define PINS_TRACE 0
+#endif
+
+/* Per pin value history ("history" attribute in JSON), compiled out unless enabled for the build.
+ */
+#ifndef PINS_HISTORY
+  #define PINS_HISTORY 0
+#endif
+
 /* Include generic pins library headers.
  */
 #include "code/common/pins_gpio.h"
@@ -87,6 +252,19 @@ OSAL_C_HEADER_BEGINS
 #include "code/common/pins_basics.h"
 #include "code/common/pins_state.h"
 #include "code/common/pins_parameters.h"
+#include "code/common/pins_scaling.h"
+#include "code/common/pins_filter.h"
+#include "code/common/pins_clock.h"
+#include "code/common/pins_edge_capture.h"
+#include "code/common/pins_statistics.h"
+#include "code/common/pins_profiler.h"
+#include "code/common/pins_trace.h"
+#include "code/common/pins_history.h"
+#include "code/common/pins_name_index.h"
+#ifdef PINS_SIMULATE_HW
+#include "code/simulation/pins_simulation_sources.h"
+#include "code/simulation/pins_simulation_trace_replay.h"
+#endif
 
 /* If C++ compilation, end the undecorated code.
  */
@@ -30,7 +30,10 @@ OSAL_C_HEADER_BEGINS
 #include "extensions/camera/common/pins_camera.h"
 #include "extensions/detect_motion/common/pins_detect_motion.h"
 #include "extensions/display/common/pins_display.h"
+#include "extensions/sampling/common/pins_sampling.h"
 #include "extensions/iocom/common/pins_to_iocom.h"
+#include "extensions/json_config/common/pins_json_config.h"
+#include "extensions/config_blob/common/pins_config_blob.h"
 
 /* If C++ compilation, end the undecorated code.
  */
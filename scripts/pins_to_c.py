@@ -2,6 +2,7 @@
 # Converts hardware IO specification(s) written in JSON to C source and header files.
 import json
 import os
+import struct
 import sys
 
 pin_types = {
@@ -16,6 +17,14 @@ pin_types = {
     "cameras" : "PIN_CAMERA",
     "uart" : "PIN_UART"}
 
+# Pin types in same order as pinType enumeration in pins_basics.h, for binary image
+pin_type_ids = [
+    "PIN_INPUT", "PIN_OUTPUT", "PIN_ANALOG_INPUT", "PIN_ANALOG_OUTPUT", "PIN_PWM", "PIN_SPI",
+    "PIN_I2C", "PIN_TIMER", "PIN_UART", "PIN_CAMERA"]
+
+# Scan plan classes, in same order as in PinsScanPlan structure
+scan_plan_classes = ["gpio_in", "direct_in", "bus_in", "int_in", "timer"]
+
 prm_type_list = {
     "pull-up": "PIN_PULL_UP",
     "pull-down": "PIN_PULL_DOWN",
@@ -56,14 +65,59 @@ prm_type_list = {
     "max": "PIN_MAX",
     "smin": "PIN_SMIN",
     "smax": "PIN_SMAX",
-    "digs": "PIN_DIGS"}
+    "digs": "PIN_DIGS",
+    "avg": "PIN_AVG",
+    "iir": "PIN_IIR",
+    "deadband": "PIN_DEADBAND",
+    "deadband-rel": "PIN_DEADBAND_REL",
+    "debounce-ms": "PIN_DEBOUNCE",
+    "sim": "PIN_SIM",
+    "sim-period-ms": "PIN_SIM_PERIOD",
+    "sim-min": "PIN_SIM_MIN",
+    "sim-max": "PIN_SIM_MAX",
+    "sim-seed": "PIN_SIM_SEED",
+    "sim-column": "PIN_SIM_COLUMN"}
+
+# Simulated input sources for "sim" attribute.
+sim_sources = {
+    "random": "PIN_SIM_RANDOM",
+    "const": "PIN_SIM_CONST",
+    "square": "PIN_SIM_SQUARE",
+    "sine": "PIN_SIM_SINE",
+    "ramp": "PIN_SIM_RAMP",
+    "noise": "PIN_SIM_NOISE",
+    "replay": "PIN_SIM_REPLAY"}
+
+# Parameter IDs in the same order as pinPrm enumeration in pins_basics.h. Used to generate
+# parameter slot maps, the generated C code checks that PIN_NRO_PRMS matches the count.
+prm_ids = [
+    "PIN_RV", "PIN_PULL_UP", "PIN_PULL_DOWN", "PIN_TOUCH", "PIN_FREQENCY", "PIN_FREQENCY_KHZ",
+    "PIN_FREQENCY_MHZ", "PIN_RESOLUTION", "PIN_INIT", "PIN_HPOINT", "PIN_INTERRUPT_ENABLED",
+    "PIN_TIMER_SELECT", "PIN_TIMER_GROUP_SELECT", "PIN_MISO", "PIN_MOSI", "PIN_SCLK", "PIN_CS",
+    "PIN_SDA", "PIN_SCL", "PIN_DC", "PIN_RX", "PIN_TX", "PIN_TRANSMITTER_CTRL", "PIN_SPEED",
+    "PIN_SPEED_KBPS", "PIN_FLAGS", "PIN_A", "PIN_B", "PIN_C", "PIN_D", "PIN_E", "PIN_A_BANK",
+    "PIN_B_BANK", "PIN_C_BANK", "PIN_D_BANK", "PIN_E_BANK", "PIN_MIN", "PIN_MAX", "PIN_SMIN",
+    "PIN_SMAX", "PIN_DIGS", "PIN_AVG", "PIN_IIR", "PIN_DEADBAND", "PIN_DEADBAND_REL",
+    "PIN_DEBOUNCE", "PIN_SIM", "PIN_SIM_PERIOD", "PIN_SIM_MIN", "PIN_SIM_MAX", "PIN_SIM_SEED",
+    "PIN_SIM_COLUMN"]
+
+# Version of binary image written by -b option, PINS_BLOB_VERSION in pins_config_blob.h.
+blob_version = 1
+
+# Parameters which need input filter state for the pin.
+filter_prms = ["PIN_AVG", "PIN_IIR", "PIN_DEADBAND", "PIN_DEADBAND_REL", "PIN_DEBOUNCE"]
 
 def start_c_files():
-    global cfile, hfile, cfilepath, hfilepath
+    global cfile, hfile, cfilepath, hfilepath, prm_slot_maps
+    prm_slot_maps = {}
     cfile = open(cfilepath, "w")
     hfile = open(hfilepath, "w")
     cfile.write('/* This file is generated by pins_to_c.py script, do not modify. */\n')
     cfile.write('#include "pins.h"\n')
+    cfile.write('\n/* Parameter slot maps assume pinPrm enumeration as known by pins_to_c.py */\n')
+    cfile.write('typedef char pins_prm_enum_check[(PIN_NRO_PRMS == ' + str(len(prm_ids)) + ') ? 1 : -1];\n')
+    cfile.write('\n/* Pin structure layout depends on PINS_COMPACT, must match "-c" option of pins_to_c.py */\n')
+    cfile.write('typedef char pins_compact_check[PINS_COMPACT ? ' + ('1 : -1' if compact else '-1 : 1') + '];\n')
     hfile.write('/* This file is generated by pins_to_c.py script, do not modify. */\n')
     path, fname = os.path.split(hfilepath)
     fname, ext = os.path.splitext(fname)
@@ -85,19 +139,36 @@ def write_pin_to_c_header(pin_name):
 def write_pin_to_c_source(pin_type, pin_name, pin_attr):
     global known_groups, prefix, ccontent, c_prm_comment_written
     global nro_pins, pin_nr, define_list, device_list, driver_list, bus_list, bus_pin_list
-
-    # Generate C parameter list for the pin
-    c_prm_list = "{PIN_RV, PIN_RV}, {PIN_RV, PIN_RV}"
+    global rv_nr, filter_nr, scan_plan
+    global pin_index, compact_prm, compact_prm_n, compact_signals, compact_devices
+    global intconf_nr, scaling_nr, blob_pins, blob_prm, history_list
+
+    # Generate C parameter list for the pin, and same as numbers for binary image
+    c_prm_list = ""
+    c_prm_names = []
+    c_prm_values = []
     c_prm_list_has_interrupt = False
     c_prm_list_has_scaling = False
     for attr, value in pin_attr.items():
         c_attr_name = prm_type_list.get(attr, "")
         if c_attr_name != "":
-            c_prm_list += ", {" + c_attr_name + ", "
+            c_prm_names.append(c_attr_name)
+            if c_prm_list != "":
+                c_prm_list += ", "
+            c_prm_list += "{" + c_attr_name + ", "
             if c_attr_name == 'PIN_SPEED' or c_attr_name == 'PIN_SPEED_KBPS':
                 c_prm_list += str(int(value)//100) + '}'
+                c_prm_values.append(int(value)//100)
+            elif c_attr_name == 'PIN_SIM':
+                if value not in sim_sources:
+                    print("Pin '" + pin_name + "' has unknown \"sim\" source '" + str(value) + "'")
+                    exit()
+                c_prm_list += sim_sources[value] + '}'
+                c_prm_values.append(list(sim_sources).index(value))
             else:
                 c_prm_list += str(value) + '}'
+                if blobpath is not None:
+                    c_prm_values.append(int(str(value), 0))
 
             if c_attr_name == 'PIN_DIGS' or c_attr_name == 'PIN_SMAX' or c_attr_name == 'PIN_SMIN':
                 c_prm_list_has_scaling = True
@@ -105,21 +176,35 @@ def write_pin_to_c_source(pin_type, pin_name, pin_attr):
             if c_attr_name == 'PIN_INTERRUPT_ENABLED':
                 c_prm_list_has_interrupt = True
 
-        elif attr != 'name' and attr != 'addr' and attr != 'bank' and attr != 'group' and attr != 'device' and attr != 'driver':
+        elif attr != 'name' and attr != 'addr' and attr != 'bank' and attr != 'group' and attr != 'device' and attr != 'driver' and attr != 'history':
             print("Pin '" + pin_name + "' has unknown attribute '" + attr + "', ignored.")
 
     if c_prm_list_has_interrupt == False and pin_type == 'timers':
         c_prm_list_has_interrupt = True
-        c_prm_list += ", {PIN_INTERRUPT_ENABLED, 1}"
-
-    # If we have C parameters, write to C file
+        c_prm_names.append("PIN_INTERRUPT_ENABLED")
+        if c_prm_list != "":
+            c_prm_list += ", "
+        c_prm_list += "{PIN_INTERRUPT_ENABLED, 1}"
+        c_prm_values.append(1)
+
+    # If we have C parameters, write to C file. In compact mode parameters of all pins are
+    # collected into one constant array.
     c_prm_array_name = "OS_NULL"
-    if c_prm_comment_written == False:
-        cfile.write("\n/* Parameters for " + pin_type + " */\n")
-        c_prm_comment_written = True
-    c_prm_array_name = prefix + "_" + pin_type + "_" + pin_name + "_prm"
-    cfile.write("static PinPrmValue " + c_prm_array_name + "[]")
-    cfile.write("= {" + c_prm_list + "};\n")
+    if compact:
+        prm_ix = compact_prm_n
+        if c_prm_list != "":
+            compact_prm.append((c_prm_list, pin_name))
+            compact_prm_n = compact_prm_n + len(c_prm_names)
+            if blobpath is not None:
+                for i in range(len(c_prm_names)):
+                    blob_prm.append((prm_ids.index(c_prm_names[i]), c_prm_values[i]))
+    elif c_prm_list != "":
+        if c_prm_comment_written == False:
+            cfile.write("\n/* Parameters for " + pin_type + " */\n")
+            c_prm_comment_written = True
+        c_prm_array_name = prefix + "_" + pin_type + "_" + pin_name + "_prm"
+        cfile.write("static PinPrmValue " + c_prm_array_name + "[]")
+        cfile.write("= {" + c_prm_list + "};\n")
 
     define_text = prefix + '_' + pin_type + '_' + pin_name
     define_list.append(define_text.upper() + ' "' + pin_name + '"')
@@ -135,12 +220,28 @@ def write_pin_to_c_source(pin_type, pin_name, pin_attr):
     addr = pin_attr.get("addr", "0")
     ccontent += str(addr) + ", "
 
+    # Write pointer to pin's runtime value in contiguous PinRV array, or index to it
+    pin_index[full_pin_name] = len(pin_index)
+    if compact:
+        ccontent += str(rv_nr) + ", "
+    else:
+        ccontent += "&" + prefix + "_rv[" + str(rv_nr) + "], "
+    rv_nr = rv_nr + 1
+
+    # Value history ring, written later as table parallel to runtime values
+    history = int(str(pin_attr.get("history", 0)), 0)
+    if history > 0:
+        history_list.append((rv_nr - 1, prefix + "_" + pin_type + "_" + pin_name + "_history", history))
+
     # Write pointer to parameter array, if any
-    ccontent += c_prm_array_name + ", "
-    if c_prm_array_name == "OS_NULL":
-        ccontent += "0, "
+    if compact:
+        ccontent += str(prm_ix) + ", " + str(len(c_prm_names)) + ", "
     else:
-        ccontent += "sizeof(" + c_prm_array_name + ")/sizeof(PinPrmValue), "
+        ccontent += c_prm_array_name + ", "
+        if c_prm_array_name == "OS_NULL":
+            ccontent += "0, "
+        else:
+            ccontent += "sizeof(" + c_prm_array_name + ")/sizeof(PinPrmValue), "
 
     # Write flags, like PIN_SCALING_SET
     if c_prm_list_has_scaling:
@@ -150,38 +251,55 @@ def write_pin_to_c_source(pin_type, pin_name, pin_attr):
 
     # If IO pin belongs to group, setup linked list
     group = pin_attr.get("group", None)
+    next_ix = 0
     if group is None:
-        ccontent += "OS_NULL"
+        ccontent += "0" if compact else "OS_NULL"
     else:
         g = known_groups.get(group, None)
         if g is None:
-            g = "OS_NULL"
+            g = "0" if compact else "OS_NULL"
             known_groups.update( {group : full_pin_name} )
             define_text = prefix + '_' + group + '_GROUP'
             define_list.append(define_text.upper() + ' "' + group + '"')
 
         else:
             known_groups[group] = full_pin_name
-            g = "&" + g
+            if compact:
+                next_ix = pin_index[g] + 1
+                g = str(next_ix)
+            else:
+                g = "&" + g
 
         ccontent += g
 
+    signal_ix = 0
     if pin_name in signallist:
-        ccontent += ', ' + signallist[pin_name]
+        if compact:
+            signal_ix = len(compact_signals) + 1
+            compact_signals.append(signallist[pin_name])
+            ccontent += ', ' + str(len(compact_signals))
+        else:
+            ccontent += ', ' + signallist[pin_name]
     else:
-        ccontent += ', OS_NULL'
+        ccontent += ', 0' if compact else ', OS_NULL'
 
     # If IO pin is on SPI or I2C device
     bus_device = pin_attr.get("device", None)
+    device_ix = 0
     if bus_device != None:
-        ccontent += ' PINS_DEVCONF_PTR('
-        ccontent += 'pins_device_' + bus_device.replace('.',  '_')
-        ccontent += ')'
+        device_struct_name = 'pins_device_' + bus_device.replace('.',  '_')
+        if compact:
+            if device_struct_name not in compact_devices:
+                compact_devices.append(device_struct_name)
+            device_ix = compact_devices.index(device_struct_name) + 1
+            devconf = ' PINS_DEVCONF_IX(' + str(device_ix) + ')'
+        else:
+            devconf = ' PINS_DEVCONF_PTR(' + device_struct_name + ')'
         tmp = bus_device.split('.')
         bus_pin_list.append( (tmp[1], full_pin_name) )
 
     else:
-        ccontent += ' PINS_DEVCONF_NULL'
+        devconf = ' PINS_DEVCONF_IX(0)' if compact else ' PINS_DEVCONF_NULL'
 
     # If IO pin is a SPI or I2C device
     driver = pin_attr.get("driver", None)
@@ -196,16 +314,80 @@ def write_pin_to_c_source(pin_type, pin_name, pin_attr):
         device_list[pin_name] = (driver, pin_type, pin_name, next_device, bus_id)
         driver_list[driver] = 'x'
 
+    # Sort inputs and timers into scan plan classes. Groups with "scan-ms" are left out of
+    # the plan, pins_read_all() reads these in generic loop when scan period has elapsed.
+    in_plan = group_scan == ' PINS_GROUP_SCAN_NULL'
+    if in_plan and (pin_type == 'inputs' or pin_type == 'analog_inputs'):
+        if bus_device != None:
+            scan_plan['bus_in'].append(full_pin_name)
+        elif c_prm_list_has_interrupt:
+            scan_plan['int_in'].append(full_pin_name)
+        elif pin_type == 'inputs' and int(addr) >= 0:
+            scan_plan['gpio_in'].append(full_pin_name)
+        else:
+            scan_plan['direct_in'].append(full_pin_name)
+    elif in_plan and pin_type == 'timers':
+        scan_plan['timer'].append(full_pin_name)
+
+    intconf_ix = 0
     if c_prm_list_has_interrupt:
-        intconf_struct_name = "pin_" + pin_name + "_intconf"
-        cfile.write("PINS_INTCONF_STRUCT(")
-        cfile.write(intconf_struct_name)
-        cfile.write(")\n")
-        ccontent += ' PINS_INTCONF_PTR('
-        ccontent += intconf_struct_name
-        ccontent += ')'
+        if compact:
+            intconf_nr = intconf_nr + 1
+            intconf_ix = intconf_nr
+            intconf = ' PINS_INTCONF_IX(' + str(intconf_nr) + ')'
+        else:
+            intconf_struct_name = "pin_" + pin_name + "_intconf"
+            cfile.write("PINS_INTCONF_STRUCT(")
+            cfile.write(intconf_struct_name)
+            cfile.write(")\n")
+            intconf = ' PINS_INTCONF_PTR(' + intconf_struct_name + ')'
     else:
-        ccontent += ' PINS_INTCONF_NULL'
+        intconf = ' PINS_INTCONF_IX(0)' if compact else ' PINS_INTCONF_NULL'
+
+    # Parameter slot map for constant time parameter lookup.
+    slot_ix = 0
+    if len(c_prm_names) > 0:
+        slots = get_prm_slot_map(c_prm_names)
+        if compact:
+            slot_ix = slots
+            slots = ' PINS_PRM_SLOTS_IX(' + str(slots) + ')'
+        else:
+            slots = ' PINS_PRM_SLOTS_PTR(' + slots + ')'
+    else:
+        slots = ' PINS_PRM_SLOTS_IX(0)' if compact else ' PINS_PRM_SLOTS_NULL'
+
+    # Storage for precomputed scaling
+    scaling_ix = 0
+    if c_prm_list_has_scaling:
+        if compact:
+            scaling_nr = scaling_nr + 1
+            scaling_ix = scaling_nr
+            scaling = ' PINS_SCALING_IX(' + str(scaling_nr) + ')'
+        else:
+            scaling_struct_name = "pin_" + pin_name + "_scaling"
+            cfile.write("PINS_SCALING_STRUCT(" + scaling_struct_name + ")\n")
+            scaling = ' PINS_SCALING_PTR(' + scaling_struct_name + ')'
+    else:
+        scaling = ' PINS_SCALING_IX(0)' if compact else ' PINS_SCALING_NULL'
+
+    # Input filter state from device's filter pool
+    filter_ix = 0
+    if any(n in filter_prms for n in c_prm_names):
+        if compact:
+            filter_ix = filter_nr + 1
+            pin_filter = ' PINS_FILTER_IX(' + str(filter_nr + 1) + ')'
+        else:
+            pin_filter = ' PINS_FILTER_PTR(' + prefix + '_filter[' + str(filter_nr) + '])'
+        filter_nr = filter_nr + 1
+    else:
+        pin_filter = ' PINS_FILTER_IX(0)' if compact else ' PINS_FILTER_NULL'
+
+    # Optional members in same order as in Pin structure, which is different for compact
+    # mode to pack 8 bit indices together.
+    if compact:
+        ccontent += devconf + slots + intconf + scaling + pin_filter
+    else:
+        ccontent += devconf + intconf + slots + scaling + pin_filter
 
     ccontent += "}"
     if pin_nr <= nro_pins:
@@ -213,6 +395,41 @@ def write_pin_to_c_source(pin_type, pin_name, pin_attr):
 
     ccontent += ' /* ' + pin_name + ' */\n'
 
+    # Same compact Pin structure as numbers, for binary image
+    if compact:
+        blob_pins.append((pin_type_ids.index(pin_types[pin_type]), int(str(bank), 0),
+            int(str(addr), 0), rv_nr - 1, prm_ix, len(c_prm_names),
+            1 if c_prm_list_has_scaling else 0, next_ix, signal_ix, device_ix, slot_ix,
+            intconf_ix, scaling_ix, filter_ix))
+
+# Get name of parameter slot map for parameter layout, generate new map if needed. Pins with
+# same parameters in same order share the slot map, typically there are only a few of these.
+# In compact mode maps are written later as one table, and 1 + number of the map is returned.
+def get_prm_slot_map(c_prm_names):
+    global prm_slot_maps
+
+    slots = [0] * len(prm_ids)
+    for i in range(len(c_prm_names)):
+        name = c_prm_names[i]
+        if slots[prm_ids.index(name)] == 0:
+            slots[prm_ids.index(name)] = i + 1
+
+    key = tuple(slots)
+    map_name = prm_slot_maps.get(key, None)
+    if compact:
+        if map_name is None:
+            map_name = len(prm_slot_maps) + 1
+            prm_slot_maps[key] = map_name
+    elif map_name is None:
+        map_name = "pins_prm_slots_" + str(len(prm_slot_maps))
+        prm_slot_maps[key] = map_name
+        cfile.write("#if PINS_PRM_SLOT_MAP\n")
+        cfile.write("static OS_CONST os_uchar " + map_name + "[PIN_NRO_PRMS] = {")
+        cfile.write(", ".join(str(x) for x in slots) + "};\n")
+        cfile.write("#endif\n")
+
+    return map_name
+
 def write_device_list(device_list, driver_list, bus_list):
     global cfile, hfile
 
@@ -302,7 +519,7 @@ def write_linked_list_heads():
 
 def process_pin(pin_type, pin_attr):
     global device_name, ccontent
-    global pin_nr
+    global pin_nr, group_scan, group_hdrs, name_keys
 
     pin_name = pin_attr.get("name", None)
     if pin_name == None:
@@ -310,9 +527,16 @@ def process_pin(pin_type, pin_attr):
         exit()
 
     if pin_nr == 1:
-        ccontent += ', &' + prefix + '.' + pin_type + '.' + pin_name + '}, /* ' + pin_type + ' */\n'
+        first_pin = '&' + prefix + '.' + pin_type + '.' + pin_name
+        if compact:
+            group_hdrs.append('static OS_CONST PinGroupHdr ' + prefix + '_' + pin_type + '_hdr = {' +
+                str(nro_pins) + ', ' + first_pin + group_scan + '};\n')
+        else:
+            ccontent += ', ' + first_pin + group_scan + '}, /* ' + pin_type + ' */\n'
     pin_nr = pin_nr + 1
 
+    name_keys.append((pin_type + '.' + pin_name, '&' + prefix + '.' + pin_type + '.' + pin_name))
+
     write_pin_to_c_header(pin_name)
     write_pin_to_c_source(pin_type, pin_name, pin_attr)
 
@@ -324,7 +548,7 @@ def count_pins(pins):
 
 def process_group_block(group):
     global nro_groups, group_nr, ccontent, c_prm_comment_written
-    global nro_pins, pin_nr, pin_group_list
+    global nro_pins, pin_nr, pin_group_list, group_scan
 
     pin_type = group.get("name", None)
     if pin_type == None:
@@ -335,8 +559,10 @@ def process_group_block(group):
         print("Pin group '"+ pin_type + "' ignored.")
         return;
 
+    # In compact mode group headers are separate, so that pins form one contiguous array
     hfile.write('\n  struct\n  {\n')
-    hfile.write('    PinGroupHdr hdr;\n')
+    if not compact:
+        hfile.write('    PinGroupHdr hdr;\n')
 
     pins = group.get("pins", None)
     if pins == None:
@@ -345,13 +571,29 @@ def process_group_block(group):
 
     group_nr = group_nr + 1
 
-    pin_group_list.append(prefix + '.' + pin_type)
+    if compact:
+        pin_group_list.append('&' + prefix + '_' + pin_type + '_hdr')
+    else:
+        pin_group_list.append('&' + prefix + '.' + pin_type + '.hdr')
 
     nro_pins = count_pins(pins)
     pin_nr = 1
     c_prm_comment_written = False
 
-    ccontent += '\n  {{' + str(nro_pins)
+    # Scan period for the group, if it needs not to be read on every pins_read_all() call.
+    scan_ms = group.get("scan-ms", None)
+    if scan_ms is None:
+        group_scan = ' PINS_GROUP_SCAN_NULL'
+    else:
+        scan_struct_name = prefix + "_" + pin_type + "_scan"
+        cfile.write("PINS_GROUP_SCAN_STRUCT(" + scan_struct_name + ", " + str(int(scan_ms)) + ")\n")
+        group_scan = ' PINS_GROUP_SCAN_PTR(' + scan_struct_name + ')'
+
+    if compact:
+        ccontent += '\n  { /* ' + pin_type + ' */\n'
+        blob_groups.append((nro_pins, len(pin_index), 0 if scan_ms is None else int(scan_ms)))
+    else:
+        ccontent += '\n  {{' + str(nro_pins)
 
     for pin in pins:
         process_pin(pin_type, pin)
@@ -363,6 +605,17 @@ def process_group_block(group):
 
     hfile.write('  }\n  ' + pin_type + ';\n')
 
+# Count pins in groups which are not ignored, to size the PinRV array. If prms list is given,
+# count only pins which have at least one of these parameters (to size filter pool).
+def count_device_pins(groups, prms = None):
+    count = 0
+    for group in groups:
+        if pin_types.get(group.get("name", None), None) != None:
+            for pin in group.get("pins", []):
+                if prms is None or any(prm_type_list.get(a, "") in prms for a in pin):
+                    count = count + 1
+    return count
+
 def count_groups(groups):
     count = 0
     for group in groups:
@@ -401,11 +654,286 @@ def list_signals_in_file(path):
     else:
         printf ("Opening file " + path + " failed")
 
+# Write scan plan, pins_read_all() reads each class of inputs in it's own loop. Pins of
+# groups with "scan-ms" are not in the plan, generic loop reads these groups.
+def write_scan_plan():
+    cfile.write('#if PINS_SCAN_PLAN\n')
+    cfile.write('/* Scan plan for pins_read_all() */\n')
+    plan = ''
+    for name in scan_plan_classes:
+        pins = scan_plan[name]
+        if len(pins) > 0:
+            list_name = prefix + '_scan_' + name
+            cfile.write('static OS_CONST Pin * OS_CONST ' + list_name + '[] = {')
+            cfile.write(', '.join('&' + p for p in pins) + '};\n')
+            plan += ', ' + list_name + ', ' + str(len(pins))
+        else:
+            plan += ', OS_NULL, 0'
+    cfile.write('static OS_CONST PinsScanPlan ' + prefix + '_scan_plan = {' + plan[2:] + '};\n')
+    cfile.write('#endif\n\n')
+
+# Write tables indexed by compact Pin structures and pins_compact structure to find them.
+def write_compact_tables(nro_filters):
+    if len(pin_index) > 65535 or len(compact_signals) > 65535 or compact_prm_n > 65535:
+        print("Too many pins, signals or parameters for compact mode")
+        exit()
+    if len(compact_devices) > 255 or len(prm_slot_maps) > 255:
+        print("Too many bus devices or parameter layouts for compact mode")
+        exit()
+
+    cfile.write('\n/* Compact mode: Parameters of all pins, constant */\n')
+    cfile.write('static OS_CONST PinPrmValue ' + prefix + '_prm[] = {')
+    if len(compact_prm) > 0:
+        for i in range(len(compact_prm)):
+            cfile.write('\n    ' + compact_prm[i][0])
+            if i < len(compact_prm) - 1:
+                cfile.write(',')
+            cfile.write(' /* ' + compact_prm[i][1] + ' */')
+        cfile.write('};\n')
+    else:
+        cfile.write('{0, 0}};\n')
+
+    cfile.write('\n/* Compact mode: IOCOM signals, indexed by Pin.signal */\n')
+    cfile.write('static const struct iocSignal * OS_CONST ' + prefix + '_signals[] = {OS_NULL')
+    for sig in compact_signals:
+        cfile.write(',\n    ' + sig)
+    cfile.write('};\n')
+
+    cfile.write('\n#if PINS_SPI || PINS_I2C\n')
+    cfile.write('/* Compact mode: SPI and I2C devices, indexed by Pin.bus_device */\n')
+    cfile.write('static PinsBusDevice * OS_CONST ' + prefix + '_bus_devices[] = {OS_NULL')
+    for d in compact_devices:
+        cfile.write(', &' + d)
+    cfile.write('};\n#endif\n')
+
+    slot_maps_name = 'OS_NULL'
+    if len(prm_slot_maps) > 0:
+        slot_maps_name = prefix + '_prm_slots'
+        cfile.write('\n#if PINS_PRM_SLOT_MAP\n')
+        cfile.write('/* Compact mode: Parameter slot maps, PIN_NRO_PRMS bytes each */\n')
+        cfile.write('static OS_CONST os_uchar ' + slot_maps_name + '[' + str(len(prm_slot_maps)) + ' * PIN_NRO_PRMS] = {')
+        for key, nr in sorted(prm_slot_maps.items(), key=lambda item: item[1]):
+            if nr > 1:
+                cfile.write(',')
+            cfile.write('\n    ' + ', '.join(str(x) for x in key))
+        cfile.write('};\n#endif\n')
+
+    intconf_name = 'OS_NULL'
+    scaling_name = 'OS_NULL'
+    filter_name = 'OS_NULL'
+    if intconf_nr > 0 or scaling_nr > 0:
+        cfile.write('\n/* Compact mode: Interrupt configuration and scaling, indexed by Pin */\n')
+    if intconf_nr > 0:
+        intconf_name = prefix + '_int_conf'
+        cfile.write('PINS_INTCONF_TABLE(' + intconf_name + ', ' + str(intconf_nr) + ')\n')
+    if scaling_nr > 0:
+        scaling_name = prefix + '_scaling'
+        cfile.write('PINS_SCALING_TABLE(' + scaling_name + ', ' + str(scaling_nr) + ')\n')
+    if nro_filters > 0:
+        filter_name = prefix + '_filter'
+
+    cfile.write('\n/* Compact mode tables, used trough PIN_RV(), PIN_PRM()... macros */\n')
+    cfile.write('OS_CONST PinsCompactTables pins_compact = {(const Pin*)&' + prefix + ', ')
+    cfile.write(prefix + '_rv, ' + prefix + '_prm, ' + prefix + '_signals\n')
+    cfile.write('#if PINS_SPI || PINS_I2C\n    , ' + prefix + '_bus_devices\n#endif\n')
+    cfile.write('#if PINS_PRM_SLOT_MAP\n    , ' + slot_maps_name + '\n#endif\n')
+    cfile.write('#if PINS_SIMULATED_INTERRUPTS\n    , ' + intconf_name + '\n#endif\n')
+    cfile.write('#if PINS_SCALING_CACHE\n    , ' + scaling_name + '\n#endif\n')
+    cfile.write('#if PINS_INPUT_FILTERS\n    , ' + filter_name + '\n#endif\n')
+    cfile.write('};\n')
+
+# Write compact tables as position independent binary image, see pins_config_blob.h. Layout
+# must match PinsBlobHeader and the compact Pin structure with all optional members.
+def write_blob(nro_filters):
+    strings = bytearray(b'\0')
+    string_ofs = {}
+
+    def add_string(text):
+        ofs = string_ofs.get(text, None)
+        if ofs is None:
+            ofs = len(strings)
+            string_ofs[text] = ofs
+            strings.extend(text.encode('utf-8') + b'\0')
+        return ofs
+
+    def align(data):
+        data.extend(b'\0' * (-len(data) % 8))
+
+    # SPI and I2C devices: Ones referred by pins first, in Pin.bus_device order.
+    device_names = list(compact_devices)
+    for data in device_list.values():
+        name = 'pins_device_' + data[1] + '_' + data[2]
+        if name not in device_names:
+            device_names.append(name)
+    devices = bytearray()
+    bus_ids = list(bus_list.keys())
+    for name in device_names:
+        data = None
+        for d in device_list.values():
+            if 'pins_device_' + d[1] + '_' + d[2] == name:
+                data = d
+        if data is None:
+            print("Device '" + name + "' has no \"driver\", cannot write binary image")
+            exit()
+        devices.extend(struct.pack('<HHI', pin_index[prefix + '.' + data[1] + '.' + data[2]],
+            bus_ids.index(data[4]), add_string(data[0])))
+
+    signals = bytearray()
+    for sig in compact_signals:
+        signals.extend(struct.pack('<I', add_string(sig.lstrip('&'))))
+
+    scan = bytearray()
+    n_scan = []
+    for name in scan_plan_classes:
+        n_scan.append(len(scan_plan[name]))
+        for p in scan_plan[name]:
+            scan.extend(struct.pack('<H', pin_index[p]))
+
+    slot_maps = bytearray()
+    for key, nr in sorted(prm_slot_maps.items(), key=lambda item: item[1]):
+        slot_maps.extend(bytes(key))
+
+    # Pin and application pin group names, to find pins without generated header
+    names = bytearray()
+    for key, ref in name_keys:
+        names.extend(struct.pack('<HHI', pin_index[ref.lstrip('&')], 0, add_string(key)))
+
+    sections = [
+        b''.join(struct.pack('<bbhHHbbHHBBHHH', *p) for p in blob_pins),
+        b''.join(struct.pack('<hh', *p) for p in blob_prm),
+        b''.join(struct.pack('<HHi', *g) for g in blob_groups),
+        slot_maps, signals, devices, scan, names, strings]
+
+    hdr_fmt = '<4sIHHHHI' + 'H' * 16 + 'I' * len(sections)
+    image = bytearray(struct.calcsize(hdr_fmt))
+    align(image)
+    offsets = []
+    for data in sections:
+        offsets.append(len(image))
+        image.extend(data)
+        align(image)
+
+    struct.pack_into(hdr_fmt, image, 0, b'PINB', 0x01020304, blob_version, 22, len(prm_ids),
+        1, len(image), len(blob_pins), len(blob_groups), len(blob_prm),
+        len(compact_signals), len(device_names), len(bus_ids), len(prm_slot_maps), intconf_nr,
+        scaling_nr, nro_filters, *n_scan, len(name_keys), *offsets)
+
+    print("Writing binary image " + blobpath)
+    blob_file = open(blobpath, "wb")
+    blob_file.write(image)
+    blob_file.close()
+
+# 32 bit FNV-1a hash with seed XORed into offset basis and high bits folded into low ones,
+# same as pins_name_hash() in C.
+def name_hash(name, seed):
+    h = (2166136261 ^ seed) & 0xffffffff
+    for c in name.encode('utf-8'):
+        h = ((h ^ c) * 16777619) & 0xffffffff
+    return h ^ (h >> 16)
+
+# Make minimal perfect hash over keys by "hash and displace": Keys are hashed into buckets,
+# and starting from the largest bucket, seed is searched for each bucket so that all it's
+# keys hash into free slots. Buckets with single key take a free slot directly, stored as
+# -1-slot. Returns displacement for each bucket and key index for each slot.
+def make_perfect_hash(keys):
+    n = len(keys)
+    buckets = [[] for i in range(n)]
+    for i in range(n):
+        buckets[name_hash(keys[i], 0) % n].append(i)
+
+    g = [0] * n
+    slots = [None] * n
+    order = sorted(range(n), key=lambda b: -len(buckets[b]))
+    for b in order:
+        items = buckets[b]
+        if len(items) <= 1:
+            break
+        d = 1
+        while True:
+            placed = []
+            for i in items:
+                s = name_hash(keys[i], d) % n
+                if slots[s] is not None or s in placed:
+                    break
+                placed.append(s)
+            if len(placed) == len(items) or d >= 32767:
+                break
+            d = d + 1
+        if len(placed) != len(items):
+            return None, None
+        g[b] = d
+        for i in range(len(items)):
+            slots[placed[i]] = items[i]
+
+    free = [s for s in range(n) if slots[s] is None]
+    for b in order:
+        if len(buckets[b]) == 1:
+            s = free.pop()
+            g[b] = -1 - s
+            slots[s] = buckets[b][0]
+
+    return g, slots
+
+# Write perfect hash index to find pins by name, see pins_find_by_name().
+def write_name_index():
+    keys = [k for k, value in name_keys]
+    n = len(keys)
+    if n == 0:
+        return False
+    if len(set(keys)) != n:
+        print("Duplicate pin or group names, name index not generated.")
+        return False
+    if n > 32767:
+        print("Too many pins for name index.")
+        return False
+
+    g, slots = make_perfect_hash(keys)
+    if g is None:
+        print("Failed to generate name index.")
+        return False
+
+    cfile.write('#if PINS_NAME_INDEX\n')
+    cfile.write('/* Perfect hash index to find pins by name */\n')
+    cfile.write('static OS_CONST os_short ' + prefix + '_name_g[' + str(n) + '] = {')
+    cfile.write(', '.join(str(d) for d in g) + '};\n')
+    cfile.write('static OS_CONST Pin * OS_CONST ' + prefix + '_name_pin[' + str(n) + '] = {')
+    cfile.write(', '.join(name_keys[i][1] for i in slots) + '};\n')
+    cfile.write('static OS_CONST os_char * OS_CONST ' + prefix + '_name_str[' + str(n) + '] = {')
+    cfile.write(', '.join('"' + keys[i] + '"' for i in slots) + '};\n')
+    cfile.write('static OS_CONST PinsNameIndex ' + prefix + '_name_index = {' + prefix + '_name_g, ')
+    cfile.write(prefix + '_name_pin, ' + prefix + '_name_str, ' + str(n) + '};\n')
+    cfile.write('#endif\n\n')
+    return True
+
+# Write value history rings and table to find pin's ring by runtime value index. Returns
+# False if no pin has "history" attribute.
+def write_history_table(nro_rv):
+    if len(history_list) == 0:
+        return False
+
+    table = ['OS_NULL'] * nro_rv
+    cfile.write('#if PINS_HISTORY\n')
+    cfile.write('/* Pin value history rings, table parallel to runtime values */\n')
+    for ix, name, n in history_list:
+        cfile.write('PINS_HISTORY_RING(' + name + ', ' + str(n) + ')\n')
+        table[ix] = '&' + name
+    cfile.write('static PinHistory * OS_CONST ' + prefix + '_history[' + str(nro_rv) + '] = {')
+    cfile.write(', '.join(table) + '};\n')
+    cfile.write('#endif\n\n')
+    return True
+
 def process_io_device(io):
     global device_name, known_groups, prefix, signallist, device_list, driver_list, bus_list, bus_pin_list
-    global nro_groups, group_nr, ccontent, pin_group_list, define_list
+    global nro_groups, group_nr, ccontent, pin_group_list, define_list, rv_nr, filter_nr
+    global scan_plan, group_hdrs, nro_devices, name_keys
+    global pin_index, compact_prm, compact_prm_n, compact_signals, compact_devices
+    global intconf_nr, scaling_nr, blob_pins, blob_prm, blob_groups, history_list
 
     device_name = io.get("name", "ioblock")
+    nro_devices = nro_devices + 1
+    if compact and nro_devices > 1:
+        print("Compact mode supports one IO device per generated file, '" + device_name + "' ignored.")
+        return
     groups = io.get("groups", None)
     prefix = io.get("prefix", "pins")
     pin_group_list = []
@@ -430,10 +958,43 @@ def process_io_device(io):
     nro_groups = count_groups(groups)
     group_nr = 1;
 
+    # Runtime values of all pins in one contiguous array
+    nro_rv = count_device_pins(groups)
+    rv_nr = 0
+    cfile.write("\n/* Runtime values of " + device_name.upper() + " pins */\n")
+    cfile.write("static PinRV " + prefix + "_rv[" + str(max(nro_rv, 1)) + "];\n")
+
+    # Filter pool, one PinFilter for each pin with input filter parameters
+    nro_filters = count_device_pins(groups, filter_prms)
+    filter_nr = 0
+    if nro_filters > 0:
+        cfile.write("\n/* Input filter pool */\n")
+        cfile.write("PINS_FILTER_POOL(" + prefix + "_filter, " + str(nro_filters) + ")\n")
+
+    # Statistics table, parallel to runtime values (empty unless PINS_STATISTICS)
+    cfile.write("\n/* Pin statistics */\n")
+    cfile.write("PINS_STATS_TABLE(" + prefix + "_stats, " + str(max(nro_rv, 1)) + ")\n")
+
     ccontent = "\n/* " + device_name.upper() + " IO configuration structure */\n"
     ccontent += 'OS_CONST ' + prefix + '_t ' + prefix + ' =\n{'
 
     known_groups = {}
+    name_keys = []
+    group_hdrs = []
+    pin_index = {}
+    compact_prm = []
+    compact_prm_n = 0
+    compact_signals = []
+    compact_devices = []
+    blob_pins = []
+    blob_prm = []
+    blob_groups = []
+    intconf_nr = 0
+    scaling_nr = 0
+    history_list = []
+    scan_plan = {}
+    for name in scan_plan_classes:
+        scan_plan[name] = []
 
     for group in groups:
         process_group_block(group)
@@ -441,6 +1002,12 @@ def process_io_device(io):
     ccontent += '};\n\n'
     cfile.write(ccontent)
 
+    if compact:
+        cfile.write('/* Pin group headers */\n')
+        for h in group_hdrs:
+            cfile.write(h)
+        cfile.write('\n')
+
     list_name = prefix + "_group_list"
     cfile.write('/* List of pin type groups */\n')
     cfile.write('static OS_CONST PinGroupHdr * OS_CONST ' + list_name + '[] =\n{\n  ')
@@ -449,11 +1016,29 @@ def process_io_device(io):
         if not isfirst:
             cfile.write(',\n  ')
         isfirst = False
-        cfile.write('&' + p + '.hdr')
+        cfile.write(p)
     cfile.write('\n};\n\n')
 
+    write_scan_plan()
+    plan_ptr = ' PINS_SCAN_PLAN_PTR(' + prefix + '_scan_plan)'
+
+    # Application pin groups can be found by name, index gives first pin of the linked list
+    for g, value in known_groups.items():
+        name_keys.append((g, '&' + value))
+
+    if write_name_index():
+        index_ptr = ' PINS_NAME_INDEX_PTR(' + prefix + '_name_index)'
+    else:
+        index_ptr = ' PINS_NAME_INDEX_NULL'
+
+    if write_history_table(nro_rv):
+        history_ptr = ' PINS_HISTORY_PTR(' + prefix + '_history)'
+    else:
+        history_ptr = ' PINS_HISTORY_NULL'
+
     cfile.write('/* ' + device_name.upper() + ' IO configuration top header structure */\n')
-    cfile.write('OS_CONST IoPinsHdr pins_hdr = {' + list_name + ', sizeof(' + list_name + ')/' + 'sizeof(PinGroupHdr*)};\n')
+    cfile.write('OS_CONST IoPinsHdr pins_hdr = {' + list_name + ', sizeof(' + list_name + ')/' + 'sizeof(PinGroupHdr*), ')
+    cfile.write(prefix + '_rv, ' + str(nro_rv) + ' PINS_STATS_PTR(' + prefix + '_stats)' + plan_ptr + index_ptr + history_ptr + '};\n')
 
     hfile.write('}\n' + prefix + '_t;\n\n')
 
@@ -471,6 +1056,12 @@ def process_io_device(io):
 
     write_device_list(device_list, driver_list, bus_list)
 
+    if compact:
+        write_compact_tables(nro_filters)
+
+    if blobpath is not None:
+        write_blob(nro_filters)
+
 def process_source_file(path):
     read_file = open(path, "r")
     if read_file:
@@ -487,13 +1078,16 @@ def process_source_file(path):
         printf ("Opening file " + path + " failed")
 
 def mymain():
-    global cfilepath, hfilepath, signalspath
+    global cfilepath, hfilepath, signalspath, compact, nro_devices, blobpath
 
     # Get options
     n = len(sys.argv)
     sourcefiles = []
     outpath = None
     signalspath = None
+    compact = False
+    blobpath = None
+    nro_devices = 0
     expectpath = True
     for i in range(1, n):
         if sys.argv[i][0] == "-":
@@ -505,6 +1099,16 @@ def mymain():
                 signalspath = sys.argv[i+1]
                 expectpath = False
 
+            # Compact mode, Pin structures refer to other data by index. Build with PINS_COMPACT=1.
+            if sys.argv[i][1] == "c":
+                compact = True
+
+            # Binary image of compact tables to memory map at run time, see pins_config_blob.h.
+            if sys.argv[i][1] == "b":
+                blobpath = sys.argv[i+1]
+                compact = True
+                expectpath = False
+
         else:
             if expectpath:
                 sourcefiles.append(sys.argv[i])
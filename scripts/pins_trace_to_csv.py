@@ -0,0 +1,90 @@
+# pins_trace_to_csv.py 26.4.2021/pekka
+# Converts binary pin change trace recorded by pins_start_trace() to CSV.
+# Usage: python3 pins_trace_to_csv.py trace.bin [-p pins_io.json] [-o trace.csv]
+# If pins JSON is given, pins are named "group.pin", otherwise by index.
+import json
+import struct
+import sys
+
+pin_types = ["inputs", "outputs", "analog_inputs", "analog_outputs", "pwm", "spi", "i2c",
+    "timers", "cameras", "uart"]
+
+record_types = {1: "read", 2: "write"}
+
+# List pin names in same order as pins_to_c.py generates runtime value array
+def list_pin_names(path):
+    names = []
+    read_file = open(path, "r")
+    data = json.load(read_file)
+    read_file.close()
+    for io in data.get("io", []):
+        for group in io.get("groups", []):
+            group_name = group.get("name", None)
+            if group_name in pin_types:
+                for pin in group.get("pins", []):
+                    names.append(group_name + "." + pin.get("name", "?"))
+    return names
+
+def convert(tracepath, pinspath, outpath):
+    names = []
+    if pinspath != None:
+        names = list_pin_names(pinspath)
+
+    f = open(tracepath, "rb")
+    hdr = f.read(16)
+    if len(hdr) < 16 or hdr[0:4] != b"PTRC":
+        print("'" + tracepath + "' is not pins trace file")
+        exit()
+    version, record_sz, nro_pins = struct.unpack("<III", hdr[4:16])
+    if version != 1 or record_sz < 16:
+        print("Unsupported trace version " + str(version))
+        exit()
+    if pinspath != None and len(names) != nro_pins:
+        print("Warning: trace has " + str(nro_pins) + " pins, JSON " + str(len(names)))
+
+    if outpath == None:
+        out = sys.stdout
+    else:
+        out = open(outpath, "w")
+
+    out.write("time_us,pin,type,value,state_bits\n")
+    while True:
+        rec = f.read(record_sz)
+        if len(rec) < record_sz:
+            break
+        t_us, value, pin_ix, state_bits, rec_type = struct.unpack("<qiHbb", rec[0:16])
+        if pin_ix < len(names):
+            pin_name = names[pin_ix]
+        else:
+            pin_name = str(pin_ix)
+        out.write(str(t_us) + "," + pin_name + "," + record_types.get(rec_type, str(rec_type)))
+        out.write("," + str(value) + "," + str(state_bits) + "\n")
+
+    f.close()
+    if out != sys.stdout:
+        out.close()
+
+def mymain():
+    n = len(sys.argv)
+    tracepath = None
+    pinspath = None
+    outpath = None
+    i = 1
+    while i < n:
+        if sys.argv[i][0] == "-" and i + 1 < n:
+            if sys.argv[i][1] == "o":
+                outpath = sys.argv[i+1]
+            if sys.argv[i][1] == "p":
+                pinspath = sys.argv[i+1]
+            i = i + 2
+        else:
+            tracepath = sys.argv[i]
+            i = i + 1
+
+    if tracepath == None:
+        print("Usage: pins_trace_to_csv.py trace.bin [-p pins_io.json] [-o trace.csv]")
+        exit()
+
+    convert(tracepath, pinspath, outpath)
+
+mymain()